@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define GLSLANG_C_IFACE_H_INCLUDED
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "glslang_c_shader_types.h"
@@ -42,6 +43,10 @@ typedef struct glslang_shader_s glslang_shader_t;
 typedef struct glslang_shader_s *glslang_shader;
 typedef struct glslang_program_s glslang_program_t;
 typedef struct glslang_program_s *glslang_program;
+typedef struct glslang_cancel_token_s glslang_cancel_token_t;
+typedef struct glslang_program_cache_s *glslang_program_cache;
+/* Defined by spirv_tools_allocator.h */
+struct spv_allocator_t;
 // typedef struct glslang_include_callbacks_s *glslang_include_callbacks;
 
 /* TLimits counterpart */
@@ -193,6 +198,14 @@ typedef glsl_include_result_t* (*glsl_include_system_func)(void* ctx, const char
 /* Callback for include result destruction */
 typedef int (*glsl_free_include_result_func)(void* ctx, glsl_include_result_t* result);
 
+/* A slice of shader source, which need not be NUL-terminated */
+typedef struct glslang_source_segment_s {
+    const char* data;
+    size_t length;
+    /* The name messages give the segment, or NULL */
+    const char* name;
+} glslang_source_segment_t;
+
 /* Collection of callbacks for GLSL preprocessor */
 typedef struct glsl_include_callbacks_s {
     glsl_include_system_func include_system;
@@ -207,7 +220,7 @@ typedef struct glslang_input_s {
     glslang_target_client_version_t client_version;
     glslang_target_language_t target_language;
     glslang_target_language_version_t target_language_version;
-    /** Shader source code */
+    /** Shader source code, used when segment_count is 0 */
     const char* code;
     int default_version;
     glslang_profile_t default_profile;
@@ -218,8 +231,37 @@ typedef struct glslang_input_s {
     glslang_includer_type_t includer_type;
     glsl_include_callbacks_t callbacks;
     void* callbacks_ctx;
+    /* Stops preprocessing, parsing and linking once cancelled, or NULL. */
+    const glslang_cancel_token_t* cancel_token;
+    /* A time from glslang_deadline_after, after which the compile is abandoned, or 0 for none. */
+    uint64_t deadline;
+    /* The source as consecutive segments, in place of code, which are read in place rather than joined.
+       The segments and their data must remain valid until the shader is parsed. */
+    const glslang_source_segment_t* segments;
+    size_t segment_count;
 } glslang_input_t;
 
+/* TObjectReflection counterpart */
+typedef struct glslang_reflection_object_s {
+    const char* name;
+    int offset;
+    int gl_define_type;
+    /* The data size of a block, or the array size of an object which is an array */
+    int size;
+    /* The block of a member, or the index of a block */
+    int index;
+    int counter_index;
+    int num_members;
+    int array_stride;
+    int top_level_array_size;
+    int top_level_array_stride;
+    /* The layout qualifiers of the object, or -1 where not declared */
+    int binding;
+    int set;
+    int location;
+    glslang_stage_mask_t stages;
+} glslang_reflection_object_t;
+
 /* SpvOptions counterpart */
 typedef struct glslang_spv_options_s {
     bool generate_debug_info;
@@ -257,7 +299,25 @@ GLSLANG_EXPORT void glslang_finalize_process();
 
 glslang_resource_t const * glslang_get_default_resource(void);
 
+/*
+   Cancellation and deadlines are checked before each preprocess, parse and link, and as the
+   preprocessor resolves each #include. A macro expansion already in progress runs
+   to completion. A call which is stopped returns false, and the shader or program status
+   reports why.
+
+   A program takes the earliest deadline and the first cancel token of its shaders' inputs.
+*/
+GLSLANG_EXPORT glslang_cancel_token_t* glslang_cancel_token_create(void);
+GLSLANG_EXPORT void glslang_cancel_token_delete(glslang_cancel_token_t* token);
+/* May be called from any thread. */
+GLSLANG_EXPORT void glslang_cancel_token_cancel(glslang_cancel_token_t* token);
+GLSLANG_EXPORT bool glslang_cancel_token_is_cancelled(const glslang_cancel_token_t* token);
+/* Returns the deadline timeout_ns from now on the monotonic clock. */
+GLSLANG_EXPORT uint64_t glslang_deadline_after(uint64_t timeout_ns);
+
 GLSLANG_EXPORT glslang_shader glslang_shader_create(const glslang_input_t* input);
+/* Creates a shader allocated from allocator, which is copied and must outlive the shader, or from the system allocator if NULL. */
+GLSLANG_EXPORT glslang_shader glslang_shader_create_with_allocator(const glslang_input_t* input, const struct spv_allocator_t* allocator);
 GLSLANG_EXPORT void glslang_shader_delete(glslang_shader shader);
 GLSLANG_EXPORT void glslang_shader_set_preamble(glslang_shader_t* shader, const char* s);
 GLSLANG_EXPORT void glslang_shader_shift_binding(glslang_shader shader, glslang_resource_type_t res, unsigned int base);
@@ -266,17 +326,28 @@ GLSLANG_EXPORT void glslang_shader_set_options(glslang_shader shader, int option
 GLSLANG_EXPORT void glslang_shader_set_glsl_version(glslang_shader shader, int version);
 GLSLANG_EXPORT bool glslang_shader_preprocess(glslang_shader shader, const glslang_input_t* input);
 GLSLANG_EXPORT bool glslang_shader_parse(glslang_shader shader, const glslang_input_t* input);
+/*
+   Preprocesses and parses input->code in a single pass, as glslang's parser runs the preprocessor
+   as it reads. Unlike glslang_shader_preprocess followed by glslang_shader_parse, the preprocessed
+   text is not produced and scanned again; call glslang_shader_preprocess if it is needed.
+*/
+GLSLANG_EXPORT bool glslang_shader_compile(glslang_shader shader, const glslang_input_t* input);
 GLSLANG_EXPORT const char* glslang_shader_get_preprocessed_code(glslang_shader shader);
 GLSLANG_EXPORT const char* glslang_shader_get_info_log(glslang_shader shader);
 GLSLANG_EXPORT const char* glslang_shader_get_info_debug_log(glslang_shader shader);
+/* The outcome of the last preprocess, parse or compile */
+GLSLANG_EXPORT glslang_status_t glslang_shader_get_status(glslang_shader shader);
 
 GLSLANG_EXPORT glslang_program glslang_program_create(void);
+/* Creates a program allocated from allocator, which is copied and must outlive the program, or from the system allocator if NULL. */
+GLSLANG_EXPORT glslang_program glslang_program_create_with_allocator(const struct spv_allocator_t* allocator);
 GLSLANG_EXPORT void glslang_program_delete(glslang_program program);
 GLSLANG_EXPORT void glslang_program_add_shader(glslang_program program, glslang_shader shader);
 GLSLANG_EXPORT bool glslang_program_link(glslang_program program, glslang_messages_t messages); // glslang_messages_t
 GLSLANG_EXPORT void glslang_program_add_source_text(glslang_program_t* program, glslang_stage_t stage, const char* text, size_t len);
 GLSLANG_EXPORT void glslang_program_set_source_file(glslang_program_t* program, glslang_stage_t stage, const char* file);
 GLSLANG_EXPORT int glslang_program_map_io(glslang_program program);
+/* Once the intermediates are released, these generate no SPIR-V and report an error in the messages */
 GLSLANG_EXPORT void glslang_program_SPIRV_generate(glslang_program program, glslang_stage_t stage);
 GLSLANG_EXPORT void glslang_program_SPIRV_generate_with_options(glslang_program_t* program, glslang_stage_t stage, glslang_spv_options_t* spv_options);
 GLSLANG_EXPORT size_t glslang_program_SPIRV_get_size(glslang_program program);
@@ -285,6 +356,73 @@ GLSLANG_EXPORT unsigned int* glslang_program_SPIRV_get_ptr(glslang_program progr
 GLSLANG_EXPORT const char* glslang_program_SPIRV_get_messages(glslang_program program);
 GLSLANG_EXPORT const char* glslang_program_get_info_log(glslang_program program);
 GLSLANG_EXPORT const char* glslang_program_get_info_debug_log(glslang_program program);
+/* The outcome of the last link */
+GLSLANG_EXPORT glslang_status_t glslang_program_get_status(glslang_program program);
+/*
+   Frees the linked intermediates of the program and the shaders it owns, keeping the generated SPIR-V, its
+   messages and the info logs, so a program kept for its SPIR-V does not hold on to the AST and pools.
+   Shaders added with glslang_program_add_shader are the caller's to delete. The program can no longer be
+   linked or generate SPIR-V.
+*/
+GLSLANG_EXPORT void glslang_program_release_intermediates(glslang_program program);
+
+/*
+   Builds the reflection of a linked program, which lists its uniforms, blocks and pipeline inputs and outputs
+   from the AST, without generating SPIR-V. The lists are copied, so they remain valid until the reflection is
+   built again or the program is deleted, even once its intermediates are released.
+*/
+GLSLANG_EXPORT bool glslang_program_build_reflection(glslang_program program, int options); // glslang_reflection_options_t
+GLSLANG_EXPORT size_t glslang_program_get_reflection_count(glslang_program program, glslang_reflection_kind_t kind);
+GLSLANG_EXPORT const glslang_reflection_object_t* glslang_program_get_reflection(glslang_program program, glslang_reflection_kind_t kind);
+/* The workgroup size of a compute stage in dimension dim, from 0 to 2 */
+GLSLANG_EXPORT unsigned int glslang_program_get_reflection_local_size(glslang_program program, int dim);
+
+/*
+   Compiles a source holding several stages, such as a RetroArch .slang shader, into a program
+   with no shaders added. Each stage begins at a "#pragma stage <name>" line, where name is vertex,
+   tesscontrol, tessevaluation, geometry, fragment or compute, and the lines before the first pragma
+   are shared by every stage.
+
+   The source is preprocessed once, as input->stage, so every stage sees the same macros, and its
+   #includes are read and its macros expanded once rather than per stage. The preprocessed text is
+   split at the pragmas, keeping the line numbers of the source, and the stages are parsed concurrently
+   and linked. Each parse still scans its stage's text with glslang's preprocessor, which has no
+   macros or #includes left to expand. The info log of the program holds the messages of each step.
+   May be called once per program, and not on a program from a glslang_program_cache; later calls
+   fail with an error in the info log.
+*/
+GLSLANG_EXPORT bool glslang_program_compile_stages(glslang_program program, const glslang_input_t* input);
+/* The stages found by glslang_program_compile_stages */
+GLSLANG_EXPORT glslang_stage_mask_t glslang_program_get_stages(glslang_program program);
+/* Generates SPIR-V for each stage of a program compiled by glslang_program_compile_stages, with the default options if spv_options is NULL */
+GLSLANG_EXPORT void glslang_program_SPIRV_generate_stages(glslang_program program, glslang_spv_options_t* spv_options);
+GLSLANG_EXPORT size_t glslang_program_SPIRV_get_stage_size(glslang_program program, glslang_stage_t stage);
+GLSLANG_EXPORT unsigned int* glslang_program_SPIRV_get_stage_ptr(glslang_program program, glslang_stage_t stage);
+
+/*
+   A cache of linked programs, keyed by their source and the inputs which affect parsing, so SPIR-V can be
+   generated again, such as with other glslang_spv_options_t, without parsing and linking again.
+
+   A program is checked out by glslang_program_cache_acquire until it is returned by
+   glslang_program_cache_release, so only one caller uses it at a time, and a source acquired while its
+   program is checked out is compiled again. The files a source includes are recorded with its program and
+   resolved again through the includer of the input which acquires it, so a program is compiled again when
+   they change. The cache may be used from any thread.
+*/
+/* Creates a cache which keeps up to capacity programs which are not checked out */
+GLSLANG_EXPORT glslang_program_cache glslang_program_cache_create(size_t capacity);
+/* Deletes the cache and the programs it keeps. Programs which are checked out must be released first. */
+GLSLANG_EXPORT void glslang_program_cache_delete(glslang_program_cache cache);
+/*
+   Returns a program linked from input, which is compiled and linked with input->messages on a miss, or NULL
+   if out of memory. A program which failed to compile or link reports why in its status and info log, and
+   is not cached.
+*/
+GLSLANG_EXPORT glslang_program glslang_program_cache_acquire(glslang_program_cache cache, const glslang_input_t* input);
+/* Returns a program acquired from the cache, which keeps it if it linked */
+GLSLANG_EXPORT void glslang_program_cache_release(glslang_program_cache cache, glslang_program program);
+/* Deletes the programs the cache keeps */
+GLSLANG_EXPORT void glslang_program_cache_clear(glslang_program_cache cache);
 
 #ifdef __cplusplus
 }
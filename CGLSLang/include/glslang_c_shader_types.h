@@ -228,6 +228,26 @@ typedef enum glslang_includer_type_s {
     GLSLANG_INCLUDER_TYPE_CUSTOM,
 } glslang_includer_type_t;
 
+/* The outcome of the last preprocess, parse or link */
+typedef enum glslang_status_s {
+    GLSLANG_STATUS_SUCCESS,
+    GLSLANG_STATUS_FAILED,
+    GLSLANG_STATUS_CANCELLED,
+    GLSLANG_STATUS_DEADLINE_EXCEEDED,
+} glslang_status_t;
+
+/* The lists of TProgram's reflection */
+typedef enum glslang_reflection_kind_s {
+    GLSLANG_REFLECTION_UNIFORM,
+    GLSLANG_REFLECTION_UNIFORM_BLOCK,
+    GLSLANG_REFLECTION_BUFFER_VARIABLE,
+    GLSLANG_REFLECTION_BUFFER_BLOCK,
+    GLSLANG_REFLECTION_PIPE_INPUT,
+    GLSLANG_REFLECTION_PIPE_OUTPUT,
+    GLSLANG_REFLECTION_ATOMIC_COUNTER,
+    LAST_ELEMENT_MARKER(GLSLANG_REFLECTION_KIND_COUNT),
+} glslang_reflection_kind_t;
+
 #undef LAST_ELEMENT_MARKER
 
 #endif
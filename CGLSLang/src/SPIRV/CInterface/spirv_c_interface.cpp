@@ -31,6 +31,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **/
 
 #include "glslang_c_interface.h"
+#include "glslang_c_interface_private.h"
+#include "spirv_tools_trace.h"
 
 #include "SPIRV/GlslangToSpv.h"
 #include "SPIRV/Logger.h"
@@ -38,12 +40,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 static_assert(sizeof(glslang_spv_options_t) == sizeof(glslang::SpvOptions), "");
 
-typedef struct glslang_program_s {
-    glslang::TProgram* program;
-    std::vector<unsigned int> spirv;
-    std::string loggerMessages;
-} glslang_program_t;
-
 static EShLanguage c_shader_stage(glslang_stage_t stage)
 {
     switch (stage) {
@@ -81,7 +77,7 @@ static EShLanguage c_shader_stage(glslang_stage_t stage)
     return EShLangCount;
 }
 
-GLSLANG_EXPORT void glslang_program_SPIRV_generate(glslang_program_t* program, glslang_stage_t stage)
+static glslang_spv_options_t default_spv_options()
 {
     glslang_spv_options_t spv_options;
     spv_options.generate_debug_info = false;
@@ -92,11 +88,23 @@ GLSLANG_EXPORT void glslang_program_SPIRV_generate(glslang_program_t* program, g
     spv_options.optimize_size = false;
     spv_options.disassemble = false;
     spv_options.validate = true;
+    return spv_options;
+}
 
+GLSLANG_EXPORT void glslang_program_SPIRV_generate(glslang_program_t* program, glslang_stage_t stage)
+{
+    glslang_spv_options_t spv_options = default_spv_options();
     glslang_program_SPIRV_generate_with_options(program, stage, &spv_options);
 }
 
 GLSLANG_EXPORT void glslang_program_SPIRV_generate_with_options(glslang_program_t* program, glslang_stage_t stage, glslang_spv_options_t* spv_options) {
+    SPVT_TRACE_SCOPE("generate spirv", "glslang");
+    if (!program->program) {
+        /* The SPIR-V of an earlier stage must not be mistaken for this one */
+        program->spirv.clear();
+        program->loggerMessages = "error: the program's intermediates were released\n";
+        return;
+    }
     spv::SpvBuildLogger logger;
 
     const glslang::TIntermediate* intermediate = program->program->getIntermediate(c_shader_stage(stage));
@@ -122,3 +130,37 @@ GLSLANG_EXPORT const char* glslang_program_SPIRV_get_messages(glslang_program_t*
 {
     return program->loggerMessages.empty() ? nullptr : program->loggerMessages.c_str();
 }
+
+GLSLANG_EXPORT void glslang_program_SPIRV_generate_stages(glslang_program_t* program, glslang_spv_options_t* spv_options)
+{
+    SPVT_TRACE_SCOPE("generate spirv stages", "glslang");
+    glslang_spv_options_t defaults = default_spv_options();
+    if (!spv_options)
+        spv_options = &defaults;
+    if (!program->program)
+        return;
+
+    /* Generation allocates from the pool of the link, so the stages are generated in turn on this thread */
+    program->loggerMessages.clear();
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++) {
+        program->stageSpirv[stage].clear();
+        if (!(program->stages & (1 << stage)))
+            continue;
+
+        spv::SpvBuildLogger logger;
+        const glslang::TIntermediate* intermediate = program->program->getIntermediate(EShLanguage(stage));
+        glslang::GlslangToSpv(*intermediate, program->stageSpirv[stage], &logger,
+                              reinterpret_cast<glslang::SpvOptions*>(spv_options));
+        program->loggerMessages += logger.getAllMessages();
+    }
+}
+
+GLSLANG_EXPORT size_t glslang_program_SPIRV_get_stage_size(glslang_program_t* program, glslang_stage_t stage)
+{
+    return unsigned(stage) < GLSLANG_STAGE_COUNT ? program->stageSpirv[stage].size() : 0;
+}
+
+GLSLANG_EXPORT unsigned int* glslang_program_SPIRV_get_stage_ptr(glslang_program_t* program, glslang_stage_t stage)
+{
+    return unsigned(stage) < GLSLANG_STAGE_COUNT ? program->stageSpirv[stage].data() : nullptr;
+}
@@ -31,6 +31,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **/
 
 #include "glslang_c_interface.h"
+#include "glslang_c_interface_private.h"
+#include "spirv_tools_allocator.h"
+#include "spirv_tools_trace.h"
 
 #include "StandAlone/DirStackFileIncluder.h"
 #include "glslang/Public/ResourceLimits.h"
@@ -40,6 +43,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "glslang/MachineIndependent/Versions.h"
 #include "glslang/MachineIndependent/localintermediate.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits.h>
+#include <list>
+#include <mutex>
+#include <new>
+#include <string.h>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
 static_assert(int(GLSLANG_STAGE_COUNT) == EShLangCount, "");
 static_assert(int(GLSLANG_STAGE_MASK_COUNT) == EShLanguageMaskCount, "");
 static_assert(int(GLSLANG_SOURCE_COUNT) == glslang::EShSourceCount, "");
@@ -55,16 +71,22 @@ static_assert(int(GLSLANG_PROFILE_COUNT) == EProfileCount, "");
 static_assert(sizeof(glslang_limits_t) == sizeof(TLimits), "");
 static_assert(sizeof(glslang_resource_t) == sizeof(TBuiltInResource), "");
 
-typedef struct glslang_shader_s {
-    glslang::TShader* shader;
-    std::string preprocessedGLSL;
-} glslang_shader_t;
+/* Records whether a phase may start, and returns false if it has been cancelled or its deadline has passed */
+static bool begin_phase(glslang_status_t& status, const CompileLimits& limits)
+{
+    status = limits.check();
+    return status == GLSLANG_STATUS_SUCCESS;
+}
 
-typedef struct glslang_program_s {
-    glslang::TProgram* program;
-    std::vector<unsigned int> spirv;
-    std::string loggerMessages;
-} glslang_program_t;
+static bool end_phase(glslang_status_t& status, bool succeeded)
+{
+    /* An include refused by LimitedIncluder has already recorded why the phase failed */
+    if (succeeded)
+        status = GLSLANG_STATUS_SUCCESS;
+    else if (status == GLSLANG_STATUS_SUCCESS)
+        status = GLSLANG_STATUS_FAILED;
+    return succeeded;
+}
 
 /* Wrapper/Adapter for C glsl_include_callbacks_t functions
 
@@ -141,7 +163,51 @@ private:
     void* context;
 };
 
-int glslang_initialize_process() { return static_cast<int>(glslang::InitializeProcess()); }
+/* Refuses each #include once the compile has been cancelled or its deadline has passed,
+   which stops the preprocessor with an include error. glslang offers no other hook into
+   its token loop. */
+class LimitedIncluder : public glslang::TShader::Includer {
+public:
+    LimitedIncluder(glslang::TShader::Includer& _includer, const CompileLimits& _limits, glslang_status_t& _status)
+        : includer(_includer), limits(_limits), status(_status) {}
+
+    virtual IncludeResult* includeSystem(const char* headerName, const char* includerName,
+                                         size_t inclusionDepth) override
+    {
+        if (expired())
+            return nullptr;
+        return includer.includeSystem(headerName, includerName, inclusionDepth);
+    }
+
+    virtual IncludeResult* includeLocal(const char* headerName, const char* includerName,
+                                        size_t inclusionDepth) override
+    {
+        if (expired())
+            return nullptr;
+        return includer.includeLocal(headerName, includerName, inclusionDepth);
+    }
+
+    virtual void releaseInclude(IncludeResult* result) override { includer.releaseInclude(result); }
+
+private:
+    glslang::TShader::Includer& includer;
+    const CompileLimits& limits;
+    glslang_status_t& status;
+
+    bool expired()
+    {
+        glslang_status_t checked = limits.check();
+        if (checked != GLSLANG_STATUS_SUCCESS)
+            status = checked;
+        return checked != GLSLANG_STATUS_SUCCESS;
+    }
+};
+
+int glslang_initialize_process()
+{
+    SPVT_TRACE_SCOPE("initialize process", "glslang");
+    return static_cast<int>(glslang::InitializeProcess());
+}
 
 void glslang_finalize_process() { glslang::FinalizeProcess(); }
 
@@ -150,6 +216,26 @@ glslang_resource_t const * glslang_get_default_resource(void)
     return reinterpret_cast<glslang_resource_t const *>(GetDefaultResources());
 }
 
+glslang_cancel_token_t* glslang_cancel_token_create(void) { return new (std::nothrow) glslang_cancel_token_t; }
+
+void glslang_cancel_token_delete(glslang_cancel_token_t* token) { delete token; }
+
+void glslang_cancel_token_cancel(glslang_cancel_token_t* token)
+{
+    token->cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool glslang_cancel_token_is_cancelled(const glslang_cancel_token_t* token)
+{
+    return token->cancelled.load(std::memory_order_relaxed);
+}
+
+uint64_t glslang_deadline_after(uint64_t timeout_ns)
+{
+    uint64_t now = monotonic_now();
+    return timeout_ns > UINT64_MAX - now ? UINT64_MAX : now + timeout_ns;
+}
+
 static EShLanguage c_shader_stage(glslang_stage_t stage)
 {
     switch (stage) {
@@ -312,9 +398,43 @@ static EProfile c_shader_profile(glslang_profile_t profile)
     return EProfile();
 }
 
+static bool has_segments(const glslang_input_t* input) { return input->segments && input->segment_count; }
+
+/* Hands the code or segments of input to the shader, returning false if a segment is too long for glslang */
+static bool set_source(glslang_shader_t* shader, const glslang_input_t* input)
+{
+    shader->sourceStrings.clear();
+    shader->sourceLengths.clear();
+    shader->sourceNames.clear();
+    if (!has_segments(input)) {
+        shader->sourceStrings.push_back(input->code);
+        shader->shader->setStrings(shader->sourceStrings.data(), 1);
+        return true;
+    }
+
+    if (input->segment_count > size_t(INT_MAX))
+        return false;
+    for (size_t i = 0; i < input->segment_count; i++) {
+        const glslang_source_segment_t& segment = input->segments[i];
+        if (segment.length > size_t(INT_MAX))
+            return false;
+        shader->sourceStrings.push_back(segment.data);
+        shader->sourceLengths.push_back(int(segment.length));
+        shader->sourceNames.push_back(segment.name ? segment.name : "");
+    }
+    shader->shader->setStringsWithLengthsAndNames(shader->sourceStrings.data(), shader->sourceLengths.data(),
+                                                  shader->sourceNames.data(), int(input->segment_count));
+    return true;
+}
+
 glslang_shader_t* glslang_shader_create(const glslang_input_t* input)
 {
-    if (!input || !input->code) {
+    return glslang_shader_create_with_allocator(input, nullptr);
+}
+
+glslang_shader_t* glslang_shader_create_with_allocator(const glslang_input_t* input, const spv_allocator_t* allocator)
+{
+    if (!input || (!input->code && !has_segments(input))) {
         printf("Error creating shader: null input(%p)/input->code\n", input);
 
         if (input)
@@ -323,10 +443,24 @@ glslang_shader_t* glslang_shader_create(const glslang_input_t* input)
         return nullptr;
     }
 
-    glslang_shader_t* shader = new glslang_shader_t();
+    if (!allocator)
+        allocator = spvt_allocator_get_system();
 
-    shader->shader = new glslang::TShader(c_shader_stage(input->stage));
-    shader->shader->setStrings(&input->code, 1);
+    glslang_shader_t* shader = spvt_allocator_new<glslang_shader_t>(*allocator);
+    if (!shader)
+        return nullptr;
+    shader->allocator = *allocator;
+    shader->limits = CompileLimits(input);
+
+    shader->shader = spvt_allocator_new<glslang::TShader>(*allocator, c_shader_stage(input->stage));
+    if (!shader->shader) {
+        spvt_allocator_delete(*allocator, shader);
+        return nullptr;
+    }
+    if (!set_source(shader, input)) {
+        glslang_shader_delete(shader);
+        return nullptr;
+    }
     shader->shader->setEnvInput(c_shader_source(input->language), c_shader_stage(input->stage),
                                 c_shader_client(input->client), input->default_version);
     shader->shader->setEnvClient(c_shader_client(input->client), c_shader_client_version(input->client_version));
@@ -377,7 +511,7 @@ const char* glslang_shader_get_preprocessed_code(glslang_shader_t* shader)
     return shader->preprocessedGLSL.c_str();
 }
 
-bool glslang_shader_preprocess(glslang_shader_t* shader, const glslang_input_t* input)
+static std::unique_ptr<glslang::TShader::Includer> make_includer(const glslang_input_t* input)
 {
     std::unique_ptr<glslang::TShader::Includer> includer;
     switch (input->includer_type) {
@@ -395,8 +529,20 @@ bool glslang_shader_preprocess(glslang_shader_t* shader, const glslang_input_t*
             includer.reset(new DirStackFileIncluder);
             break;
     }
+    return includer;
+}
+
+bool glslang_shader_preprocess(glslang_shader_t* shader, const glslang_input_t* input)
+{
+    SPVT_TRACE_SCOPE("preprocess", "glslang");
+    shader->limits = CompileLimits(input);
+    if (!begin_phase(shader->status, shader->limits))
+        return false;
+
+    std::unique_ptr<glslang::TShader::Includer> includer = make_includer(input);
+    LimitedIncluder limitedIncluder(*includer, shader->limits, shader->status);
     /* TODO: use custom callbacks if they are available in 'i->callbacks' */
-    return shader->shader->preprocess(
+    bool succeeded = shader->shader->preprocess(
         reinterpret_cast<const TBuiltInResource*>(input->resource),
         input->default_version,
         c_shader_profile(input->default_profile),
@@ -404,40 +550,100 @@ bool glslang_shader_preprocess(glslang_shader_t* shader, const glslang_input_t*
         input->forward_compatible != 0,
         (EShMessages)c_shader_messages(input->messages),
         &shader->preprocessedGLSL,
-        *includer
+        limitedIncluder
     );
+    return end_phase(shader->status, succeeded);
 }
 
 bool glslang_shader_parse(glslang_shader_t* shader, const glslang_input_t* input)
 {
+    SPVT_TRACE_SCOPE("parse", "glslang");
+    shader->limits = CompileLimits(input);
+    if (!begin_phase(shader->status, shader->limits))
+        return false;
+
     const char* preprocessedCStr = shader->preprocessedGLSL.c_str();
     shader->shader->setStrings(&preprocessedCStr, 1);
 
-    return shader->shader->parse(
+    bool succeeded = shader->shader->parse(
         reinterpret_cast<const TBuiltInResource*>(input->resource),
         input->default_version,
         input->forward_compatible != 0,
         (EShMessages)c_shader_messages(input->messages)
     );
+    return end_phase(shader->status, succeeded);
+}
+
+/* Compiles the shader, resolving its #includes through includer */
+static bool compile_shader(glslang_shader_t* shader, const glslang_input_t* input, glslang::TShader::Includer& includer)
+{
+    SPVT_TRACE_SCOPE("compile", "glslang");
+    shader->limits = CompileLimits(input);
+    if (!begin_phase(shader->status, shader->limits))
+        return false;
+
+    /* The parser pulls its tokens through the preprocessor, so the source is scanned once and no text is produced */
+    shader->preprocessedGLSL.clear();
+    if (!set_source(shader, input)) {
+        shader->status = GLSLANG_STATUS_FAILED;
+        return false;
+    }
+
+    LimitedIncluder limitedIncluder(includer, shader->limits, shader->status);
+    bool succeeded = shader->shader->parse(
+        reinterpret_cast<const TBuiltInResource*>(input->resource),
+        input->default_version,
+        c_shader_profile(input->default_profile),
+        input->force_default_version_and_profile != 0,
+        input->forward_compatible != 0,
+        (EShMessages)c_shader_messages(input->messages),
+        limitedIncluder
+    );
+    return end_phase(shader->status, succeeded);
+}
+
+bool glslang_shader_compile(glslang_shader_t* shader, const glslang_input_t* input)
+{
+    std::unique_ptr<glslang::TShader::Includer> includer = make_includer(input);
+    return compile_shader(shader, input, *includer);
 }
 
 const char* glslang_shader_get_info_log(glslang_shader_t* shader) { return shader->shader->getInfoLog(); }
 
 const char* glslang_shader_get_info_debug_log(glslang_shader_t* shader) { return shader->shader->getInfoDebugLog(); }
 
+glslang_status_t glslang_shader_get_status(glslang_shader_t* shader) { return shader->status; }
+
 void glslang_shader_delete(glslang_shader_t* shader)
 {
     if (!shader)
         return;
 
-    delete (shader->shader);
-    delete (shader);
+    const spv_allocator_t allocator = shader->allocator;
+    spvt_allocator_delete(allocator, shader->shader);
+    spvt_allocator_delete(allocator, shader);
 }
 
 glslang_program_t* glslang_program_create()
 {
-    glslang_program_t* p = new glslang_program_t();
-    p->program = new glslang::TProgram();
+    return glslang_program_create_with_allocator(nullptr);
+}
+
+glslang_program_t* glslang_program_create_with_allocator(const spv_allocator_t* allocator)
+{
+    if (!allocator)
+        allocator = spvt_allocator_get_system();
+
+    glslang_program_t* p = spvt_allocator_new<glslang_program_t>(*allocator);
+    if (!p)
+        return nullptr;
+    p->allocator = *allocator;
+
+    p->program = spvt_allocator_new<glslang::TProgram>(*allocator);
+    if (!p->program) {
+        spvt_allocator_delete(*allocator, p);
+        return nullptr;
+    }
     return p;
 }
 
@@ -446,41 +652,794 @@ void glslang_program_delete(glslang_program_t* program)
     if (!program)
         return;
 
-    delete (program->program);
-    delete (program);
+    const spv_allocator_t allocator = program->allocator;
+    /* The program links the intermediates of the stage shaders, so it goes first */
+    spvt_allocator_delete(allocator, program->program);
+    for (glslang_shader_t* shader : program->stageShaders)
+        glslang_shader_delete(shader);
+    spvt_allocator_delete(allocator, program);
+}
+
+void glslang_program_release_intermediates(glslang_program_t* program)
+{
+    if (!program->program)
+        return;
+
+    if (program->stagesLog.empty())
+        program->stagesLog = program->program->getInfoLog();
+    program->releasedDebugLog = program->program->getInfoDebugLog();
+
+    /* The program links the intermediates of the stage shaders, so it goes first */
+    spvt_allocator_delete(program->allocator, program->program);
+    program->program = nullptr;
+    for (glslang_shader_t*& shader : program->stageShaders) {
+        glslang_shader_delete(shader);
+        shader = nullptr;
+    }
 }
 
 void glslang_program_add_shader(glslang_program_t* program, glslang_shader_t* shader)
 {
+    if (!program->program)
+        return;
     program->program->addShader(shader->shader);
+    program->limits.merge(shader->limits);
 }
 
 bool glslang_program_link(glslang_program_t* program, glslang_messages_t messages)
 {
-    return (int)program->program->link((EShMessages)messages);
+    SPVT_TRACE_SCOPE("link", "glslang");
+    if (!program->program) {
+        program->status = GLSLANG_STATUS_FAILED;
+        return false;
+    }
+    if (!begin_phase(program->status, program->limits))
+        return false;
+    return end_phase(program->status, program->program->link((EShMessages)messages));
 }
 
 GLSLANG_EXPORT void glslang_program_add_source_text(glslang_program_t* program, glslang_stage_t stage, const char* text, size_t len) {
+    if (!program->program)
+        return;
     glslang::TIntermediate* intermediate = program->program->getIntermediate(c_shader_stage(stage));
     intermediate->addSourceText(text, len);
 }
 
 GLSLANG_EXPORT void glslang_program_set_source_file(glslang_program_t* program, glslang_stage_t stage, const char* file) {
+    if (!program->program)
+        return;
     glslang::TIntermediate* intermediate = program->program->getIntermediate(c_shader_stage(stage));
     intermediate->setSourceFile(file);
 }
 
 GLSLANG_EXPORT int glslang_program_map_io(glslang_program_t* program)
 {
+    SPVT_TRACE_SCOPE("map io", "glslang");
+    if (!program->program)
+        return 0;
     return (int)program->program->mapIO();
 }
 
 const char* glslang_program_get_info_log(glslang_program_t* program)
 {
-    return program->program->getInfoLog();
+    return program->stagesLog.empty() && program->program ? program->program->getInfoLog() : program->stagesLog.c_str();
 }
 
 const char* glslang_program_get_info_debug_log(glslang_program_t* program)
 {
-    return program->program->getInfoDebugLog();
+    return program->program ? program->program->getInfoDebugLog() : program->releasedDebugLog.c_str();
+}
+
+glslang_status_t glslang_program_get_status(glslang_program_t* program) { return program->status; }
+
+/* The stages a multi-stage source may declare with "#pragma stage <name>" */
+static const struct {
+    const char* name;
+    glslang_stage_t stage;
+} stage_pragmas[] = {
+    { "vertex", GLSLANG_STAGE_VERTEX },
+    { "tesscontrol", GLSLANG_STAGE_TESSCONTROL },
+    { "tessevaluation", GLSLANG_STAGE_TESSEVALUATION },
+    { "geometry", GLSLANG_STAGE_GEOMETRY },
+    { "fragment", GLSLANG_STAGE_FRAGMENT },
+    { "compute", GLSLANG_STAGE_COMPUTE },
+};
+
+static const char* stage_pragma_name(int stage)
+{
+    for (const auto& pragma : stage_pragmas)
+        if (pragma.stage == stage)
+            return pragma.name;
+    return "unknown";
+}
+
+static const char* skip_space(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+static bool has_prefix(const char* p, const char* end, const char* prefix)
+{
+    size_t len = strlen(prefix);
+    return size_t(end - p) >= len && memcmp(p, prefix, len) == 0;
+}
+
+/* Matches a "#pragma stage <name>" line of preprocessed text, setting stage to -1 if the name is unknown.
+   The preprocessor writes the pragma's tokens without separators, so "stagevertex" matches too. */
+static bool match_stage_pragma(const char* p, const char* end, int& stage, std::string& name)
+{
+    p = skip_space(p, end);
+    if (!has_prefix(p, end, "#"))
+        return false;
+    p = skip_space(p + 1, end);
+    if (!has_prefix(p, end, "pragma"))
+        return false;
+    p = skip_space(p + 6, end);
+    if (!has_prefix(p, end, "stage"))
+        return false;
+    p = skip_space(p + 5, end);
+
+    const char* last = end;
+    while (last > p && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r'))
+        last--;
+    name.assign(p, last);
+
+    stage = -1;
+    for (const auto& pragma : stage_pragmas)
+        if (name == pragma.name)
+            stage = pragma.stage;
+    return true;
+}
+
+static bool is_line_directive(const char* p, const char* end)
+{
+    p = skip_space(p, end);
+    if (!has_prefix(p, end, "#"))
+        return false;
+    return has_prefix(skip_space(p + 1, end), end, "line");
+}
+
+/* Splits preprocessed text at its stage pragmas. Each stage keeps the shared lines before the first pragma,
+   its own lines and every #line directive, and has the other lines blanked, so its line numbers match
+   the source. Returns the mask of stages found, or 0 with an error in log. */
+static int split_stages(const std::string& text, std::string (&stageText)[GLSLANG_STAGE_COUNT], std::string& log)
+{
+    struct Line {
+        size_t begin, end;
+        int owner; /* A stage, kShared or kDropped */
+    };
+    const int kShared = -1, kDropped = -2;
+
+    std::vector<Line> lines;
+    int stages = 0;
+    int current = kShared;
+    std::string name;
+    for (size_t begin = 0, number = 1; begin < text.size(); number++) {
+        size_t end = text.find('\n', begin);
+        if (end == std::string::npos)
+            end = text.size();
+
+        const char* first = text.data() + begin;
+        const char* last = text.data() + end;
+        int stage;
+        if (match_stage_pragma(first, last, stage, name)) {
+            if (stage < 0) {
+                log += "ERROR: " + std::to_string(number) + ": unknown stage '" + name + "'\n";
+                return 0;
+            }
+            if (stages & (1 << stage)) {
+                log += "ERROR: " + std::to_string(number) + ": stage '" + name + "' is declared more than once\n";
+                return 0;
+            }
+            stages |= 1 << stage;
+            current = stage;
+            lines.push_back({ begin, end, kDropped });
+        } else {
+            lines.push_back({ begin, end, is_line_directive(first, last) ? kShared : current });
+        }
+        begin = end + 1;
+    }
+
+    if (!stages) {
+        log += "ERROR: no #pragma stage found\n";
+        return 0;
+    }
+
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++) {
+        if (!(stages & (1 << stage)))
+            continue;
+        std::string& out = stageText[stage];
+        out.reserve(text.size());
+        for (const Line& line : lines) {
+            if (line.owner == kShared || line.owner == stage)
+                out.append(text, line.begin, line.end - line.begin);
+            out += '\n';
+        }
+    }
+    return stages;
+}
+
+static void append_log(std::string& log, const char* heading, const char* messages)
+{
+    if (!messages || !*messages)
+        return;
+    if (heading) {
+        log += heading;
+        log += ":\n";
+    }
+    log += messages;
+}
+
+/* Threads which parse the stages of glslang_program_compile_stages. They are started on first use and kept for the
+   life of the process, so each compile reuses them rather than starting a thread per stage. */
+class StageWorkers {
+public:
+    static StageWorkers& shared()
+    {
+        /* Never destroyed, since its threads run for the life of the process */
+        static StageWorkers* workers = new StageWorkers;
+        return *workers;
+    }
+
+    /* Runs every job on the workers, helping from the calling thread, and returns once all have finished */
+    void run(std::vector<std::function<void()>>& jobs)
+    {
+        size_t remaining = jobs.size();
+        std::unique_lock<std::mutex> holder(lock);
+        start();
+        for (std::function<void()>& job : jobs)
+            queue.push_back({ &job, &remaining });
+        wake.notify_all();
+
+        while (remaining) {
+            if (queue.empty()) {
+                finished.wait(holder);
+                continue;
+            }
+            execute(holder);
+        }
+    }
+
+private:
+    struct Job {
+        std::function<void()>* run;
+        size_t* remaining;
+    };
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::deque<Job> queue;
+    bool started = false;
+
+    void start()
+    {
+        if (started)
+            return;
+        started = true;
+        unsigned count = std::min(std::max(std::thread::hardware_concurrency(), 2u) - 1, unsigned(GLSLANG_STAGE_COUNT - 1));
+        for (unsigned i = 0; i < count; i++) {
+            try {
+                std::thread([this]() { work(); }).detach();
+            } catch (const std::system_error&) {
+                /* The calling thread runs whatever the workers do not */
+                break;
+            }
+        }
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> holder(lock);
+        for (;;) {
+            wake.wait(holder, [this]() { return !queue.empty(); });
+            execute(holder);
+        }
+    }
+
+    /* Runs the first queued job with the lock released */
+    void execute(std::unique_lock<std::mutex>& holder)
+    {
+        Job job = queue.front();
+        queue.pop_front();
+        holder.unlock();
+        (*job.run)();
+        holder.lock();
+        if (--*job.remaining == 0)
+            finished.notify_all();
+    }
+};
+
+bool glslang_program_compile_stages(glslang_program_t* program, const glslang_input_t* input)
+{
+    SPVT_TRACE_SCOPE("compile stages", "glslang");
+    if (!program->program) {
+        program->status = GLSLANG_STATUS_FAILED;
+        return false;
+    }
+    /* The stage shaders are linked into the program, so they cannot be replaced by a second compile */
+    if (program->stagesCompiled) {
+        program->stagesLog += "ERROR: the stages of a program may only be compiled once\n";
+        program->status = GLSLANG_STATUS_FAILED;
+        return false;
+    }
+    program->stagesCompiled = true;
+    program->limits = CompileLimits(input);
+
+    /* Preprocess once, which resolves every #include and expands every macro for all of the stages. The
+       parse of each stage still runs its text through glslang's preprocessor, which has only #line,
+       #version, #extension and #pragma directives left to handle, so it adds a scan of the stage's
+       own lines to the lexing the parser needs anyway. */
+    std::string stageText[GLSLANG_STAGE_COUNT];
+    int stages;
+    {
+        glslang_shader_t* shader = glslang_shader_create_with_allocator(input, &program->allocator);
+        if (!shader) {
+            program->status = GLSLANG_STATUS_FAILED;
+            return false;
+        }
+        bool succeeded = glslang_shader_preprocess(shader, input);
+        append_log(program->stagesLog, nullptr, glslang_shader_get_info_log(shader));
+        program->status = shader->status;
+        stages = succeeded ? split_stages(shader->preprocessedGLSL, stageText, program->stagesLog) : 0;
+        glslang_shader_delete(shader);
+        if (!succeeded)
+            return false;
+        if (!stages) {
+            program->status = GLSLANG_STATUS_FAILED;
+            return false;
+        }
+    }
+    program->stages = stages;
+
+    glslang_input_t stageInputs[GLSLANG_STAGE_COUNT];
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++) {
+        if (!(stages & (1 << stage)))
+            continue;
+        stageInputs[stage] = *input;
+        stageInputs[stage].stage = glslang_stage_t(stage);
+        stageInputs[stage].code = stageText[stage].c_str();
+        stageInputs[stage].segments = nullptr;
+        stageInputs[stage].segment_count = 0;
+
+        glslang_shader_t* shader = glslang_shader_create_with_allocator(&stageInputs[stage], &program->allocator);
+        if (!shader) {
+            program->status = GLSLANG_STATUS_FAILED;
+            return false;
+        }
+        program->stageShaders[stage] = shader;
+        shader->preprocessedGLSL = std::move(stageText[stage]);
+    }
+
+    /* Each stage parses into its own pool, so the stages parse concurrently on the shared workers */
+    bool parsed[GLSLANG_STAGE_COUNT] = {};
+    std::vector<std::function<void()>> jobs;
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++) {
+        if (!(stages & (1 << stage)))
+            continue;
+        jobs.push_back([program, &stageInputs, &parsed, stage]() {
+            parsed[stage] = glslang_shader_parse(program->stageShaders[stage], &stageInputs[stage]);
+        });
+    }
+    if (jobs.size() == 1)
+        jobs.front()();
+    else
+        StageWorkers::shared().run(jobs);
+
+    bool succeeded = true;
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++) {
+        if (!(stages & (1 << stage)))
+            continue;
+        glslang_shader_t* shader = program->stageShaders[stage];
+        append_log(program->stagesLog, stage_pragma_name(stage), glslang_shader_get_info_log(shader));
+        if (!parsed[stage] && succeeded) {
+            program->status = shader->status;
+            succeeded = false;
+        }
+    }
+    if (!succeeded)
+        return false;
+
+    for (int stage = 0; stage < GLSLANG_STAGE_COUNT; stage++)
+        if (stages & (1 << stage))
+            glslang_program_add_shader(program, program->stageShaders[stage]);
+    succeeded = glslang_program_link(program, input->messages);
+    append_log(program->stagesLog, nullptr, program->program->getInfoLog());
+    return succeeded;
+}
+
+glslang_stage_mask_t glslang_program_get_stages(glslang_program_t* program)
+{
+    return glslang_stage_mask_t(program->stages);
+}
+
+/* An #include resolved while compiling a cached program, which must resolve to the same file for it to be reused */
+struct CachedInclude {
+    bool system;
+    std::string headerName;
+    std::string includerName;
+    size_t inclusionDepth;
+    std::string resolvedName;
+    std::string data;
+
+    bool matches(const glslang::TShader::Includer::IncludeResult* result) const
+    {
+        return result && result->headerName == resolvedName && result->headerLength == data.size() &&
+               (data.empty() || memcmp(result->headerData, data.data(), data.size()) == 0);
+    }
+};
+
+/* Passes each #include on to includer, recording the file it resolves to */
+class RecordingIncluder : public glslang::TShader::Includer {
+public:
+    RecordingIncluder(glslang::TShader::Includer& _includer, std::vector<CachedInclude>& _includes)
+        : includer(_includer), includes(_includes) {}
+
+    virtual IncludeResult* includeSystem(const char* headerName, const char* includerName,
+                                         size_t inclusionDepth) override
+    {
+        return record(true, headerName, includerName, inclusionDepth,
+                      includer.includeSystem(headerName, includerName, inclusionDepth));
+    }
+
+    virtual IncludeResult* includeLocal(const char* headerName, const char* includerName,
+                                        size_t inclusionDepth) override
+    {
+        return record(false, headerName, includerName, inclusionDepth,
+                      includer.includeLocal(headerName, includerName, inclusionDepth));
+    }
+
+    virtual void releaseInclude(IncludeResult* result) override { includer.releaseInclude(result); }
+
+private:
+    glslang::TShader::Includer& includer;
+    std::vector<CachedInclude>& includes;
+
+    /* An include which does not resolve fails the compile, so the program is never cached */
+    IncludeResult* record(bool system, const char* headerName, const char* includerName, size_t inclusionDepth,
+                          IncludeResult* result)
+    {
+        if (result)
+            includes.push_back({ system, headerName, includerName ? includerName : "", inclusionDepth,
+                                 result->headerName, std::string(result->headerData, result->headerLength) });
+        return result;
+    }
+};
+
+/* Resolves each recorded #include again through the includer of input, which must give the same files */
+static bool includes_match(const std::vector<CachedInclude>& includes, const glslang_input_t* input)
+{
+    if (includes.empty())
+        return true;
+
+    std::unique_ptr<glslang::TShader::Includer> includer = make_includer(input);
+    for (const CachedInclude& include : includes) {
+        const char* headerName = include.headerName.c_str();
+        const char* includerName = include.includerName.c_str();
+        glslang::TShader::Includer::IncludeResult* result =
+            include.system ? includer->includeSystem(headerName, includerName, include.inclusionDepth)
+                           : includer->includeLocal(headerName, includerName, include.inclusionDepth);
+        bool matched = include.matches(result);
+        if (result)
+            includer->releaseInclude(result);
+        if (!matched)
+            return false;
+    }
+    return true;
+}
+
+/* Programs linked from the same source and inputs, which only differ in how SPIR-V is generated from them */
+struct glslang_program_cache_s {
+    struct Entry {
+        std::string key;
+        /* The includes the program resolved, which are checked each time it is acquired */
+        std::vector<CachedInclude> includes;
+        glslang_program_t* program;
+    };
+
+    size_t capacity = 0;
+    std::mutex mutex;
+    /* The programs which are not checked out, most recently released first, indexed by the hash of their key */
+    std::list<Entry> idle;
+    std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+    /* The entries of the programs which are checked out */
+    std::unordered_map<glslang_program_t*, Entry> checkedOut;
+
+    void evict(std::list<Entry>::iterator entry)
+    {
+        auto range = index.equal_range(std::hash<std::string>()(entry->key));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == entry) {
+                index.erase(it);
+                break;
+            }
+        }
+        glslang_program_delete(entry->program);
+        idle.erase(entry);
+    }
+};
+
+static void append_key(std::string& key, const void* data, size_t size)
+{
+    key.append(static_cast<const char*>(data), size);
+}
+
+/* Appends a string with its length, so adjacent strings cannot run together */
+static void append_key_string(std::string& key, const char* data, size_t size)
+{
+    append_key(key, &size, sizeof(size));
+    key.append(data, size);
+}
+
+/* Records everything in input which affects the parse, other than the files it includes, which are recorded
+   as they are resolved, so equal keys and includes give equal programs */
+static std::string cache_key(const glslang_input_t* input)
+{
+    std::string key;
+    const int fields[] = {
+        input->language, input->stage, input->client, input->client_version,
+        input->target_language, input->target_language_version, input->default_version, input->default_profile,
+        input->force_default_version_and_profile, input->forward_compatible, input->messages, input->includer_type,
+    };
+    append_key(key, fields, sizeof(fields));
+    if (input->resource)
+        append_key(key, input->resource, sizeof(glslang_resource_t));
+
+    if (!has_segments(input)) {
+        append_key_string(key, input->code, strlen(input->code));
+        return key;
+    }
+    for (size_t i = 0; i < input->segment_count; i++) {
+        const glslang_source_segment_t& segment = input->segments[i];
+        append_key_string(key, segment.data, segment.length);
+        append_key_string(key, segment.name ? segment.name : "", segment.name ? strlen(segment.name) : 0);
+    }
+    return key;
+}
+
+/* Parses and links input into a program which owns its shader, as glslang_program_compile_stages does,
+   recording the files it includes */
+static glslang_program_t* compile_cached_program(const glslang_input_t* input, std::vector<CachedInclude>& includes)
+{
+    glslang_program_t* program = glslang_program_create();
+    if (!program)
+        return nullptr;
+    program->limits = CompileLimits(input);
+
+    glslang_shader_t* shader = glslang_shader_create_with_allocator(input, &program->allocator);
+    if (!shader) {
+        glslang_program_delete(program);
+        return nullptr;
+    }
+    program->stagesCompiled = true;
+    program->stages = 1 << input->stage;
+    program->stageShaders[input->stage] = shader;
+
+    std::unique_ptr<glslang::TShader::Includer> includer = make_includer(input);
+    RecordingIncluder recordingIncluder(*includer, includes);
+    bool succeeded = compile_shader(shader, input, recordingIncluder);
+    append_log(program->stagesLog, nullptr, glslang_shader_get_info_log(shader));
+    if (!succeeded) {
+        program->status = shader->status;
+        return program;
+    }
+
+    glslang_program_add_shader(program, shader);
+    glslang_program_link(program, input->messages);
+    append_log(program->stagesLog, nullptr, program->program->getInfoLog());
+    return program;
+}
+
+glslang_program_cache glslang_program_cache_create(size_t capacity)
+{
+    glslang_program_cache cache = new (std::nothrow) glslang_program_cache_s;
+    if (cache)
+        cache->capacity = capacity;
+    return cache;
+}
+
+void glslang_program_cache_delete(glslang_program_cache cache)
+{
+    if (!cache)
+        return;
+
+    glslang_program_cache_clear(cache);
+    delete cache;
+}
+
+glslang_program_t* glslang_program_cache_acquire(glslang_program_cache cache, const glslang_input_t* input)
+{
+    SPVT_TRACE_SCOPE("cache acquire", "glslang");
+    if (!input || (!input->code && !has_segments(input)) || unsigned(input->stage) >= GLSLANG_STAGE_COUNT)
+        return nullptr;
+
+    glslang_program_cache_s::Entry entry = { cache_key(input), {}, nullptr };
+    size_t hash = std::hash<std::string>()(entry.key);
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        auto range = cache->index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->key != entry.key)
+                continue;
+            entry = std::move(*it->second);
+            cache->idle.erase(it->second);
+            cache->index.erase(it);
+            break;
+        }
+    }
+
+    /* Resolve the includes without holding the lock, as the includer may be slow, and drop a program whose
+       includes have changed */
+    if (entry.program && !includes_match(entry.includes, input)) {
+        glslang_program_delete(entry.program);
+        entry.program = nullptr;
+        entry.includes.clear();
+    }
+
+    if (!entry.program) {
+        /* Compile without holding the lock, so misses for other sources proceed concurrently */
+        entry.program = compile_cached_program(input, entry.includes);
+        if (!entry.program)
+            return nullptr;
+    }
+
+    glslang_program_t* program = entry.program;
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    cache->checkedOut.emplace(program, std::move(entry));
+    return program;
+}
+
+void glslang_program_cache_release(glslang_program_cache cache, glslang_program_t* program)
+{
+    if (!program)
+        return;
+
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto found = cache->checkedOut.find(program);
+    if (found == cache->checkedOut.end())
+        return;
+    glslang_program_cache_s::Entry entry = std::move(found->second);
+    cache->checkedOut.erase(found);
+
+    if (program->status != GLSLANG_STATUS_SUCCESS || !program->program || !cache->capacity) {
+        glslang_program_delete(program);
+        return;
+    }
+
+    /* The cancel token of the input which compiled the program may not outlive it */
+    program->limits = CompileLimits();
+    for (glslang_shader_t* shader : program->stageShaders)
+        if (shader)
+            shader->limits = CompileLimits();
+
+    size_t hash = std::hash<std::string>()(entry.key);
+    cache->idle.push_front(std::move(entry));
+    cache->index.emplace(hash, cache->idle.begin());
+    while (cache->idle.size() > cache->capacity)
+        cache->evict(std::prev(cache->idle.end()));
+}
+
+void glslang_program_cache_clear(glslang_program_cache cache)
+{
+    if (!cache)
+        return;
+
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    while (!cache->idle.empty())
+        cache->evict(cache->idle.begin());
+}
+
+static int reflection_count(const glslang::TProgram& program, glslang_reflection_kind_t kind)
+{
+    switch (kind) {
+    case GLSLANG_REFLECTION_UNIFORM:
+        return program.getNumUniformVariables();
+    case GLSLANG_REFLECTION_UNIFORM_BLOCK:
+        return program.getNumUniformBlocks();
+    case GLSLANG_REFLECTION_BUFFER_VARIABLE:
+        return program.getNumBufferVariables();
+    case GLSLANG_REFLECTION_BUFFER_BLOCK:
+        return program.getNumBufferBlocks();
+    case GLSLANG_REFLECTION_PIPE_INPUT:
+        return program.getNumPipeInputs();
+    case GLSLANG_REFLECTION_PIPE_OUTPUT:
+        return program.getNumPipeOutputs();
+    case GLSLANG_REFLECTION_ATOMIC_COUNTER:
+        return program.getNumAtomicCounters();
+    default:
+        return 0;
+    }
+}
+
+static const glslang::TObjectReflection& reflection_object(const glslang::TProgram& program, glslang_reflection_kind_t kind, int index)
+{
+    switch (kind) {
+    case GLSLANG_REFLECTION_UNIFORM:
+        return program.getUniform(index);
+    case GLSLANG_REFLECTION_UNIFORM_BLOCK:
+        return program.getUniformBlock(index);
+    case GLSLANG_REFLECTION_BUFFER_VARIABLE:
+        return program.getBufferVariable(index);
+    case GLSLANG_REFLECTION_BUFFER_BLOCK:
+        return program.getBufferBlock(index);
+    case GLSLANG_REFLECTION_PIPE_INPUT:
+        return program.getPipeInput(index);
+    case GLSLANG_REFLECTION_PIPE_OUTPUT:
+        return program.getPipeOutput(index);
+    default:
+        return program.getAtomicCounter(index);
+    }
+}
+
+bool glslang_program_build_reflection(glslang_program_t* program, int options)
+{
+    SPVT_TRACE_SCOPE("build reflection", "glslang");
+    for (std::vector<glslang_reflection_object_t>& objects : program->reflection)
+        objects.clear();
+    program->reflectionNames.clear();
+    std::fill(std::begin(program->localSize), std::end(program->localSize), 0u);
+    if (!program->program || !program->program->buildReflection(options))
+        return false;
+
+    const glslang::TProgram& tprogram = *program->program;
+    size_t total = 0;
+    for (int kind = 0; kind < GLSLANG_REFLECTION_KIND_COUNT; kind++)
+        total += size_t(std::max(reflection_count(tprogram, glslang_reflection_kind_t(kind)), 0));
+    /* Reserved, so the names do not move as they are added */
+    program->reflectionNames.reserve(total);
+
+    for (int kind = 0; kind < GLSLANG_REFLECTION_KIND_COUNT; kind++) {
+        int count = reflection_count(tprogram, glslang_reflection_kind_t(kind));
+        std::vector<glslang_reflection_object_t>& objects = program->reflection[kind];
+        objects.reserve(size_t(std::max(count, 0)));
+        for (int i = 0; i < count; i++) {
+            const glslang::TObjectReflection& object = reflection_object(tprogram, glslang_reflection_kind_t(kind), i);
+            program->reflectionNames.push_back(object.name);
+
+            glslang_reflection_object_t result = {};
+            result.name = program->reflectionNames.back().c_str();
+            result.offset = object.offset;
+            result.gl_define_type = object.glDefineType;
+            result.size = object.size;
+            result.index = object.index;
+            result.counter_index = object.counterIndex;
+            result.num_members = object.numMembers;
+            result.array_stride = object.arrayStride;
+            result.top_level_array_size = object.topLevelArraySize;
+            result.top_level_array_stride = object.topLevelArrayStride;
+            result.binding = object.getBinding();
+            result.set = -1;
+            result.location = -1;
+            if (const glslang::TType* type = object.getType()) {
+                const glslang::TQualifier& qualifier = type->getQualifier();
+                if (qualifier.hasSet())
+                    result.set = int(qualifier.layoutSet);
+                if (qualifier.hasLocation())
+                    result.location = int(qualifier.layoutLocation);
+            }
+            result.stages = glslang_stage_mask_t(object.stages);
+            objects.push_back(result);
+        }
+    }
+
+    for (int dim = 0; dim < 3; dim++)
+        program->localSize[dim] = tprogram.getLocalSize(dim);
+    return true;
+}
+
+size_t glslang_program_get_reflection_count(glslang_program_t* program, glslang_reflection_kind_t kind)
+{
+    return unsigned(kind) < GLSLANG_REFLECTION_KIND_COUNT ? program->reflection[kind].size() : 0;
+}
+
+const glslang_reflection_object_t* glslang_program_get_reflection(glslang_program_t* program, glslang_reflection_kind_t kind)
+{
+    return unsigned(kind) < GLSLANG_REFLECTION_KIND_COUNT ? program->reflection[kind].data() : nullptr;
+}
+
+unsigned int glslang_program_get_reflection_local_size(glslang_program_t* program, int dim)
+{
+    return unsigned(dim) < 3 ? program->localSize[dim] : 0;
 }
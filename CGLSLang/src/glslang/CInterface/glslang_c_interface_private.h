@@ -0,0 +1,92 @@
+/**
+    The state behind the glslang C interface handles, which is shared by
+    glslang_c_interface.cpp and spirv_c_interface.cpp so both agree on its layout.
+**/
+
+#ifndef GLSLANG_C_INTERFACE_PRIVATE_INCLUDED
+#define GLSLANG_C_INTERFACE_PRIVATE_INCLUDED
+
+#include "glslang_c_interface.h"
+#include "spirv_tools_allocator.h"
+
+#include "glslang/Public/ShaderLang.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct glslang_cancel_token_s {
+    std::atomic<bool> cancelled{false};
+};
+
+static inline uint64_t monotonic_now()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/* The cancel token and deadline of a compile */
+struct CompileLimits {
+    const glslang_cancel_token_t* cancel_token = nullptr;
+    uint64_t deadline = 0;
+
+    CompileLimits() {}
+    explicit CompileLimits(const glslang_input_t* input) : cancel_token(input->cancel_token), deadline(input->deadline) {}
+
+    void merge(const CompileLimits& other)
+    {
+        if (!cancel_token)
+            cancel_token = other.cancel_token;
+        if (other.deadline && (!deadline || other.deadline < deadline))
+            deadline = other.deadline;
+    }
+
+    glslang_status_t check() const
+    {
+        if (cancel_token && cancel_token->cancelled.load(std::memory_order_relaxed))
+            return GLSLANG_STATUS_CANCELLED;
+        if (deadline && monotonic_now() >= deadline)
+            return GLSLANG_STATUS_DEADLINE_EXCEEDED;
+        return GLSLANG_STATUS_SUCCESS;
+    }
+};
+
+typedef struct glslang_shader_s {
+    spv_allocator_t allocator;
+    glslang::TShader* shader;
+    std::string preprocessedGLSL;
+    /* The source arrays handed to the TShader, which keeps pointers to them */
+    std::vector<const char*> sourceStrings;
+    std::vector<int> sourceLengths;
+    std::vector<const char*> sourceNames;
+    CompileLimits limits;
+    glslang_status_t status = GLSLANG_STATUS_SUCCESS;
+} glslang_shader_t;
+
+typedef struct glslang_program_s {
+    spv_allocator_t allocator;
+    /* NULL once glslang_program_release_intermediates has freed it */
+    glslang::TProgram* program;
+    std::vector<unsigned int> spirv;
+    std::string loggerMessages;
+    CompileLimits limits;
+    glslang_status_t status = GLSLANG_STATUS_SUCCESS;
+
+    /* Set by glslang_program_compile_stages, which owns a shader for each stage of the mask */
+    bool stagesCompiled = false;
+    int stages = 0;
+    glslang_shader_t* stageShaders[GLSLANG_STAGE_COUNT] = {};
+    /* The info log of glslang_program_compile_stages, or of the link once the intermediates are released */
+    std::string stagesLog;
+    std::string releasedDebugLog;
+    std::vector<unsigned int> stageSpirv[GLSLANG_STAGE_COUNT];
+
+    /* Set by glslang_program_build_reflection, with names pointing into reflectionNames */
+    std::vector<glslang_reflection_object_t> reflection[GLSLANG_REFLECTION_KIND_COUNT];
+    std::vector<std::string> reflectionNames;
+    unsigned int localSize[3] = {};
+} glslang_program_t;
+
+#endif /* #ifndef GLSLANG_C_INTERFACE_PRIVATE_INCLUDED */
@@ -9,6 +9,7 @@
 #define CSPIRVCross_h
 
 #include <CSPIRVCross/spirv_cross_c.h>
+#include <CSPIRVCross/spirv_cross_c_ext.h>
 #include <CSPIRVCross/spirv.h>
 
 
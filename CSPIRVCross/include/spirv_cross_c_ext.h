@@ -0,0 +1,1039 @@
+//
+//  spirv_cross_c_ext.h
+//  CSPIRVCross
+//
+//  Extensions to the SPIRV-Cross C API which are implemented
+//  on top of spirv_cross_c.h.
+//
+
+#ifndef spirv_cross_c_ext_h
+#define spirv_cross_c_ext_h
+
+#include <stdint.h>
+#include <CSPIRVCross/spirv_cross_c.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defined by spirv_tools_allocator.h */
+struct spv_allocator_t;
+/* Defined by glslang_c_interface.h */
+struct glslang_input_s;
+
+#pragma mark - Reflection Snapshot
+
+/*!
+ @brief Value stored in the decoration arrays of a snapshot when the
+ resource does not have the decoration.
+ */
+#define SPVC_REFLECTION_NO_DECORATION (~0u)
+
+/*!
+ @brief A flat, struct-of-arrays copy of the reflection data of a compiler.
+
+ All arrays and strings are owned by the snapshot and are stored in a single
+ contiguous allocation, which is released by @c spvc_reflection_snapshot_free.
+ The snapshot remains valid after the compiler and context are destroyed.
+
+ The @c resource_* arrays have @c resource_count elements and contain every
+ resource of every @c spvc_resource_type, grouped by type in ascending order.
+
+ Struct members of block resources are stored in the @c member_* arrays.
+ The members of resource @c i are the range
+ @c [resource_member_begin[i], resource_member_begin[i] + resource_member_count[i]).
+
+ Active buffer ranges of uniform, storage and push-constant buffers are
+ stored in @c ranges, and are indexed by @c resource_range_begin and
+ @c resource_range_count in the same way.
+ */
+typedef struct spvc_reflection_snapshot
+{
+	size_t resource_count;
+	const spvc_resource_type *resource_type;
+	const spvc_variable_id *resource_id;
+	const spvc_type_id *resource_base_type_id;
+	const spvc_type_id *resource_type_id;
+	const char *const *resource_name;
+
+	/* Decorations, or SPVC_REFLECTION_NO_DECORATION. */
+	const unsigned *resource_set;
+	const unsigned *resource_binding;
+	const unsigned *resource_location;
+	const unsigned *resource_input_attachment_index;
+
+	/* Layout of the base type. */
+	const spvc_basetype *resource_basetype;
+	const unsigned *resource_vector_size;
+	const unsigned *resource_columns;
+	/* Size of the outermost array dimension, 0 for runtime arrays and 1 for non-arrays. */
+	const unsigned *resource_array_size;
+	/* Declared size of block types, or 0. */
+	const size_t *resource_declared_size;
+
+	const unsigned *resource_member_begin;
+	const unsigned *resource_member_count;
+	const unsigned *resource_range_begin;
+	const unsigned *resource_range_count;
+
+	size_t member_count;
+	const char *const *member_name;
+	const spvc_type_id *member_type_id;
+	const spvc_basetype *member_basetype;
+	const unsigned *member_vector_size;
+	const unsigned *member_columns;
+	const unsigned *member_offset;
+	const size_t *member_size;
+	/* Array or matrix stride, or 0 when the member is not an array or matrix. */
+	const unsigned *member_array_stride;
+	const unsigned *member_matrix_stride;
+
+	size_t range_count;
+	const spvc_buffer_range *ranges;
+
+	size_t entry_point_count;
+	const char *const *entry_point_name;
+	const SpvExecutionModel *entry_point_execution_model;
+
+	/* Execution model and modes of the current entry point. */
+	SpvExecutionModel execution_model;
+	size_t execution_mode_count;
+	const SpvExecutionMode *execution_mode;
+	/* Three arguments per execution mode, e.g. the x, y and z of LocalSize. */
+	const unsigned *execution_mode_arguments;
+} spvc_reflection_snapshot;
+
+/*!
+ @brief Captures all reflection data of the compiler in a single call.
+
+ @param compiler The compiler to reflect.
+ @param snapshot Receives the snapshot, which must be released with @c spvc_reflection_snapshot_free.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_get_reflection_snapshot(spvc_compiler compiler,
+                                                                  const spvc_reflection_snapshot **snapshot);
+
+/*!
+ @brief Captures the reflection data like @c spvc_compiler_get_reflection_snapshot, allocating
+ the snapshot from allocator.
+
+ @param allocator The allocator, or NULL for the system allocator. It must outlive the snapshot.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_get_reflection_snapshot_with_allocator(
+    spvc_compiler compiler, const struct spv_allocator_t *allocator, const spvc_reflection_snapshot **snapshot);
+
+/*!
+ @brief Releases the snapshot to the allocator it was created with.
+ */
+SPVC_PUBLIC_API void spvc_reflection_snapshot_free(const spvc_reflection_snapshot *snapshot);
+
+/*!
+ @brief Compiles the shader and captures the reflection data of the same compiler.
+
+ Reflection is captured after compilation, so that it reflects any state
+ SPIRV-Cross updates whilst compiling.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_compile_with_reflection(spvc_compiler compiler, const char **source,
+                                                                  const spvc_reflection_snapshot **snapshot);
+
+#pragma mark - Reflection Blob
+
+/*
+ * A versioned binary encoding of a reflection snapshot, intended to be
+ * stored alongside the SPIR-V or MSL of a shader.
+ *
+ * The blob is written in the byte order of the host, and consists of
+ * fixed-size records of 32-bit values, so it can be memory-mapped and read in
+ * place using the spvc_reflection_blob_get_* accessors, without parsing or
+ * allocation. A blob written by a host of the other byte order fails
+ * validation, as its magic does not match.
+ *
+ * The version holds a major version in its upper 16 bits and a minor version
+ * in its lower 16 bits. A minor version only appends fields to the header and
+ * to records, and the header and each table store their size and stride, so
+ * readers accept blobs of any minor version of their major version and skip
+ * the fields they do not know. Strings are stored as offsets into the
+ * NUL-terminated string table.
+ */
+
+#define SPVC_REFLECTION_BLOB_MAGIC 0x58525053u /* 'SPRX' */
+#define SPVC_REFLECTION_BLOB_VERSION_MAJOR 1u
+#define SPVC_REFLECTION_BLOB_VERSION_MINOR 0u
+#define SPVC_REFLECTION_BLOB_VERSION ((SPVC_REFLECTION_BLOB_VERSION_MAJOR << 16) | SPVC_REFLECTION_BLOB_VERSION_MINOR)
+
+typedef struct spvc_reflection_blob_table
+{
+	uint32_t offset;
+	uint32_t count;
+	uint32_t stride;
+} spvc_reflection_blob_table;
+
+typedef struct spvc_reflection_blob
+{
+	uint32_t magic;
+	uint32_t version;
+	/* Total size of the blob in bytes, including this header. */
+	uint32_t size;
+	uint32_t header_size;
+
+	uint32_t execution_model;
+	uint32_t reserved;
+
+	spvc_reflection_blob_table entry_points;
+	spvc_reflection_blob_table execution_modes;
+	spvc_reflection_blob_table resources;
+	spvc_reflection_blob_table members;
+	spvc_reflection_blob_table ranges;
+	spvc_reflection_blob_table strings;
+} spvc_reflection_blob;
+
+typedef struct spvc_reflection_blob_entry_point
+{
+	uint32_t name;
+	uint32_t execution_model;
+} spvc_reflection_blob_entry_point;
+
+typedef struct spvc_reflection_blob_execution_mode
+{
+	uint32_t mode;
+	uint32_t arguments[3];
+} spvc_reflection_blob_execution_mode;
+
+/* See spvc_reflection_snapshot for the meaning of each field. */
+typedef struct spvc_reflection_blob_resource
+{
+	uint32_t type;
+	uint32_t id;
+	uint32_t base_type_id;
+	uint32_t type_id;
+	uint32_t name;
+	uint32_t set;
+	uint32_t binding;
+	uint32_t location;
+	uint32_t input_attachment_index;
+	uint32_t basetype;
+	uint32_t vector_size;
+	uint32_t columns;
+	uint32_t array_size;
+	uint32_t declared_size;
+	uint32_t member_begin;
+	uint32_t member_count;
+	uint32_t range_begin;
+	uint32_t range_count;
+} spvc_reflection_blob_resource;
+
+typedef struct spvc_reflection_blob_member
+{
+	uint32_t name;
+	uint32_t type_id;
+	uint32_t basetype;
+	uint32_t vector_size;
+	uint32_t columns;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t array_stride;
+	uint32_t matrix_stride;
+} spvc_reflection_blob_member;
+
+typedef struct spvc_reflection_blob_range
+{
+	uint32_t index;
+	uint32_t offset;
+	uint32_t range;
+} spvc_reflection_blob_range;
+
+/*!
+ @brief Encodes the snapshot as a reflection blob.
+
+ @param snapshot The snapshot to encode.
+ @param buffer The destination buffer, or NULL to query the required size.
+ @param size On input, the size of buffer. On output, the size of the blob.
+ */
+SPVC_PUBLIC_API spvc_result spvc_reflection_snapshot_serialize(const spvc_reflection_snapshot *snapshot, void *buffer,
+                                                               size_t *size);
+
+/*!
+ @brief Validates the header and table bounds of a reflection blob.
+
+ Validation does not visit the records, so it is constant time. A blob with
+ the same major version and any minor version is accepted.
+
+ @param data The blob, which must be aligned to 4 bytes.
+ @returns The blob, or NULL if data is not a compatible reflection blob.
+ */
+SPVC_PUBLIC_API const spvc_reflection_blob *spvc_reflection_blob_validate(const void *data, size_t size);
+
+static inline const void *spvc_reflection_blob_get_record(const spvc_reflection_blob *blob,
+                                                          const spvc_reflection_blob_table *table, uint32_t index)
+{
+	return (const char *)blob + table->offset + (size_t)index * table->stride;
+}
+
+static inline const spvc_reflection_blob_entry_point *
+spvc_reflection_blob_get_entry_point(const spvc_reflection_blob *blob, uint32_t index)
+{
+	return (const spvc_reflection_blob_entry_point *)spvc_reflection_blob_get_record(blob, &blob->entry_points, index);
+}
+
+static inline const spvc_reflection_blob_execution_mode *
+spvc_reflection_blob_get_execution_mode(const spvc_reflection_blob *blob, uint32_t index)
+{
+	return (const spvc_reflection_blob_execution_mode *)spvc_reflection_blob_get_record(blob, &blob->execution_modes,
+	                                                                                    index);
+}
+
+static inline const spvc_reflection_blob_resource *spvc_reflection_blob_get_resource(const spvc_reflection_blob *blob,
+                                                                                     uint32_t index)
+{
+	return (const spvc_reflection_blob_resource *)spvc_reflection_blob_get_record(blob, &blob->resources, index);
+}
+
+static inline const spvc_reflection_blob_member *spvc_reflection_blob_get_member(const spvc_reflection_blob *blob,
+                                                                                 uint32_t index)
+{
+	return (const spvc_reflection_blob_member *)spvc_reflection_blob_get_record(blob, &blob->members, index);
+}
+
+static inline const spvc_reflection_blob_range *spvc_reflection_blob_get_range(const spvc_reflection_blob *blob,
+                                                                               uint32_t index)
+{
+	return (const spvc_reflection_blob_range *)spvc_reflection_blob_get_record(blob, &blob->ranges, index);
+}
+
+/* Returns the string at offset, or an empty string if offset is out of bounds. */
+static inline const char *spvc_reflection_blob_get_string(const spvc_reflection_blob *blob, uint32_t offset)
+{
+	if (offset >= blob->strings.count)
+		return "";
+	return (const char *)blob + blob->strings.offset + offset;
+}
+
+#pragma mark - MSL Compile Cache
+
+/*
+ * A cache of MSL compiled from SPIR-V, which avoids parsing the module and
+ * building a compiler when the inputs have not changed.
+ *
+ * The inputs of a compile are recorded in a spvc_msl_cache_key: a SHA-256
+ * digest of the SPIR-V, the entry point, every compiler option, and every
+ * resource binding, vertex attribute, constexpr sampler, shader input and
+ * output, discrete descriptor set, argument buffer address space, dynamic
+ * buffer and inline uniform block. Options are keyed canonically by option, so
+ * the order they are set in does not matter. The other records are keyed in
+ * the order they are added, which is the order they are installed.
+ *
+ * On a miss, spvc_msl_cache_compile installs the recorded inputs on the
+ * compiler, so the key is the single description of the compile.
+ */
+
+typedef struct spvc_msl_cache_s *spvc_msl_cache;
+typedef struct spvc_msl_cache_key_s *spvc_msl_cache_key;
+
+typedef struct spvc_msl_cache_entry
+{
+	/* Owned by the cache, and valid until the cache is destroyed. */
+	const char *source;
+	size_t source_size;
+
+	spvc_bool is_rasterization_disabled;
+	spvc_bool needs_swizzle_buffer;
+	spvc_bool needs_buffer_size_buffer;
+	spvc_bool needs_output_buffer;
+	spvc_bool needs_patch_output_buffer;
+	spvc_bool needs_input_threadgroup_mem;
+} spvc_msl_cache_entry;
+
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_create(spvc_msl_cache *cache);
+SPVC_PUBLIC_API void spvc_msl_cache_destroy(spvc_msl_cache cache);
+
+/*!
+ @brief Restores entries previously written by @c spvc_msl_cache_serialize.
+
+ Entries already in the cache are kept. Data written by a build of a different
+ SPIRV-Cross version is rejected, since its MSL may differ.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_load(spvc_msl_cache cache, const void *data, size_t size);
+
+/*!
+ @brief Writes all entries of the cache, so they can be loaded by a later launch.
+
+ @param buffer The destination buffer, or NULL to query the required size.
+ @param size On input, the size of buffer. On output, the size of the data.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_serialize(spvc_msl_cache cache, void *buffer, size_t *size);
+
+/*!
+ @brief Creates a key for the SPIR-V module, with no options or bindings.
+
+ The key holds a SHA-256 digest of the words of the module rather than a copy,
+ so the module need not outlive the key, and the serialized cache does not
+ hold the module.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_create(const SpvId *spirv, size_t word_count, spvc_msl_cache_key *key);
+SPVC_PUBLIC_API void spvc_msl_cache_key_destroy(spvc_msl_cache_key key);
+
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_set_bool(spvc_msl_cache_key key, spvc_compiler_option option,
+                                                        spvc_bool value);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_set_uint(spvc_msl_cache_key key, spvc_compiler_option option,
+                                                        unsigned value);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_resource_binding(spvc_msl_cache_key key,
+                                                                    const spvc_msl_resource_binding *binding);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_vertex_attribute(spvc_msl_cache_key key,
+                                                                    const spvc_msl_vertex_attribute *attr);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_constexpr_sampler(spvc_msl_cache_key key, spvc_variable_id id,
+                                                                     const spvc_msl_constexpr_sampler *sampler);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_constexpr_sampler_by_binding(
+    spvc_msl_cache_key key, unsigned desc_set, unsigned binding, const spvc_msl_constexpr_sampler *sampler);
+/* Selects the entry point to compile, in place of the default entry point of the module. */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_set_entry_point(spvc_msl_cache_key key, const char *name,
+                                                               SpvExecutionModel execution_model);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_shader_input(spvc_msl_cache_key key,
+                                                                const spvc_msl_shader_interface_var_2 *input);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_shader_output(spvc_msl_cache_key key,
+                                                                 const spvc_msl_shader_interface_var_2 *output);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_discrete_descriptor_set(spvc_msl_cache_key key, unsigned desc_set);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_set_argument_buffer_device_address_space(spvc_msl_cache_key key,
+                                                                                       unsigned desc_set,
+                                                                                       spvc_bool device_address);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_dynamic_buffer(spvc_msl_cache_key key, unsigned desc_set,
+                                                                  unsigned binding, unsigned index);
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_add_inline_uniform_block(spvc_msl_cache_key key, unsigned desc_set,
+                                                                        unsigned binding);
+
+/*!
+ @brief Installs the entry point, options and every record of the key on the compiler.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_key_apply(spvc_msl_cache_key key, spvc_compiler compiler);
+
+/*!
+ @brief Looks up a previous compile of the key.
+
+ @returns SPVC_TRUE and fills entry if the key is cached.
+ */
+SPVC_PUBLIC_API spvc_bool spvc_msl_cache_lookup(spvc_msl_cache cache, spvc_msl_cache_key key,
+                                                spvc_msl_cache_entry *entry);
+
+/*!
+ @brief Applies the key to the compiler, compiles, and caches the MSL and the msl_needs_* flags.
+
+ The compiler must have been created from the same SPIR-V as the key, and
+ must not have had an entry point, options or MSL state installed other than
+ by the key. The options of the compiler are the starting point for those of
+ the key, and state installed earlier is not part of the key, so a compiler
+ configured differently would cache its MSL under the same key.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_cache_compile(spvc_msl_cache cache, spvc_msl_cache_key key,
+                                                   spvc_compiler compiler, spvc_msl_cache_entry *entry);
+
+#pragma mark - MSL Rebind Template
+
+/*
+ * A fast path for recompiling a shader when only MSL resource indices change.
+ *
+ * The template compiles the shader once, with a unique placeholder index for
+ * every resource binding and for each of the given index options, such as
+ * SPVC_COMPILER_OPTION_MSL_SWIZZLE_BUFFER_INDEX. Emitting the template with new
+ * indices substitutes the placeholders in the generated MSL, and does not parse,
+ * analyze or compile the module again.
+ *
+ * Placeholders are resolved in [[buffer(n)]], [[texture(n)]], [[sampler(n)]] and
+ * [[id(n)]] attributes, and in the spvSwizzleConstants[n] and
+ * spvBufferSizeConstants[n] subscripts of the entry point, including indices
+ * SPIRV-Cross derives from a placeholder, such as the elements of an array of
+ * buffers.
+ */
+
+typedef struct spvc_msl_rebind_template_s *spvc_msl_rebind_template;
+
+/*!
+ @brief Compiles a template.
+
+ @param compiler A compiler which has not been compiled.
+ @param options The options to install; the index options are replaced with placeholders.
+ @param index_options The options which may change when the template is emitted.
+ @param bindings The resource bindings which may change when the template is emitted.
+ @param template Receives the template, which must be released with @c spvc_msl_rebind_template_destroy.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_rebind_template_create(spvc_compiler compiler, spvc_compiler_options options,
+                                                            const spvc_compiler_option *index_options,
+                                                            size_t index_option_count,
+                                                            const spvc_msl_resource_binding *bindings,
+                                                            size_t binding_count,
+                                                            spvc_msl_rebind_template *template_);
+
+SPVC_PUBLIC_API void spvc_msl_rebind_template_destroy(spvc_msl_rebind_template template_);
+
+/*!
+ @brief Emits MSL with new indices.
+
+ @param index_option_values The values of the index options, in the order passed to @c spvc_msl_rebind_template_create.
+ @param bindings The new resource bindings, which must have the same stage, set and binding as the template, in any order.
+ @param source Receives the MSL, which is owned by the template and valid until the next emit.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_rebind_template_emit(spvc_msl_rebind_template template_,
+                                                          const unsigned *index_option_values,
+                                                          const spvc_msl_resource_binding *bindings,
+                                                          size_t binding_count, const char **source);
+
+#pragma mark - Callback Output
+
+/*!
+ @brief Receives a chunk of generated source.
+
+ @returns SPVC_SUCCESS to continue, or an error, which stops the write and is returned to the caller.
+ */
+typedef spvc_result (*spvc_write_callback)(void *userdata, const char *data, size_t size);
+
+/*!
+ @brief Compiles the shader and writes the source to a callback in chunks.
+
+ This does not stream from the emitter: SPIRV-Cross assembles the whole source
+ in the compiler's buffer before the first chunk is written, so peak memory is
+ that of @c spvc_compiler_compile. The chunks are passed directly from that
+ buffer, which only saves callers writing to a file, socket or Metal library
+ a copy of the source. @c spvc_msl_rebind_template_emit_to_callback does write
+ without assembling the source.
+
+ @param chunk_size The maximum size of each chunk, or 0 to write the source in a single call.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_compile_to_callback(spvc_compiler compiler, spvc_write_callback callback,
+                                                              void *userdata, size_t chunk_size);
+
+/*!
+ @brief Emits the template with new indices, like @c spvc_msl_rebind_template_emit,
+ writing each segment to a callback.
+
+ The source is never assembled, so memory use does not grow with the size of the output.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_rebind_template_emit_to_callback(spvc_msl_rebind_template template_,
+                                                                      const unsigned *index_option_values,
+                                                                      const spvc_msl_resource_binding *bindings,
+                                                                      size_t binding_count,
+                                                                      spvc_write_callback callback, void *userdata);
+
+#pragma mark - Context Arena
+
+/*
+ * A context whose per-compile objects can be released between compiles, so a
+ * long-lived worker can reuse one context at flat memory.
+ *
+ * Objects created through the arena are owned by its context, and are released
+ * together by spvc_context_arena_reset. The context itself, and its error
+ * callback, survive a reset.
+ *
+ * The arena tracks the objects it creates. It cannot see the allocations of
+ * SPIRV-Cross, so its byte counts are a proxy for the memory a context
+ * retains: the sizes of the SPIR-V each IR was parsed or copied from, plus the
+ * size of each generated source. The parsed IR and compilers hold several
+ * times their SPIR-V size. Each compile allocates a new source, which the
+ * context keeps until the next reset, so a compiler compiled twice is counted
+ * twice.
+ */
+
+typedef struct spvc_context_arena_s *spvc_context_arena;
+
+typedef enum spvc_context_arena_object
+{
+	SPVC_CONTEXT_ARENA_OBJECT_PARSED_IR = 0,
+	SPVC_CONTEXT_ARENA_OBJECT_COMPILER,
+	SPVC_CONTEXT_ARENA_OBJECT_COMPILER_OPTIONS,
+	SPVC_CONTEXT_ARENA_OBJECT_RESOURCES,
+	SPVC_CONTEXT_ARENA_OBJECT_SOURCE,
+	SPVC_CONTEXT_ARENA_OBJECT_COUNT,
+	SPVC_CONTEXT_ARENA_OBJECT_INT_MAX = 0x7fffffff
+} spvc_context_arena_object;
+
+typedef struct spvc_context_arena_stats
+{
+	/* Bytes of SPIR-V and generated source created since the last reset; a proxy, not the bytes allocated. */
+	size_t tracked_spirv_and_source_bytes;
+	/* The highest tracked_spirv_and_source_bytes reached since the arena was created. */
+	size_t peak_tracked_spirv_and_source_bytes;
+	size_t reset_count;
+
+	/* Objects of each kind created since the last reset. */
+	size_t live_count[SPVC_CONTEXT_ARENA_OBJECT_COUNT];
+	/* Objects of each kind created since the arena was created. */
+	size_t allocation_count[SPVC_CONTEXT_ARENA_OBJECT_COUNT];
+} spvc_context_arena_stats;
+
+SPVC_PUBLIC_API spvc_result spvc_context_arena_create(spvc_context_arena *arena);
+SPVC_PUBLIC_API void spvc_context_arena_destroy(spvc_context_arena arena);
+
+/*!
+ @brief Returns the context of the arena, e.g. to install an error callback.
+
+ Objects created on the context directly are released by a reset, but are not counted.
+ */
+SPVC_PUBLIC_API spvc_context spvc_context_arena_get_context(spvc_context_arena arena);
+
+SPVC_PUBLIC_API spvc_result spvc_context_arena_parse_spirv(spvc_context_arena arena, const SpvId *spirv,
+                                                           size_t word_count, spvc_parsed_ir *parsed_ir);
+SPVC_PUBLIC_API spvc_result spvc_context_arena_create_compiler(spvc_context_arena arena, spvc_backend backend,
+                                                               spvc_parsed_ir parsed_ir, spvc_capture_mode mode,
+                                                               spvc_compiler *compiler);
+SPVC_PUBLIC_API spvc_result spvc_context_arena_create_compiler_options(spvc_context_arena arena,
+                                                                       spvc_compiler compiler,
+                                                                       spvc_compiler_options *options);
+SPVC_PUBLIC_API spvc_result spvc_context_arena_create_shader_resources(spvc_context_arena arena,
+                                                                       spvc_compiler compiler,
+                                                                       spvc_resources *resources);
+SPVC_PUBLIC_API spvc_result spvc_context_arena_compile(spvc_context_arena arena, spvc_compiler compiler,
+                                                       const char **source);
+
+/*!
+ @brief Releases every object of the context, invalidating all handles created since the last reset.
+ */
+SPVC_PUBLIC_API void spvc_context_arena_reset(spvc_context_arena arena);
+
+SPVC_PUBLIC_API void spvc_context_arena_get_stats(spvc_context_arena arena, spvc_context_arena_stats *stats);
+
+#pragma mark - Stage Interface
+
+/*!
+ @brief Removes the vertex outputs which the fragment shader does not read.
+
+ The locations read by the active inputs of the fragment shader are computed,
+ and every vertex output at another location is masked with
+ @c spvc_compiler_mask_stage_output_by_location. The fragment shader is limited
+ to its active interface variables, so inputs it declares but never reads are
+ not emitted either. Built-in outputs, such as the position, are kept.
+
+ Both compilers must be created from the modules of the same pipeline, and
+ must not have been compiled.
+
+ @param vertex The compiler of the vertex shader.
+ @param fragment The compiler of the fragment shader.
+ @param pruned_count Receives the number of vertex outputs which were masked. May be NULL.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_prune_stage_interface(spvc_compiler vertex, spvc_compiler fragment,
+                                                                size_t *pruned_count);
+
+#pragma mark - Buffer Packing
+
+typedef struct spvc_buffer_packing
+{
+	/* The offset in the original block of the first byte of the packed block. */
+	unsigned offset;
+	/* The number of bytes to upload, from the start of the packed block to the end of its active members. */
+	size_t size;
+	/* The end of the active ranges in the original block. */
+	unsigned active_end;
+	/* The size of the packed block as declared, which includes any inactive members after its active span. */
+	size_t declared_size;
+} spvc_buffer_packing;
+
+/*!
+ @brief Moves the members of a uniform or push-constant block down, so the block starts at its first member,
+ and returns the range of the original data to upload.
+
+ The offset is aligned down to 16 bytes, which preserves the alignment of every
+ member. The runtime then uploads @c size bytes starting at @c offset of its
+ original data, which ends at the last active member, rounded up to 16 bytes.
+
+ MSL declares members in index order with increasing offsets, so inactive
+ members at the start of the block stop it from moving, and inactive members
+ at its end are still declared. A buffer bound with Metal API validation
+ enabled must hold @c declared_size bytes, of which only the first @c size are
+ read. Removing inactive members with the SPIRV-Tools EliminateDeadMembers
+ pass first, which keeps the offsets of the others, lets the block start at
+ its first active member and makes both sizes equal.
+
+ The Offset decorations of the block type are changed, so every variable of the
+ same type is packed. A block with no active ranges is left as it is, with a
+ @c size of 0. Must be called before the compiler is compiled.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_msl_pack_buffer(spvc_compiler compiler, spvc_variable_id id,
+                                                          spvc_type_id base_type_id, spvc_buffer_packing *packing);
+
+#pragma mark - Host Structs
+
+/*
+ * Generates host declarations of the uniform and push-constant blocks of a
+ * shader, so a runtime can write block members directly rather than looking up
+ * their offsets through reflection for every update.
+ *
+ * Each block and nested struct becomes a struct whose members sit at the
+ * offsets of the SPIR-V, whether its layout is std140, std430 or scalar, with
+ * explicit padding between members and after the last. Arrays and matrices
+ * whose stride exceeds their element are built from wrapper structs holding
+ * the element and its padding. Vectors and matrices are arrays, or tuples in
+ * Swift, of their scalars, and half floats are 16-bit integers.
+ *
+ * C++ structs are checked with static_assert. Swift cannot check a layout when
+ * compiling, so each Swift struct has an isLayoutValid property to check from
+ * a test or at startup.
+ */
+
+typedef enum spvc_host_struct_language
+{
+	SPVC_HOST_STRUCT_LANGUAGE_CPP = 0,
+	SPVC_HOST_STRUCT_LANGUAGE_SWIFT = 1,
+	SPVC_HOST_STRUCT_LANGUAGE_INT_MAX = 0x7fffffff
+} spvc_host_struct_language;
+
+/*!
+ @brief Writes the host structs of the compiler's uniform and push-constant blocks to a callback.
+
+ @returns SPVC_ERROR_UNSUPPORTED_SPIRV if a block holds a type with no host
+ equivalent, or members which overlap or are out of offset order.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_emit_host_structs(spvc_compiler compiler, spvc_host_struct_language language,
+                                                            spvc_write_callback callback, void *userdata);
+
+#pragma mark - MSL Library Builder
+
+/*
+ * Merges the MSL of many shaders into a single source, for one Metal library.
+ *
+ * Each shader's entry points and block types are renamed with a unique prefix
+ * before it is compiled. The output is split into top-level declarations, and
+ * identical declarations, such as the spv* helper templates and headers shared
+ * by several shaders, are emitted once.
+ *
+ * The structs, functions and constants a shader declares, including its
+ * gl_WorkGroupSize, are renamed with the same prefix in its output, so shaders
+ * may reuse names and declare different local sizes. The spv* helpers and
+ * function constants, which the API looks up by name, keep their names.
+ */
+
+typedef struct spvc_msl_library_builder_s *spvc_msl_library_builder;
+
+SPVC_PUBLIC_API spvc_result spvc_msl_library_builder_create(spvc_msl_library_builder *builder);
+SPVC_PUBLIC_API void spvc_msl_library_builder_destroy(spvc_msl_library_builder builder);
+
+/*!
+ @brief Renames the entry points and block types of the compiler with prefix, compiles it, and adds it to the library.
+
+ @param compiler A compiler which has not been compiled, with its options installed.
+ @param prefix A prefix unique in the library, which must be a valid MSL identifier.
+ @param entry_point_name Receives the name of the entry point in the library,
+ which is owned by the builder. May be NULL.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_library_builder_add_compiler(spvc_msl_library_builder builder,
+                                                                  spvc_compiler compiler, const char *prefix,
+                                                                  const char **entry_point_name);
+
+/*!
+ @brief Emits the library source.
+
+ @returns SPVC_ERROR_INVALID_ARGUMENT if two shaders declare different function
+ constants or spv* helpers with the same name, which cannot be merged.
+ spvc_msl_library_builder_get_conflict describes the first of them.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_library_builder_build(spvc_msl_library_builder builder, const char **source);
+
+/*!
+ @brief Returns the first declaration two shaders declare differently, with the prefixes of both, or NULL.
+
+ The string is owned by the builder.
+ */
+SPVC_PUBLIC_API const char *spvc_msl_library_builder_get_conflict(spvc_msl_library_builder builder);
+
+#pragma mark - MSL Minifier
+
+/*
+ * Minifies MSL to reduce the time Metal spends parsing it at runtime.
+ *
+ * Comments and insignificant whitespace are always removed. Preprocessor
+ * directives are kept on their own lines. Optional passes are selected by
+ * spvc_msl_minify_flags.
+ */
+
+typedef enum spvc_msl_minify_flag_bits
+{
+	SPVC_MSL_MINIFY_NONE = 0,
+	/* Removes helper functions which are not referenced, such as unused spv* templates. Entry points are kept. */
+	SPVC_MSL_MINIFY_UNUSED_HELPERS_BIT = 1 << 0,
+	/* Replaces ((expr)) with (expr), unless expr contains a top-level comma. */
+	SPVC_MSL_MINIFY_PARENTHESES_BIT = 1 << 1,
+	/* Renames the generated _<id> temporaries and types to the shortest unused names, by frequency. */
+	SPVC_MSL_MINIFY_RENAME_TEMPORARIES_BIT = 1 << 2,
+	SPVC_MSL_MINIFY_ALL = 0x7fffffff
+} spvc_msl_minify_flag_bits;
+typedef unsigned spvc_msl_minify_flags;
+
+typedef struct spvc_msl_minify_stats
+{
+	size_t input_size;
+	size_t output_size;
+	size_t removed_helpers;
+	size_t renamed_identifiers;
+} spvc_msl_minify_stats;
+
+/*!
+ @brief Minifies MSL, writing the result to a callback.
+
+ @param source The NUL-terminated MSL to minify.
+ @param stats Receives the size reduction. May be NULL.
+ */
+SPVC_PUBLIC_API spvc_result spvc_msl_minify(const char *source, spvc_msl_minify_flags flags,
+                                            spvc_write_callback callback, void *userdata,
+                                            spvc_msl_minify_stats *stats);
+
+#pragma mark - Shader Pack
+
+/*
+ * An archive of compiled shaders, intended to be memory-mapped and read in
+ * place.
+ *
+ * Each entry stores the SPIR-V, MSL and reflection blob of a shader under a
+ * unique key. The entry records follow the header, sorted by key hash and then
+ * key, so spvc_shader_pack_find is a binary search with no allocation. Every
+ * section of the file starts at a multiple of SPVC_SHADER_PACK_ALIGNMENT, so
+ * SPIR-V words and reflection records are aligned in the mapping.
+ *
+ * The pack is little-endian. Keys and MSL are NUL-terminated, and their sizes
+ * exclude the terminator.
+ */
+
+#define SPVC_SHADER_PACK_MAGIC 0x4b505053u /* 'SPPK' */
+#define SPVC_SHADER_PACK_VERSION 1u
+#define SPVC_SHADER_PACK_ALIGNMENT 64u
+
+typedef struct spvc_shader_pack
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t entry_count;
+	uint32_t entry_stride;
+	uint32_t reserved0;
+	/* Total size of the pack in bytes, including this header. */
+	uint64_t size;
+	uint64_t entries_offset;
+	uint64_t reserved[3];
+} spvc_shader_pack;
+
+typedef struct spvc_shader_pack_entry
+{
+	uint64_t key_hash;
+	uint64_t key_offset;
+	uint64_t spirv_offset;
+	uint64_t msl_offset;
+	uint64_t reflection_offset;
+	uint32_t key_size;
+	/* In bytes. */
+	uint32_t spirv_size;
+	uint32_t msl_size;
+	uint32_t reflection_size;
+	uint64_t reserved;
+} spvc_shader_pack_entry;
+
+typedef struct spvc_shader_pack_writer_s *spvc_shader_pack_writer;
+
+SPVC_PUBLIC_API spvc_result spvc_shader_pack_writer_create(spvc_shader_pack_writer *writer);
+SPVC_PUBLIC_API void spvc_shader_pack_writer_destroy(spvc_shader_pack_writer writer);
+
+/*!
+ @brief Copies a shader into the writer.
+
+ @param key The key of the shader, which must be unique in the pack.
+ @param spirv The SPIR-V of the shader. May be NULL if word_count is 0.
+ @param msl The MSL of the shader. May be NULL.
+ @param reflection A reflection blob from @c spvc_reflection_snapshot_serialize. May be NULL if reflection_size is 0.
+ @returns SPVC_ERROR_INVALID_ARGUMENT if the key is already used, or the reflection blob is invalid.
+ */
+SPVC_PUBLIC_API spvc_result spvc_shader_pack_writer_add(spvc_shader_pack_writer writer, const char *key,
+                                                        size_t key_size, const SpvId *spirv, size_t word_count,
+                                                        const char *msl, const void *reflection,
+                                                        size_t reflection_size);
+
+/*!
+ @brief Writes the pack to a callback, in order.
+ */
+SPVC_PUBLIC_API spvc_result spvc_shader_pack_writer_write(spvc_shader_pack_writer writer,
+                                                          spvc_write_callback callback, void *userdata);
+
+/*!
+ @brief Validates the header and the bounds of every entry of a shader pack.
+
+ Validation visits each entry once, so lookups do not need to check bounds.
+
+ @returns The pack, or NULL if data is not a compatible shader pack.
+ */
+SPVC_PUBLIC_API const spvc_shader_pack *spvc_shader_pack_validate(const void *data, size_t size);
+
+/*!
+ @brief Finds the entry of a key.
+
+ @returns The entry, or NULL if the pack has no entry for the key.
+ */
+SPVC_PUBLIC_API const spvc_shader_pack_entry *spvc_shader_pack_find(const spvc_shader_pack *pack, const char *key,
+                                                                   size_t key_size);
+
+static inline const spvc_shader_pack_entry *spvc_shader_pack_get_entry(const spvc_shader_pack *pack, uint32_t index)
+{
+	return (const spvc_shader_pack_entry *)((const char *)pack + pack->entries_offset +
+	                                        (size_t)index * pack->entry_stride);
+}
+
+static inline const char *spvc_shader_pack_get_key(const spvc_shader_pack *pack, const spvc_shader_pack_entry *entry)
+{
+	return (const char *)pack + entry->key_offset;
+}
+
+static inline const SpvId *spvc_shader_pack_get_spirv(const spvc_shader_pack *pack,
+                                                      const spvc_shader_pack_entry *entry)
+{
+	return (const SpvId *)((const char *)pack + entry->spirv_offset);
+}
+
+static inline const char *spvc_shader_pack_get_msl(const spvc_shader_pack *pack, const spvc_shader_pack_entry *entry)
+{
+	return (const char *)pack + entry->msl_offset;
+}
+
+/* Returns the reflection blob of the entry, or NULL if it has none. */
+static inline const spvc_reflection_blob *spvc_shader_pack_get_reflection(const spvc_shader_pack *pack,
+                                                                          const spvc_shader_pack_entry *entry)
+{
+	if (entry->reflection_size == 0)
+		return NULL;
+	return (const spvc_reflection_blob *)((const char *)pack + entry->reflection_offset);
+}
+
+#pragma mark - Tracing
+
+/*!
+ @brief Compiles the shader like @c spvc_compiler_compile, recording the compile as a span
+ when @c spvt_trace_start has been called.
+
+ The compile entry points of this extension layer record their compiles in the same way, and
+ every compile of SPVMetalCompiler goes through them. @c spvc_compiler_compile itself belongs
+ to SPIRV-Cross and is not traced, so C callers, and Swift code calling SPVCompiler.compile on
+ the raw compiler handle, must call this instead for their compiles to appear in a trace.
+ */
+SPVC_PUBLIC_API spvc_result spvc_compiler_compile_traced(spvc_compiler compiler, const char **source);
+
+#pragma mark - Async Pipeline
+
+/*
+ * Compiles GLSL to SPIR-V, and optionally optimizes it and cross-compiles it
+ * to MSL, without blocking the calling thread.
+ *
+ * Jobs run on a process-wide work-stealing pool with a worker per hardware
+ * thread, which is started by the first job. Each worker reuses one SPIRV-Cross
+ * context across its jobs.
+ *
+ * Interactive jobs are taken before any background job. When every worker is
+ * busy, a background job yields to queued interactive jobs at its stage
+ * boundaries: after linking and SPIR-V generation, and before each optimizer
+ * pass. The interactive jobs run to completion on the
+ * same worker before the background job resumes.
+ */
+
+typedef struct spv_pipeline_job_s *spv_pipeline_job;
+
+typedef enum spv_pipeline_flag_bits
+{
+	/* Runs the SPIRV-Tools performance passes over the SPIR-V. */
+	SPV_PIPELINE_OPTIMIZE_BIT = 1 << 0,
+	/* Cross-compiles the SPIR-V to MSL. */
+	SPV_PIPELINE_MSL_BIT = 1 << 1,
+	SPV_PIPELINE_FLAG_INT_MAX = 0x7fffffff
+} spv_pipeline_flag_bits;
+typedef unsigned spv_pipeline_flags;
+
+typedef enum spv_pipeline_status
+{
+	SPV_PIPELINE_STATUS_PENDING = 0,
+	SPV_PIPELINE_STATUS_RUNNING,
+	SPV_PIPELINE_STATUS_SUCCEEDED,
+	SPV_PIPELINE_STATUS_FAILED,
+	SPV_PIPELINE_STATUS_CANCELLED,
+	SPV_PIPELINE_STATUS_INT_MAX = 0x7fffffff
+} spv_pipeline_status;
+
+typedef enum spv_pipeline_priority
+{
+	/* Work a user is waiting on. A zeroed request is interactive. */
+	SPV_PIPELINE_PRIORITY_INTERACTIVE = 0,
+	/* Work nobody is waiting on yet, such as warming a cache. */
+	SPV_PIPELINE_PRIORITY_BACKGROUND,
+	SPV_PIPELINE_PRIORITY_INT_MAX = 0x7fffffff
+} spv_pipeline_priority;
+
+typedef struct spv_pipeline_request
+{
+	/*
+	 * The glslang input, which is copied along with its code or segments. The
+	 * resource limits, include callbacks and cancel token it references must
+	 * remain valid until the job completes. Its deadline bounds the glslang
+	 * phases.
+	 */
+	const struct glslang_input_s *input;
+	spv_pipeline_flags flags;
+	/* The MSL version, from SPVC_MAKE_MSL_VERSION, or 0 for the SPIRV-Cross default. */
+	unsigned msl_version;
+	spv_pipeline_priority priority;
+} spv_pipeline_request;
+
+/*!
+ @brief Called on a pool thread when the job has finished, failed or been cancelled, before waiters are woken.
+
+ The job remains valid for the duration of the call.
+ */
+typedef void (*spv_pipeline_callback)(void *userdata, spv_pipeline_job job);
+
+/*!
+ @brief Queues a compile.
+
+ @param callback Called once when the job completes. May be NULL.
+ @param job Receives the job, which must be released with @c spv_pipeline_job_release.
+ */
+SPVC_PUBLIC_API spvc_result spv_pipeline_compile_async(const spv_pipeline_request *request,
+                                                       spv_pipeline_callback callback, void *userdata,
+                                                       spv_pipeline_job *job);
+
+/*!
+ @brief Queues a compile for each of count requests.
+
+ The jobs are queued together, so workers are woken once. Either every job is queued, or none is.
+
+ @param callback Called once as each job completes. May be NULL.
+ @param jobs Receives count jobs, which must each be released with @c spv_pipeline_job_release.
+ */
+SPVC_PUBLIC_API spvc_result spv_pipeline_compile_batch(const spv_pipeline_request *requests, size_t count,
+                                                       spv_pipeline_callback callback, void *userdata,
+                                                       spv_pipeline_job *jobs);
+
+SPVC_PUBLIC_API spv_pipeline_status spv_pipeline_job_poll(spv_pipeline_job job);
+
+/*!
+ @brief Raises a background job to interactive.
+
+ A queued job moves ahead of every background job. A running job stops yielding at its stage boundaries.
+ */
+SPVC_PUBLIC_API void spv_pipeline_job_promote(spv_pipeline_job job);
+
+/*!
+ @brief Waits for the job to complete.
+
+ @param timeout_ns The longest time to wait, 0 to poll, or UINT64_MAX to wait until it completes.
+ @returns The status of the job, which is pending or running if the wait timed out.
+ */
+SPVC_PUBLIC_API spv_pipeline_status spv_pipeline_job_wait(spv_pipeline_job job, uint64_t timeout_ns);
+
+/*!
+ @brief Requests that the job stop.
+
+ A pending job is cancelled without running. A running job stops at the next stage
+ boundary or #include, and completes as cancelled unless it had already finished.
+ */
+SPVC_PUBLIC_API void spv_pipeline_job_cancel(spv_pipeline_job job);
+
+/* The results of a completed job, which are owned by the job. */
+SPVC_PUBLIC_API const SpvId *spv_pipeline_job_get_spirv(spv_pipeline_job job, size_t *word_count);
+SPVC_PUBLIC_API const char *spv_pipeline_job_get_msl(spv_pipeline_job job);
+SPVC_PUBLIC_API const char *spv_pipeline_job_get_log(spv_pipeline_job job);
+
+/*!
+ @brief Releases the caller's reference. A job which is still queued or running keeps going.
+ */
+SPVC_PUBLIC_API void spv_pipeline_job_release(spv_pipeline_job job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* spirv_cross_c_ext_h */
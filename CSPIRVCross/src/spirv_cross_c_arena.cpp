@@ -0,0 +1,154 @@
+//
+//  spirv_cross_c_arena.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <new>
+#include <string.h>
+#include <unordered_map>
+
+using namespace std;
+
+struct spvc_context_arena_s
+{
+	spvc_context context = nullptr;
+	spvc_context_arena_stats stats = {};
+
+	// Sizes of the parsed IR, which are charged again when a compiler copies them.
+	unordered_map<spvc_parsed_ir, size_t> ir_bytes;
+
+	void track(spvc_context_arena_object kind, size_t bytes)
+	{
+		stats.live_count[kind]++;
+		stats.allocation_count[kind]++;
+		stats.tracked_spirv_and_source_bytes += bytes;
+		if (stats.tracked_spirv_and_source_bytes > stats.peak_tracked_spirv_and_source_bytes)
+			stats.peak_tracked_spirv_and_source_bytes = stats.tracked_spirv_and_source_bytes;
+	}
+};
+
+spvc_result spvc_context_arena_create(spvc_context_arena *arena)
+{
+	if (!arena)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto *a = new (nothrow) spvc_context_arena_s;
+	if (!a)
+		return SPVC_ERROR_OUT_OF_MEMORY;
+
+	spvc_result result = spvc_context_create(&a->context);
+	if (result != SPVC_SUCCESS)
+	{
+		delete a;
+		return result;
+	}
+
+	*arena = a;
+	return SPVC_SUCCESS;
+}
+
+void spvc_context_arena_destroy(spvc_context_arena arena)
+{
+	if (!arena)
+		return;
+	spvc_context_destroy(arena->context);
+	delete arena;
+}
+
+spvc_context spvc_context_arena_get_context(spvc_context_arena arena)
+{
+	return arena ? arena->context : nullptr;
+}
+
+spvc_result spvc_context_arena_parse_spirv(spvc_context_arena arena, const SpvId *spirv, size_t word_count,
+                                           spvc_parsed_ir *parsed_ir)
+{
+	if (!arena || !parsed_ir)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_context_parse_spirv(arena->context, spirv, word_count, parsed_ir);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	size_t bytes = word_count * sizeof(SpvId);
+	arena->ir_bytes[*parsed_ir] = bytes;
+	arena->track(SPVC_CONTEXT_ARENA_OBJECT_PARSED_IR, bytes);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_context_arena_create_compiler(spvc_context_arena arena, spvc_backend backend,
+                                               spvc_parsed_ir parsed_ir, spvc_capture_mode mode,
+                                               spvc_compiler *compiler)
+{
+	if (!arena || !compiler)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_context_create_compiler(arena->context, backend, parsed_ir, mode, compiler);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	size_t bytes = 0;
+	if (mode == SPVC_CAPTURE_MODE_COPY)
+	{
+		auto itr = arena->ir_bytes.find(parsed_ir);
+		if (itr != arena->ir_bytes.end())
+			bytes = itr->second;
+	}
+	arena->track(SPVC_CONTEXT_ARENA_OBJECT_COMPILER, bytes);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_context_arena_create_compiler_options(spvc_context_arena arena, spvc_compiler compiler,
+                                                       spvc_compiler_options *options)
+{
+	if (!arena)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_compiler_create_compiler_options(compiler, options);
+	if (result == SPVC_SUCCESS)
+		arena->track(SPVC_CONTEXT_ARENA_OBJECT_COMPILER_OPTIONS, 0);
+	return result;
+}
+
+spvc_result spvc_context_arena_create_shader_resources(spvc_context_arena arena, spvc_compiler compiler,
+                                                       spvc_resources *resources)
+{
+	if (!arena)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_compiler_create_shader_resources(compiler, resources);
+	if (result == SPVC_SUCCESS)
+		arena->track(SPVC_CONTEXT_ARENA_OBJECT_RESOURCES, 0);
+	return result;
+}
+
+spvc_result spvc_context_arena_compile(spvc_context_arena arena, spvc_compiler compiler, const char **source)
+{
+	if (!arena || !source)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_compiler_compile_traced(compiler, source);
+	if (result == SPVC_SUCCESS)
+		arena->track(SPVC_CONTEXT_ARENA_OBJECT_SOURCE, strlen(*source) + 1);
+	return result;
+}
+
+void spvc_context_arena_reset(spvc_context_arena arena)
+{
+	if (!arena)
+		return;
+
+	spvc_context_release_allocations(arena->context);
+	arena->ir_bytes.clear();
+	arena->stats.tracked_spirv_and_source_bytes = 0;
+	memset(arena->stats.live_count, 0, sizeof(arena->stats.live_count));
+	arena->stats.reset_count++;
+}
+
+void spvc_context_arena_get_stats(spvc_context_arena arena, spvc_context_arena_stats *stats)
+{
+	if (arena && stats)
+		*stats = arena->stats;
+}
@@ -0,0 +1,457 @@
+//
+//  spirv_cross_c_host_structs.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+static const spvc_resource_type host_struct_resource_types[] = {
+	SPVC_RESOURCE_TYPE_UNIFORM_BUFFER,
+	SPVC_RESOURCE_TYPE_PUSH_CONSTANT,
+};
+
+// Swift keywords, which are escaped with backticks.
+static const unordered_set<string> swift_keywords = {
+	"associatedtype", "actor", "as", "Any", "await", "break", "case", "catch", "class", "continue", "default",
+	"defer", "deinit", "do", "else", "enum", "extension", "fallthrough", "false", "fileprivate", "for",
+	"func", "guard", "if", "import", "in", "init", "inout", "internal", "is", "let", "nil", "open",
+	"operator", "private", "protocol", "public", "repeat", "rethrows", "return", "self", "Self",
+	"static", "struct", "subscript", "super", "switch", "throw", "throws", "true", "try", "typealias",
+	"var", "where", "while",
+};
+
+// C++ keywords, which are suffixed with an underscore.
+static const unordered_set<string> cpp_keywords = {
+	"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+	"char", "char8_t", "char16_t", "char32_t", "class", "co_await", "co_return", "co_yield", "compl",
+	"concept", "const", "const_cast", "consteval", "constexpr", "constinit", "continue", "decltype",
+	"default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern",
+	"false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new",
+	"noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public",
+	"register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+	"static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+	"try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+	"wchar_t", "while", "xor", "xor_eq",
+};
+
+// A host type, which is an element type and C++ array declarator, or a Swift type.
+struct HostType
+{
+	// Names the padded wrappers of the type, such as "float3".
+	string key;
+	string cpp;
+	// The C++ array declarator which follows the member name, such as "[4][3]".
+	string cpp_dims;
+	string swift;
+	// A Swift expression of the zero value.
+	string swift_zero;
+	size_t size = 0;
+};
+
+class Generator
+{
+public:
+	Generator(spvc_compiler compiler_, spvc_host_struct_language language_)
+	    : compiler(compiler_)
+	    , language(language_)
+	{
+	}
+
+	spvc_result generate()
+	{
+		spvc_resources resources = nullptr;
+		spvc_result result = spvc_compiler_create_shader_resources(compiler, &resources);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		for (spvc_resource_type type : host_struct_resource_types)
+		{
+			const spvc_reflected_resource *list = nullptr;
+			size_t count = 0;
+			result = spvc_resources_get_resource_list_for_type(resources, type, &list, &count);
+			if (result != SPVC_SUCCESS)
+				return result;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				HostType host;
+				result = struct_type(list[i].base_type_id, host);
+				if (result != SPVC_SUCCESS)
+					return result;
+			}
+		}
+		return SPVC_SUCCESS;
+	}
+
+	string header() const
+	{
+		string s = "// Generated from the uniform and push-constant blocks of a SPIR-V module.\n\n";
+		if (language == SPVC_HOST_STRUCT_LANGUAGE_CPP)
+			s += "#pragma once\n\n#include <stddef.h>\n#include <stdint.h>\n\n";
+		return s;
+	}
+
+	string out;
+
+private:
+	spvc_compiler compiler;
+	spvc_host_struct_language language;
+	unordered_map<spvc_type_id, HostType> structs;
+	unordered_map<string, HostType> padded;
+	unordered_set<string> names;
+
+	bool is_swift() const
+	{
+		return language == SPVC_HOST_STRUCT_LANGUAGE_SWIFT;
+	}
+
+	string unique_name(string name)
+	{
+		string candidate = name;
+		for (unsigned n = 1; !names.insert(candidate).second; n++)
+			candidate = name + "_" + to_string(n);
+		return candidate;
+	}
+
+	string identifier(const string &name) const
+	{
+		if (is_swift())
+			return swift_keywords.count(name) ? "`" + name + "`" : name;
+		return cpp_keywords.count(name) ? name + "_" : name;
+	}
+
+	static spvc_result scalar_type(spvc_basetype basetype, HostType &host)
+	{
+		switch (basetype)
+		{
+		// Booleans cannot be stored in a block; they are 32-bit integers in memory.
+		case SPVC_BASETYPE_BOOLEAN:
+		case SPVC_BASETYPE_UINT32:
+			host = { "uint", "uint32_t", "", "UInt32", "0", 4 };
+			break;
+		case SPVC_BASETYPE_INT32:
+			host = { "int", "int32_t", "", "Int32", "0", 4 };
+			break;
+		case SPVC_BASETYPE_FP32:
+			host = { "float", "float", "", "Float", "0", 4 };
+			break;
+		case SPVC_BASETYPE_FP64:
+			host = { "double", "double", "", "Double", "0", 8 };
+			break;
+		// Half floats are passed as their bits, as neither language has a portable 16-bit float.
+		case SPVC_BASETYPE_FP16:
+			host = { "half", "uint16_t", "", "UInt16", "0", 2 };
+			break;
+		case SPVC_BASETYPE_INT8:
+			host = { "char", "int8_t", "", "Int8", "0", 1 };
+			break;
+		case SPVC_BASETYPE_UINT8:
+			host = { "uchar", "uint8_t", "", "UInt8", "0", 1 };
+			break;
+		case SPVC_BASETYPE_INT16:
+			host = { "short", "int16_t", "", "Int16", "0", 2 };
+			break;
+		case SPVC_BASETYPE_UINT16:
+			host = { "ushort", "uint16_t", "", "UInt16", "0", 2 };
+			break;
+		case SPVC_BASETYPE_INT64:
+			host = { "long", "int64_t", "", "Int64", "0", 8 };
+			break;
+		case SPVC_BASETYPE_UINT64:
+			host = { "ulong", "uint64_t", "", "UInt64", "0", 8 };
+			break;
+		default:
+			return SPVC_ERROR_UNSUPPORTED_SPIRV;
+		}
+		return SPVC_SUCCESS;
+	}
+
+	static string repeat(const string &element, size_t count)
+	{
+		if (count == 1)
+			return element;
+
+		string s = "(";
+		for (size_t i = 0; i < count; i++)
+		{
+			if (i)
+				s += ", ";
+			s += element;
+		}
+		return s + ")";
+	}
+
+	static string padding_type(size_t size)
+	{
+		return repeat("UInt8", size);
+	}
+
+	// Declares a member of the struct being built in body.
+	void declare(string &body, const HostType &type, const string &name, bool is_public)
+	{
+		if (is_swift())
+			body += string("    ") + (is_public ? "public " : "") + "var " + name + ": " + type.swift + " = " +
+			        type.swift_zero + "\n";
+		else
+			body += "\t" + type.cpp + " " + name + type.cpp_dims + ";\n";
+	}
+
+	void declare_padding(string &body, size_t size, unsigned &pad_index)
+	{
+		string name = "_pad" + to_string(pad_index++);
+		if (is_swift())
+			declare(body, { "", "", "", padding_type(size), repeat("0", size), size }, name, false);
+		else
+			body += "\tuint8_t " + name + "[" + to_string(size) + "];\n";
+	}
+
+	struct Member
+	{
+		string name;
+		size_t offset;
+	};
+
+	void emit_struct(const string &name, const string &body, const vector<Member> &members, size_t size)
+	{
+		if (is_swift())
+		{
+			out += "public struct " + name + " {\n" + body + "\n    public init() {}\n\n";
+			out += "    /// Whether the Swift layout matches the block, which Swift cannot check when compiling.\n";
+			out += "    public static var isLayoutValid: Bool {\n";
+			out += "        MemoryLayout<" + name + ">.size == " + to_string(size);
+			for (auto &member : members)
+				out += "\n            && MemoryLayout<" + name + ">.offset(of: \\." + member.name +
+				       ") == " + to_string(member.offset);
+			out += "\n    }\n}\n\n";
+		}
+		else
+		{
+			out += "struct " + name + "\n{\n" + body + "};\n";
+			for (auto &member : members)
+				out += "static_assert(offsetof(" + name + ", " + member.name + ") == " + to_string(member.offset) +
+				       ", \"" + name + "::" + member.name + "\");\n";
+			out += "static_assert(sizeof(" + name + ") == " + to_string(size) + ", \"" + name + "\");\n\n";
+		}
+	}
+
+	// Wraps element in a struct of stride bytes, for arrays whose stride exceeds the element's size.
+	HostType padded_type(const HostType &element, size_t stride)
+	{
+		string key = element.key + "_stride" + to_string(stride);
+		auto itr = padded.find(key);
+		if (itr != padded.end())
+			return itr->second;
+
+		string name = unique_name(key);
+		string body;
+		unsigned pad_index = 0;
+		declare(body, element, "value", true);
+		declare_padding(body, stride - element.size, pad_index);
+		emit_struct(name, body, { { "value", 0 } }, stride);
+
+		HostType host = { key, name, "", name, name + "()", stride };
+		padded[key] = host;
+		return host;
+	}
+
+	HostType array_type(const HostType &element, size_t count, size_t stride, const string &key)
+	{
+		HostType slot = stride > element.size ? padded_type(element, stride) : element;
+		HostType host;
+		host.key = key;
+		host.cpp = slot.cpp;
+		host.cpp_dims = "[" + to_string(count) + "]" + slot.cpp_dims;
+		host.swift = repeat(slot.swift, count);
+		host.swift_zero = repeat(slot.swift_zero, count);
+		host.size = count * slot.size;
+		return host;
+	}
+
+	spvc_result array_length(spvc_type type, unsigned dimension, size_t &length)
+	{
+		SpvId value = spvc_type_get_array_dimension(type, dimension);
+		if (spvc_type_array_dimension_is_literal(type, dimension))
+		{
+			length = value;
+		}
+		else
+		{
+			// An array sized by a specialization constant takes its default size.
+			spvc_constant constant = spvc_compiler_get_constant_handle(compiler, value);
+			if (!constant)
+				return SPVC_ERROR_UNSUPPORTED_SPIRV;
+			length = spvc_constant_get_scalar_u32(constant, 0, 0);
+		}
+		// Blocks cannot hold runtime arrays, which would have a length of 0.
+		return length ? SPVC_SUCCESS : SPVC_ERROR_UNSUPPORTED_SPIRV;
+	}
+
+	spvc_result member_type(spvc_type parent, spvc_type_id parent_id, unsigned index, HostType &host)
+	{
+		spvc_type type = spvc_compiler_get_type_handle(compiler, spvc_type_get_member_type(parent, index));
+		if (!type)
+			return SPVC_ERROR_INVALID_ARGUMENT;
+
+		spvc_result result;
+		spvc_basetype basetype = spvc_type_get_basetype(type);
+		if (basetype == SPVC_BASETYPE_STRUCT)
+		{
+			result = struct_type(spvc_type_get_base_type_id(type), host);
+			if (result != SPVC_SUCCESS)
+				return result;
+		}
+		else
+		{
+			HostType scalar;
+			result = scalar_type(basetype, scalar);
+			if (result != SPVC_SUCCESS)
+				return result;
+
+			// Vector components are always tightly packed.
+			unsigned rows = spvc_type_get_vector_size(type);
+			unsigned columns = spvc_type_get_columns(type);
+			host = rows > 1 ? array_type(scalar, rows, scalar.size, scalar.key + to_string(rows)) : scalar;
+
+			if (columns > 1)
+			{
+				bool row_major = spvc_compiler_has_member_decoration(compiler, parent_id, index, SpvDecorationRowMajor);
+				unsigned matrix_stride = 0;
+				result = spvc_compiler_type_struct_member_matrix_stride(compiler, parent, index, &matrix_stride);
+				if (result != SPVC_SUCCESS)
+					return result;
+
+				// A row-major matrix is stored as rows of columns elements.
+				HostType vector = row_major ? array_type(scalar, columns, scalar.size, scalar.key + to_string(columns)) : host;
+				string key = scalar.key + to_string(columns) + "x" + to_string(rows) + (row_major ? "_row_major" : "");
+				host = array_type(vector, row_major ? rows : columns, matrix_stride, key);
+			}
+		}
+
+		unsigned dimensions = spvc_type_get_num_array_dimensions(type);
+		if (dimensions == 0)
+			return SPVC_SUCCESS;
+
+		// The stride is of the outermost dimension, and each inner array fills its parent's element.
+		vector<size_t> lengths(dimensions);
+		size_t inner_length = 1;
+		for (unsigned i = 0; i < dimensions; i++)
+		{
+			result = array_length(type, i, lengths[i]);
+			if (result != SPVC_SUCCESS)
+				return result;
+			if (i + 1 < dimensions)
+				inner_length *= lengths[i];
+		}
+
+		unsigned array_stride = 0;
+		result = spvc_compiler_type_struct_member_array_stride(compiler, parent, index, &array_stride);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		size_t stride = array_stride / inner_length;
+		for (unsigned i = 0; i < dimensions; i++)
+		{
+			if (stride < host.size)
+				return SPVC_ERROR_UNSUPPORTED_SPIRV;
+			host = array_type(host, lengths[i], stride, host.key + "_" + to_string(lengths[i]));
+			stride *= lengths[i];
+		}
+		return SPVC_SUCCESS;
+	}
+
+	// Emits the struct of a type, after the structs and wrappers of its members.
+	spvc_result struct_type(spvc_type_id id, HostType &host)
+	{
+		auto itr = structs.find(id);
+		if (itr != structs.end())
+		{
+			host = itr->second;
+			return SPVC_SUCCESS;
+		}
+
+		spvc_type type = spvc_compiler_get_type_handle(compiler, id);
+		if (!type || spvc_type_get_basetype(type) != SPVC_BASETYPE_STRUCT)
+			return SPVC_ERROR_INVALID_ARGUMENT;
+
+		size_t size = 0;
+		spvc_result result = spvc_compiler_get_declared_struct_size(compiler, type, &size);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		string body;
+		vector<Member> members;
+		unsigned pad_index = 0;
+		size_t cursor = 0;
+		unsigned count = spvc_type_get_num_member_types(type);
+		for (unsigned i = 0; i < count; i++)
+		{
+			unsigned offset = 0;
+			result = spvc_compiler_type_struct_member_offset(compiler, type, i, &offset);
+			if (result != SPVC_SUCCESS)
+				return result;
+
+			HostType member;
+			result = member_type(type, id, i, member);
+			if (result != SPVC_SUCCESS)
+				return result;
+
+			// Members must be declared in offset order, which glslang always emits.
+			if (offset < cursor)
+				return SPVC_ERROR_UNSUPPORTED_SPIRV;
+			if (offset > cursor)
+				declare_padding(body, offset - cursor, pad_index);
+
+			string name = spvc_compiler_get_member_name(compiler, id, i);
+			if (name.empty())
+				name = "_m" + to_string(i);
+			name = identifier(name);
+			declare(body, member, name, true);
+			members.push_back({ name, offset });
+			cursor = offset + member.size;
+		}
+
+		if (size < cursor)
+			return SPVC_ERROR_UNSUPPORTED_SPIRV;
+		if (size > cursor)
+			declare_padding(body, size - cursor, pad_index);
+
+		string name = spvc_compiler_get_name(compiler, id);
+		if (name.empty())
+			name = "_" + to_string(id);
+		name = unique_name(identifier(name));
+		emit_struct(name, body, members, size);
+
+		host = { name, name, "", name, name + "()", size };
+		structs[id] = host;
+		return SPVC_SUCCESS;
+	}
+};
+} // namespace
+
+spvc_result spvc_compiler_emit_host_structs(spvc_compiler compiler, spvc_host_struct_language language,
+                                            spvc_write_callback callback, void *userdata)
+{
+	if (!compiler || !callback ||
+	    (language != SPVC_HOST_STRUCT_LANGUAGE_CPP && language != SPVC_HOST_STRUCT_LANGUAGE_SWIFT))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	Generator generator(compiler, language);
+	spvc_result result = generator.generate();
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	string header = generator.header();
+	result = callback(userdata, header.data(), header.size());
+	if (result != SPVC_SUCCESS)
+		return result;
+	return callback(userdata, generator.out.data(), generator.out.size());
+}
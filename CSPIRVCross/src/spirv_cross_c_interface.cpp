@@ -0,0 +1,123 @@
+//
+//  spirv_cross_c_interface.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <unordered_set>
+
+using namespace std;
+
+namespace
+{
+// Returns the number of consecutive locations consumed by a variable of the type.
+static unsigned location_count(spvc_compiler compiler, spvc_type type)
+{
+	unsigned count = 0;
+	unsigned members = spvc_type_get_num_member_types(type);
+	if (members > 0)
+	{
+		for (unsigned i = 0; i < members; i++)
+			count += location_count(compiler, spvc_compiler_get_type_handle(compiler, spvc_type_get_member_type(type, i)));
+	}
+	else
+	{
+		// 64-bit vectors with more than two components consume two locations per column.
+		bool wide = spvc_type_get_bit_width(type) == 64 && spvc_type_get_vector_size(type) > 2;
+		count = spvc_type_get_columns(type) * (wide ? 2 : 1);
+	}
+
+	for (unsigned i = 0; i < spvc_type_get_num_array_dimensions(type); i++)
+	{
+		// Runtime-sized arrays cannot be interface variables, but keep the base location just in case.
+		if (spvc_type_array_dimension_is_literal(type, i))
+			count *= spvc_type_get_array_dimension(type, i);
+	}
+	return count;
+}
+
+static spvc_result get_stage_resources(spvc_compiler compiler, spvc_resource_type type, bool active_only,
+                                       const spvc_reflected_resource **list, size_t *count)
+{
+	spvc_resources resources = nullptr;
+	spvc_result result;
+	if (active_only)
+	{
+		spvc_set active = nullptr;
+		result = spvc_compiler_get_active_interface_variables(compiler, &active);
+		if (result == SPVC_SUCCESS)
+			result = spvc_compiler_set_enabled_interface_variables(compiler, active);
+		if (result == SPVC_SUCCESS)
+			result = spvc_compiler_create_shader_resources_for_active_variables(compiler, &resources, active);
+	}
+	else
+		result = spvc_compiler_create_shader_resources(compiler, &resources);
+
+	if (result != SPVC_SUCCESS)
+		return result;
+	return spvc_resources_get_resource_list_for_type(resources, type, list, count);
+}
+} // namespace
+
+spvc_result spvc_compiler_prune_stage_interface(spvc_compiler vertex, spvc_compiler fragment, size_t *pruned_count)
+{
+	if (!vertex || !fragment)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	if (spvc_compiler_get_execution_model(vertex) != SpvExecutionModelVertex ||
+	    spvc_compiler_get_execution_model(fragment) != SpvExecutionModelFragment)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	const spvc_reflected_resource *inputs = nullptr;
+	size_t input_count = 0;
+	spvc_result result =
+	    get_stage_resources(fragment, SPVC_RESOURCE_TYPE_STAGE_INPUT, true, &inputs, &input_count);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	unordered_set<unsigned> read_locations;
+	for (size_t i = 0; i < input_count; i++)
+	{
+		if (!spvc_compiler_has_decoration(fragment, inputs[i].id, SpvDecorationLocation))
+			continue;
+
+		unsigned location = spvc_compiler_get_decoration(fragment, inputs[i].id, SpvDecorationLocation);
+		unsigned count = location_count(fragment, spvc_compiler_get_type_handle(fragment, inputs[i].type_id));
+		for (unsigned l = 0; l < count; l++)
+			read_locations.insert(location + l);
+	}
+
+	const spvc_reflected_resource *outputs = nullptr;
+	size_t output_count = 0;
+	result = get_stage_resources(vertex, SPVC_RESOURCE_TYPE_STAGE_OUTPUT, false, &outputs, &output_count);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	size_t pruned = 0;
+	for (size_t i = 0; i < output_count; i++)
+	{
+		spvc_variable_id id = outputs[i].id;
+		if (!spvc_compiler_has_decoration(vertex, id, SpvDecorationLocation) ||
+		    spvc_compiler_has_decoration(vertex, id, SpvDecorationBuiltIn))
+			continue;
+
+		// Keep outputs which overlap any location the fragment shader reads.
+		unsigned location = spvc_compiler_get_decoration(vertex, id, SpvDecorationLocation);
+		unsigned count = location_count(vertex, spvc_compiler_get_type_handle(vertex, outputs[i].type_id));
+		bool read = false;
+		for (unsigned l = 0; l < count && !read; l++)
+			read = read_locations.count(location + l) != 0;
+		if (read)
+			continue;
+
+		unsigned component = spvc_compiler_get_decoration(vertex, id, SpvDecorationComponent);
+		result = spvc_compiler_mask_stage_output_by_location(vertex, location, component);
+		if (result != SPVC_SUCCESS)
+			return result;
+		pruned++;
+	}
+
+	if (pruned_count)
+		*pruned_count = pruned;
+	return SPVC_SUCCESS;
+}
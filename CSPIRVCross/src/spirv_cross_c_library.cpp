@@ -0,0 +1,457 @@
+//
+//  spirv_cross_c_library.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <ctype.h>
+#include <list>
+#include <new>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+static const spvc_resource_type block_resource_types[] = {
+	SPVC_RESOURCE_TYPE_UNIFORM_BUFFER,
+	SPVC_RESOURCE_TYPE_STORAGE_BUFFER,
+	SPVC_RESOURCE_TYPE_PUSH_CONSTANT,
+	SPVC_RESOURCE_TYPE_SHADER_RECORD_BUFFER,
+};
+
+static bool starts_with(const string &s, const char *prefix)
+{
+	return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Lines which must precede every declaration, and are merged line by line.
+static bool is_preamble_line(const string &line)
+{
+	return starts_with(line, "#pragma ") || starts_with(line, "#include ") || starts_with(line, "using namespace ");
+}
+
+// Renames a struct type and the struct types of its members.
+static void rename_struct(spvc_compiler compiler, spvc_type_id id, const string &prefix,
+                          unordered_set<spvc_type_id> &renamed)
+{
+	spvc_type type = spvc_compiler_get_type_handle(compiler, id);
+	if (!type)
+		return;
+
+	spvc_type_id base_id = spvc_type_get_base_type_id(type);
+	spvc_type base = spvc_compiler_get_type_handle(compiler, base_id);
+	unsigned member_count = base ? spvc_type_get_num_member_types(base) : 0;
+	if (member_count == 0 || !renamed.insert(base_id).second)
+		return;
+
+	string name = spvc_compiler_get_name(compiler, base_id);
+	if (name.empty())
+		name = "T" + to_string(base_id);
+	spvc_compiler_set_name(compiler, base_id, (prefix + "_" + name).c_str());
+
+	for (unsigned i = 0; i < member_count; i++)
+		rename_struct(compiler, spvc_type_get_member_type(base, i), prefix, renamed);
+}
+
+// Returns the first line of a block which is not a comment.
+static size_t first_code_line(const string &block)
+{
+	size_t begin = 0;
+	while (begin != string::npos && starts_with(block.substr(begin, 2), "//"))
+	{
+		size_t eol = block.find('\n', begin);
+		begin = eol == string::npos ? eol : eol + 1;
+	}
+	return begin;
+}
+
+// Returns the signature line of a function definition, or an empty string.
+static string function_signature(const string &block)
+{
+	size_t begin = first_code_line(block);
+	size_t body = block.find('{');
+	while (begin < body)
+	{
+		size_t eol = block.find('\n', begin);
+		string line = block.substr(begin, eol - begin);
+		begin = eol == string::npos ? eol : eol + 1;
+		if (starts_with(line, "static inline ") || starts_with(line, "template"))
+			continue;
+		if (starts_with(line, "struct ") || starts_with(line, "constant ") || starts_with(line, "#"))
+			return string();
+		// Prototypes end with a semicolon, and are renamed with their definitions.
+		return line.find('(') == string::npos || line.back() == ';' ? string() : line;
+	}
+	return string();
+}
+
+static bool is_identifier_char(char c)
+{
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+// Returns the name of the function a signature declares.
+static string function_name(const string &signature)
+{
+	size_t end = signature.find('(');
+	while (end > 0 && signature[end - 1] == ' ')
+		end--;
+	size_t begin = end;
+	while (begin > 0 && is_identifier_char(signature[begin - 1]))
+		begin--;
+	return signature.substr(begin, end - begin);
+}
+
+// Entry points are renamed through the compiler, and the spv* helpers are shared by every shader.
+static bool is_local_function(const string &signature)
+{
+	if (starts_with(signature, "kernel ") || starts_with(signature, "vertex ") ||
+	    starts_with(signature, "fragment ") || starts_with(signature, "[["))
+		return false;
+	string name = function_name(signature);
+	return !name.empty() && !starts_with(name, "spv");
+}
+
+// Replaces whole identifiers, except member names following . or ->.
+static string rename_identifiers(const string &block, const unordered_map<string, string> &names)
+{
+	string result;
+	result.reserve(block.size());
+	for (size_t i = 0; i < block.size();)
+	{
+		if (!is_identifier_char(block[i]) || (i > 0 && is_identifier_char(block[i - 1])))
+		{
+			result += block[i++];
+			continue;
+		}
+
+		size_t end = i;
+		while (end < block.size() && is_identifier_char(block[end]))
+			end++;
+		string identifier = block.substr(i, end - i);
+		bool member = i > 0 && (block[i - 1] == '.' || (i > 1 && block[i - 1] == '>' && block[i - 2] == '-'));
+		auto itr = member ? names.end() : names.find(identifier);
+		result += itr != names.end() ? itr->second : identifier;
+		i = end;
+	}
+	return result;
+}
+
+// Returns the name of a struct a line defines, or an empty string.
+static string struct_name(const string &line)
+{
+	if (!starts_with(line, "struct ") || line.find(';') != string::npos)
+		return string();
+	size_t end = 7;
+	while (end < line.size() && is_identifier_char(line[end]))
+		end++;
+	return line.substr(7, end - 7);
+}
+
+// Returns the name of a top-level constant a line declares, or an empty string.
+static string constant_name(const string &line)
+{
+	if (!starts_with(line, "constant "))
+		return string();
+	size_t end = line.find_first_of("[=;");
+	if (end == string::npos)
+		return string();
+	while (end > 0 && line[end - 1] == ' ')
+		end--;
+	size_t begin = end;
+	while (begin > 0 && is_identifier_char(line[begin - 1]))
+		begin--;
+	return line.substr(begin, end - begin);
+}
+
+// Returns the names a block declares, for detecting conflicts, with the text declaring each.
+static vector<pair<string, string>> declaration_keys(const string &block)
+{
+	vector<pair<string, string>> keys;
+	size_t begin = first_code_line(block);
+	if (begin == string::npos)
+		return keys;
+
+	string line = block.substr(begin, block.find('\n', begin) - begin);
+	if (starts_with(line, "struct ") && line.find(';') == string::npos)
+		keys.emplace_back(line, block);
+	else if (starts_with(line, "constant "))
+	{
+		// Consecutive constants share a block.
+		while (begin < block.size())
+		{
+			size_t eol = block.find('\n', begin);
+			line = block.substr(begin, eol - begin);
+			string name = constant_name(line);
+			if (!name.empty())
+				keys.emplace_back("constant " + name, line);
+			begin = eol == string::npos ? eol : eol + 1;
+		}
+	}
+	else
+	{
+		string signature = function_signature(block);
+		if (!signature.empty())
+			keys.emplace_back(signature, block);
+	}
+	return keys;
+}
+} // namespace
+
+struct spvc_msl_library_builder_s
+{
+	vector<string> preamble;
+	unordered_set<string> preamble_lines;
+
+	vector<string> declarations;
+	unordered_set<string> seen_declarations;
+	// The text declaring each key, and the prefix of the shader which added it.
+	unordered_map<string, pair<string, string>> keys;
+	string conflict;
+
+	// Entry point names returned to the caller, which must have stable addresses.
+	list<string> entry_point_names;
+	string source;
+
+	void add_block(const string &block, const string &prefix)
+	{
+		if (!seen_declarations.insert(block).second)
+			return;
+
+		for (auto &key : declaration_keys(block))
+		{
+			auto itr = keys.find(key.first);
+			if (itr != keys.end() && itr->second.first != key.second && conflict.empty())
+				conflict = key.first + " differs between " + itr->second.second + " and " + prefix;
+			keys[key.first] = { key.second, prefix };
+		}
+		declarations.push_back(block);
+	}
+
+	// Splits the source at blank lines outside of braces, and prefixes the structs, functions and
+	// constants the shader declares, which would otherwise clash with other shaders.
+	void add_source(const char *msl, const string &prefix)
+	{
+		vector<string> blocks;
+		string block;
+		bool preamble_only = true;
+		int depth = 0;
+
+		auto flush = [&]() {
+			if (block.empty())
+				return;
+			if (preamble_only)
+			{
+				size_t begin = 0;
+				while (begin < block.size())
+				{
+					size_t end = block.find('\n', begin);
+					string line = block.substr(begin, end - begin);
+					if (preamble_lines.insert(line).second)
+						preamble.push_back(line);
+					begin = end + 1;
+				}
+			}
+			else
+				blocks.push_back(block);
+			block.clear();
+			preamble_only = true;
+		};
+
+		for (const char *p = msl; *p;)
+		{
+			const char *eol = strchr(p, '\n');
+			string line(p, eol ? eol : p + strlen(p));
+			p = eol ? eol + 1 : p + line.size();
+
+			if (line.empty() && depth == 0)
+			{
+				flush();
+				continue;
+			}
+
+			for (char c : line)
+			{
+				if (c == '{')
+					depth++;
+				else if (c == '}')
+					depth--;
+			}
+			preamble_only = preamble_only && is_preamble_line(line);
+			block += line;
+			block += '\n';
+		}
+		flush();
+
+		// Names already carrying the prefix are the block types and entry points the compiler renamed,
+		// and the spv* helpers are shared by every shader.
+		auto is_local = [&](const string &name) {
+			return !name.empty() && !starts_with(name, "spv") && !starts_with(name, (prefix + "_").c_str());
+		};
+
+		unordered_map<string, string> type_names;
+		unordered_map<string, string> names;
+		for (auto &b : blocks)
+		{
+			size_t begin = first_code_line(b);
+			if (begin == string::npos)
+				continue;
+
+			string name = struct_name(b.substr(begin, b.find('\n', begin) - begin));
+			if (is_local(name))
+				type_names[name] = prefix + "_" + name;
+
+			string signature = function_signature(b);
+			if (!signature.empty() && is_local_function(signature))
+			{
+				name = function_name(signature);
+				names[name] = prefix + "_" + name;
+			}
+
+			// Consecutive constants share a block. Function constants are looked up by name from the
+			// API, so they keep theirs.
+			while (begin < b.size())
+			{
+				size_t eol = b.find('\n', begin);
+				string line = b.substr(begin, eol - begin);
+				name = line.find("[[function_constant(") == string::npos ? constant_name(line) : string();
+				if (is_local(name))
+					names[name] = prefix + "_" + name;
+				begin = eol == string::npos ? eol : eol + 1;
+			}
+		}
+		names.insert(type_names.begin(), type_names.end());
+
+		// Struct members may share a name with a function or constant, so structs only rename types.
+		for (auto &b : blocks)
+		{
+			size_t begin = first_code_line(b);
+			bool is_struct = begin != string::npos && starts_with(b.substr(begin), "struct ");
+			add_block(rename_identifiers(b, is_struct ? type_names : names), prefix);
+		}
+	}
+};
+
+spvc_result spvc_msl_library_builder_create(spvc_msl_library_builder *builder)
+{
+	if (!builder)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	*builder = new (nothrow) spvc_msl_library_builder_s;
+	return *builder ? SPVC_SUCCESS : SPVC_ERROR_OUT_OF_MEMORY;
+}
+
+void spvc_msl_library_builder_destroy(spvc_msl_library_builder builder)
+{
+	delete builder;
+}
+
+spvc_result spvc_msl_library_builder_add_compiler(spvc_msl_library_builder builder, spvc_compiler compiler,
+                                                  const char *prefix, const char **entry_point_name)
+{
+	if (!builder || !compiler || !prefix || !*prefix)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	const spvc_entry_point *entry_points = nullptr;
+	size_t entry_point_count = 0;
+	spvc_result result = spvc_compiler_get_entry_points(compiler, &entry_points, &entry_point_count);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	struct EntryPoint
+	{
+		string name;
+		string renamed;
+		SpvExecutionModel model;
+	};
+
+	// Copy the entry points, as renaming them may invalidate the list.
+	vector<EntryPoint> entries;
+	for (size_t i = 0; i < entry_point_count; i++)
+	{
+		string name = entry_points[i].name;
+		entries.push_back({ name, string(prefix) + "_" + name, entry_points[i].execution_model });
+	}
+
+	for (auto &entry : entries)
+	{
+		result = spvc_compiler_rename_entry_point(compiler, entry.name.c_str(), entry.renamed.c_str(), entry.model);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	spvc_resources resources = nullptr;
+	result = spvc_compiler_create_shader_resources(compiler, &resources);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	unordered_set<spvc_type_id> renamed_types;
+	for (spvc_resource_type type : block_resource_types)
+	{
+		const spvc_reflected_resource *list = nullptr;
+		size_t count = 0;
+		result = spvc_resources_get_resource_list_for_type(resources, type, &list, &count);
+		if (result != SPVC_SUCCESS)
+			return result;
+		for (size_t i = 0; i < count; i++)
+			rename_struct(compiler, list[i].base_type_id, prefix, renamed_types);
+	}
+
+	const char *msl = nullptr;
+	result = spvc_compiler_compile_traced(compiler, &msl);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	builder->add_source(msl, prefix);
+
+	if (entry_point_name)
+	{
+		*entry_point_name = nullptr;
+		SpvExecutionModel model = spvc_compiler_get_execution_model(compiler);
+		for (auto &entry : entries)
+		{
+			if (entry.model != model)
+				continue;
+			const char *name = spvc_compiler_get_cleansed_entry_point_name(compiler, entry.renamed.c_str(), model);
+			builder->entry_point_names.emplace_back(name ? name : entry.renamed);
+			*entry_point_name = builder->entry_point_names.back().c_str();
+			break;
+		}
+	}
+
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_library_builder_build(spvc_msl_library_builder builder, const char **source)
+{
+	if (!builder || !source)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	if (!builder->conflict.empty())
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto &s = builder->source;
+	s.clear();
+	for (auto &line : builder->preamble)
+	{
+		s += line;
+		s += '\n';
+	}
+	for (auto &declaration : builder->declarations)
+	{
+		s += '\n';
+		s += declaration;
+	}
+
+	*source = s.c_str();
+	return SPVC_SUCCESS;
+}
+
+const char *spvc_msl_library_builder_get_conflict(spvc_msl_library_builder builder)
+{
+	return builder && !builder->conflict.empty() ? builder->conflict.c_str() : nullptr;
+}
@@ -0,0 +1,514 @@
+//
+//  spirv_cross_c_minify.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+enum TokenKind
+{
+	TOKEN_IDENTIFIER,
+	TOKEN_NUMBER,
+	TOKEN_LITERAL,
+	TOKEN_PUNCTUATION,
+	TOKEN_DIRECTIVE,
+};
+
+struct Token
+{
+	TokenKind kind;
+	string text;
+};
+
+// Punctuation which must not be merged with an adjacent character, longest first.
+static const char *const operators[] = {
+	"<<=", ">>=", "...", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+	"+=",  "-=",  "*=",  "/=", "%=", "&=", "|=", "^=", "::", "[[", "]]",
+};
+
+// Pairs which would lex differently, or start a comment, if written without a space.
+static const char *const joined_pairs[] = {
+	"++", "--", "+=", "-=", "->", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "*=",
+	"/=", "%=", "&=", "|=", "^=", "::", "//", "/*", "..", "[[", "]]", "<:", "<%", "%:",
+};
+
+// Function qualifiers which mark an entry point.
+static const char *const entry_point_qualifiers[] = { "vertex", "fragment", "kernel", "[[" };
+
+static bool is_identifier_char(char c)
+{
+	return isalnum((unsigned char)c) || c == '_';
+}
+
+// True for the _<id> names SPIRV-Cross gives to temporaries and unnamed objects.
+static bool is_temporary_name(const string &name)
+{
+	if (name.size() < 2 || name[0] != '_')
+		return false;
+	for (size_t i = 1; i < name.size(); i++)
+		if (!isdigit((unsigned char)name[i]))
+			return false;
+	return true;
+}
+
+// Writes the line with comments removed and whitespace collapsed.
+static string minify_directive(const string &line)
+{
+	string result;
+	char quote = 0;
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		char c = line[i];
+		if (quote)
+		{
+			result += c;
+			if (c == '\\' && i + 1 < line.size())
+				result += line[++i];
+			else if (c == quote)
+				quote = 0;
+			continue;
+		}
+
+		if (c == '"' || c == '\'')
+			quote = c;
+		else if (c == '/' && i + 1 < line.size() && line[i + 1] == '/')
+			break;
+		else if (c == '/' && i + 1 < line.size() && line[i + 1] == '*')
+		{
+			size_t end = line.find("*/", i + 2);
+			i = end == string::npos ? line.size() : end + 1;
+			c = ' ';
+		}
+		else if (isspace((unsigned char)c))
+			c = ' ';
+
+		if (c == ' ' && (result.empty() || result.back() == ' '))
+			continue;
+		result += c;
+	}
+	while (!result.empty() && result.back() == ' ')
+		result.pop_back();
+	return result;
+}
+
+static vector<Token> tokenize(const char *source)
+{
+	vector<Token> tokens;
+	bool line_start = true;
+	const char *p = source;
+
+	while (*p)
+	{
+		char c = *p;
+		if (c == '\n')
+		{
+			line_start = true;
+			p++;
+		}
+		else if (isspace((unsigned char)c))
+			p++;
+		else if (c == '/' && p[1] == '/')
+		{
+			while (*p && *p != '\n')
+				p++;
+		}
+		else if (c == '/' && p[1] == '*')
+		{
+			const char *end = strstr(p + 2, "*/");
+			p = end ? end + 2 : p + strlen(p);
+		}
+		else if (c == '#' && line_start)
+		{
+			// Directives run to the end of the line, including escaped newlines.
+			string line;
+			while (*p && *p != '\n')
+			{
+				if (*p == '\\' && p[1] == '\n')
+				{
+					line += ' ';
+					p += 2;
+					continue;
+				}
+				line += *p++;
+			}
+			tokens.push_back({ TOKEN_DIRECTIVE, minify_directive(line) });
+		}
+		else if (c == '"' || c == '\'')
+		{
+			const char *begin = p++;
+			while (*p && *p != c && *p != '\n')
+				p += (*p == '\\' && p[1]) ? 2 : 1;
+			if (*p == c)
+				p++;
+			tokens.push_back({ TOKEN_LITERAL, string(begin, p) });
+			line_start = false;
+		}
+		else if (isdigit((unsigned char)c) || (c == '.' && isdigit((unsigned char)p[1])))
+		{
+			// Preprocessing numbers absorb signs after an exponent, such as 1e-5 or 0x1p+3.
+			const char *begin = p;
+			bool hex = c == '0' && (p[1] == 'x' || p[1] == 'X');
+			const char *exponent = hex ? "pP" : "eE";
+			while (is_identifier_char(*p) || *p == '.' || ((*p == '+' || *p == '-') && strchr(exponent, p[-1])))
+				p++;
+			tokens.push_back({ TOKEN_NUMBER, string(begin, p) });
+			line_start = false;
+		}
+		else if (is_identifier_char(c))
+		{
+			const char *begin = p;
+			while (is_identifier_char(*p))
+				p++;
+			tokens.push_back({ TOKEN_IDENTIFIER, string(begin, p) });
+			line_start = false;
+		}
+		else
+		{
+			size_t len = 1;
+			for (const char *op : operators)
+			{
+				size_t n = strlen(op);
+				if (strncmp(p, op, n) == 0)
+				{
+					len = n;
+					break;
+				}
+			}
+			tokens.push_back({ TOKEN_PUNCTUATION, string(p, len) });
+			p += len;
+			line_start = false;
+		}
+	}
+	return tokens;
+}
+
+static bool is_punctuation(const Token &token, const char *text)
+{
+	return token.kind == TOKEN_PUNCTUATION && token.text == text;
+}
+
+// A top-level declaration, as a range of tokens.
+struct Declaration
+{
+	size_t begin;
+	size_t end;
+	// The function a definition introduces, or empty.
+	string function;
+};
+
+static vector<Declaration> split_declarations(const vector<Token> &tokens)
+{
+	vector<Declaration> declarations;
+	size_t begin = 0;
+	int depth = 0;
+
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		auto &token = tokens[i];
+		bool end = false;
+		if (token.kind == TOKEN_DIRECTIVE)
+			end = depth == 0;
+		else if (token.kind == TOKEN_PUNCTUATION)
+		{
+			// [[ and ]] are single tokens, but close nested subscripts such as a[b[i]] too, so they count twice.
+			char c = token.text[0];
+			if (c == '{' || c == '(' || c == '[')
+				depth += int(token.text.size());
+			else if (c == '}' || c == ')' || c == ']')
+				depth -= int(token.text.size());
+
+			if (depth == 0 && c == ';')
+				end = true;
+			else if (depth == 0 && c == '}')
+				end = i + 1 >= tokens.size() || !is_punctuation(tokens[i + 1], ";");
+		}
+
+		if (!end)
+			continue;
+
+		Declaration decl = { begin, i + 1, string() };
+		if (token.kind != TOKEN_DIRECTIVE && is_punctuation(token, "}"))
+		{
+			// A function definition has a parameter list before its body, after any __attribute__((...)).
+			int parens = 0;
+			for (size_t j = begin; j < i; j++)
+			{
+				if (is_punctuation(tokens[j], "{"))
+					break;
+				if (is_punctuation(tokens[j], ")"))
+					parens--;
+				if (!is_punctuation(tokens[j], "(") || parens++ > 0)
+					continue;
+				if (j > begin && tokens[j - 1].text == "__attribute__")
+					continue;
+				if (j > begin && tokens[j - 1].kind == TOKEN_IDENTIFIER && tokens[j - 1].text != "operator")
+					decl.function = tokens[j - 1].text;
+				break;
+			}
+			for (size_t j = begin; j < i && !decl.function.empty(); j++)
+			{
+				if (is_punctuation(tokens[j], "("))
+					break;
+				for (const char *qualifier : entry_point_qualifiers)
+					if (tokens[j].text == qualifier)
+						decl.function.clear();
+			}
+		}
+		declarations.push_back(decl);
+		begin = i + 1;
+	}
+
+	if (begin < tokens.size())
+		declarations.push_back({ begin, tokens.size(), string() });
+	return declarations;
+}
+
+// Removes function definitions whose name is not referenced outside of its own overloads.
+static size_t remove_unused_helpers(vector<Token> &tokens)
+{
+	size_t removed = 0;
+	for (;;)
+	{
+		auto declarations = split_declarations(tokens);
+
+		unordered_map<string, size_t> references;
+		for (auto &decl : declarations)
+			for (size_t i = decl.begin; i < decl.end; i++)
+				if (tokens[i].kind == TOKEN_IDENTIFIER && tokens[i].text != decl.function)
+					references[tokens[i].text]++;
+
+		vector<bool> keep(tokens.size(), true);
+		bool changed = false;
+		for (auto &decl : declarations)
+		{
+			if (decl.function.empty() || references.count(decl.function))
+				continue;
+			fill(keep.begin() + decl.begin, keep.begin() + decl.end, false);
+			changed = true;
+			removed++;
+		}
+		if (!changed)
+			return removed;
+
+		vector<Token> kept;
+		for (size_t i = 0; i < tokens.size(); i++)
+			if (keep[i])
+				kept.push_back(move(tokens[i]));
+		tokens.swap(kept);
+	}
+}
+
+// Replaces ((expr)) with (expr). A top-level comma is kept, since it may be a comma operator inside a call.
+static void remove_redundant_parentheses(vector<Token> &tokens)
+{
+	vector<size_t> match(tokens.size(), 0);
+	vector<size_t> stack;
+	for (size_t i = 0; i < tokens.size(); i++)
+	{
+		if (is_punctuation(tokens[i], "("))
+			stack.push_back(i);
+		else if (is_punctuation(tokens[i], ")") && !stack.empty())
+		{
+			match[stack.back()] = i;
+			stack.pop_back();
+		}
+	}
+
+	vector<bool> keep(tokens.size(), true);
+	for (size_t i = 0; i + 1 < tokens.size(); i++)
+	{
+		if (!is_punctuation(tokens[i], "(") || !is_punctuation(tokens[i + 1], "("))
+			continue;
+		// __attribute__((...)) requires both.
+		if (i > 0 && tokens[i - 1].text == "__attribute__")
+			continue;
+		size_t inner_end = match[i + 1];
+		if (inner_end == 0 || inner_end + 1 != match[i])
+			continue;
+
+		int depth = 0;
+		bool comma = false;
+		for (size_t j = i + 2; j < inner_end && !comma; j++)
+		{
+			char c = tokens[j].kind == TOKEN_PUNCTUATION ? tokens[j].text[0] : 0;
+			if (c == '(' || c == '[' || c == '{')
+				depth += int(tokens[j].text.size());
+			else if (c == ')' || c == ']' || c == '}')
+				depth -= int(tokens[j].text.size());
+			else if (c == ',' && depth == 0)
+				comma = true;
+		}
+		if (comma)
+			continue;
+
+		keep[i + 1] = false;
+		keep[inner_end] = false;
+	}
+
+	vector<Token> kept;
+	for (size_t i = 0; i < tokens.size(); i++)
+		if (keep[i])
+			kept.push_back(move(tokens[i]));
+	tokens.swap(kept);
+}
+
+static string short_name(size_t index)
+{
+	static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	const size_t count = sizeof(letters) - 1;
+	string name;
+	do
+	{
+		name.insert(name.begin(), letters[index % count]);
+		index /= count;
+	} while (index-- > 0);
+	return "_" + name;
+}
+
+// Renames _<id> identifiers, giving the shortest names to the most frequent.
+static size_t rename_temporaries(vector<Token> &tokens)
+{
+	unordered_set<string> identifiers;
+	unordered_set<string> excluded;
+	unordered_map<string, size_t> counts;
+	for (auto &token : tokens)
+	{
+		if (token.kind == TOKEN_IDENTIFIER)
+		{
+			identifiers.insert(token.text);
+			if (is_temporary_name(token.text))
+				counts[token.text]++;
+		}
+		else if (token.kind == TOKEN_DIRECTIVE)
+		{
+			// Names used by the preprocessor are left alone.
+			const char *p = token.text.c_str();
+			while (*p)
+			{
+				const char *begin = p;
+				while (is_identifier_char(*p))
+					p++;
+				if (p != begin)
+					excluded.insert(string(begin, p));
+				else
+					p++;
+			}
+		}
+	}
+
+	vector<pair<string, size_t>> names;
+	for (auto &count : counts)
+		if (!excluded.count(count.first))
+			names.push_back(count);
+	sort(names.begin(), names.end(), [](const pair<string, size_t> &a, const pair<string, size_t> &b) {
+		return a.second != b.second ? a.second > b.second : a.first < b.first;
+	});
+
+	unordered_map<string, string> renames;
+	size_t next = 0;
+	for (auto &name : names)
+	{
+		string renamed;
+		do
+			renamed = short_name(next++);
+		while (identifiers.count(renamed) || excluded.count(renamed));
+		if (renamed.size() < name.first.size())
+			renames[name.first] = renamed;
+	}
+
+	for (auto &token : tokens)
+	{
+		if (token.kind != TOKEN_IDENTIFIER)
+			continue;
+		auto itr = renames.find(token.text);
+		if (itr != renames.end())
+			token.text = itr->second;
+	}
+	return renames.size();
+}
+
+static bool needs_space(const Token &prev, const Token &next)
+{
+	char a = prev.text.back();
+	char b = next.text[0];
+	if (is_identifier_char(a) && is_identifier_char(b))
+		return true;
+	// A number would absorb a following '.', or a sign after a trailing e or p.
+	if (prev.kind == TOKEN_NUMBER && (b == '.' || ((b == '+' || b == '-') && strchr("eEpP", a))))
+		return true;
+	if (next.kind == TOKEN_NUMBER && a == '.')
+		return true;
+	if (prev.kind != TOKEN_PUNCTUATION || next.kind != TOKEN_PUNCTUATION)
+		return false;
+	char pair[3] = { a, b, 0 };
+	for (const char *joined : joined_pairs)
+		if (strcmp(pair, joined) == 0)
+			return true;
+	return false;
+}
+
+static string emit(const vector<Token> &tokens)
+{
+	string result;
+	const Token *prev = nullptr;
+	for (auto &token : tokens)
+	{
+		if (token.kind == TOKEN_DIRECTIVE)
+		{
+			if (!result.empty() && result.back() != '\n')
+				result += '\n';
+			result += token.text;
+			result += '\n';
+			prev = nullptr;
+			continue;
+		}
+		if (prev && needs_space(*prev, token))
+			result += ' ';
+		result += token.text;
+		prev = &token;
+	}
+	if (!result.empty() && result.back() != '\n')
+		result += '\n';
+	return result;
+}
+} // namespace
+
+spvc_result spvc_msl_minify(const char *source, spvc_msl_minify_flags flags, spvc_write_callback callback,
+                            void *userdata, spvc_msl_minify_stats *stats)
+{
+	if (!source || !callback)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	vector<Token> tokens = tokenize(source);
+
+	size_t removed_helpers = 0;
+	size_t renamed_identifiers = 0;
+	if (flags & SPVC_MSL_MINIFY_UNUSED_HELPERS_BIT)
+		removed_helpers = remove_unused_helpers(tokens);
+	if (flags & SPVC_MSL_MINIFY_PARENTHESES_BIT)
+		remove_redundant_parentheses(tokens);
+	if (flags & SPVC_MSL_MINIFY_RENAME_TEMPORARIES_BIT)
+		renamed_identifiers = rename_temporaries(tokens);
+
+	string minified = emit(tokens);
+	if (stats)
+	{
+		stats->input_size = strlen(source);
+		stats->output_size = minified.size();
+		stats->removed_helpers = removed_helpers;
+		stats->renamed_identifiers = renamed_identifiers;
+	}
+	return callback(userdata, minified.data(), minified.size());
+}
@@ -0,0 +1,712 @@
+//
+//  spirv_cross_c_msl_cache.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+static const uint32_t cache_magic = 0x434d5053u; // 'SPMC'
+static const uint32_t cache_version = 3u;
+
+enum EntryFlags : uint32_t
+{
+	FLAG_RASTERIZATION_DISABLED = 1 << 0,
+	FLAG_NEEDS_SWIZZLE_BUFFER = 1 << 1,
+	FLAG_NEEDS_BUFFER_SIZE_BUFFER = 1 << 2,
+	FLAG_NEEDS_OUTPUT_BUFFER = 1 << 3,
+	FLAG_NEEDS_PATCH_OUTPUT_BUFFER = 1 << 4,
+	FLAG_NEEDS_INPUT_THREADGROUP_MEM = 1 << 5,
+};
+
+// Tags which separate the records of the canonical key.
+enum KeyTag : uint32_t
+{
+	TAG_OPTION = 1,
+	TAG_RESOURCE_BINDING,
+	TAG_VERTEX_ATTRIBUTE,
+	TAG_CONSTEXPR_SAMPLER,
+	TAG_CONSTEXPR_SAMPLER_BY_BINDING,
+	TAG_ENTRY_POINT,
+	TAG_SHADER_INPUT,
+	TAG_SHADER_OUTPUT,
+	TAG_DISCRETE_DESCRIPTOR_SET,
+	TAG_ARGUMENT_BUFFER_DEVICE_ADDRESS_SPACE,
+	TAG_DYNAMIC_BUFFER,
+	TAG_INLINE_UNIFORM_BLOCK,
+};
+
+// SHA-256 of the module, so the key identifies it without holding a copy of it.
+class SHA256
+{
+public:
+	void update(const void *data, size_t size)
+	{
+		auto *bytes = static_cast<const uint8_t *>(data);
+		length += size;
+		while (size)
+		{
+			size_t n = min(size, sizeof(block) - used);
+			memcpy(block + used, bytes, n);
+			used += n;
+			bytes += n;
+			size -= n;
+			if (used == sizeof(block))
+			{
+				compress();
+				used = 0;
+			}
+		}
+	}
+
+	void finish(uint8_t digest[32])
+	{
+		uint64_t bits = length * 8;
+		uint8_t pad = 0x80;
+		update(&pad, 1);
+		pad = 0;
+		while (used != 56)
+			update(&pad, 1);
+		uint8_t size[8];
+		for (int i = 0; i < 8; i++)
+			size[i] = uint8_t(bits >> (56 - 8 * i));
+		update(size, sizeof(size));
+		for (int i = 0; i < 32; i++)
+			digest[i] = uint8_t(state[i / 4] >> (24 - 8 * (i % 4)));
+	}
+
+private:
+	uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		                  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+	uint8_t block[64];
+	size_t used = 0;
+	uint64_t length = 0;
+
+	static uint32_t rotate(uint32_t v, int n)
+	{
+		return (v >> n) | (v << (32 - n));
+	}
+
+	void compress()
+	{
+		static const uint32_t k[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+		};
+
+		uint32_t w[64];
+		for (int i = 0; i < 16; i++)
+			w[i] = uint32_t(block[i * 4]) << 24 | uint32_t(block[i * 4 + 1]) << 16 | uint32_t(block[i * 4 + 2]) << 8 |
+			       uint32_t(block[i * 4 + 3]);
+		for (int i = 16; i < 64; i++)
+		{
+			uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+		for (int i = 0; i < 64; i++)
+		{
+			uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+			uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+};
+
+static void append(string &s, uint32_t v)
+{
+	s.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+static void append(string &s, float v)
+{
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	append(s, bits);
+}
+
+static void append_sampler(string &s, const spvc_msl_constexpr_sampler &sampler)
+{
+	append(s, uint32_t(sampler.coord));
+	append(s, uint32_t(sampler.min_filter));
+	append(s, uint32_t(sampler.mag_filter));
+	append(s, uint32_t(sampler.mip_filter));
+	append(s, uint32_t(sampler.s_address));
+	append(s, uint32_t(sampler.t_address));
+	append(s, uint32_t(sampler.r_address));
+	append(s, uint32_t(sampler.compare_func));
+	append(s, uint32_t(sampler.border_color));
+	append(s, sampler.lod_clamp_min);
+	append(s, sampler.lod_clamp_max);
+	append(s, uint32_t(sampler.max_anisotropy));
+	append(s, uint32_t(sampler.compare_enable));
+	append(s, uint32_t(sampler.lod_clamp_enable));
+	append(s, uint32_t(sampler.anisotropy_enable));
+}
+
+static void append_interface_var(string &s, KeyTag tag, const spvc_msl_shader_interface_var_2 &var)
+{
+	append(s, uint32_t(tag));
+	append(s, uint32_t(var.location));
+	append(s, uint32_t(var.format));
+	append(s, uint32_t(var.builtin));
+	append(s, uint32_t(var.vecsize));
+	append(s, uint32_t(var.rate));
+}
+
+struct ConstexprSampler
+{
+	spvc_variable_id id;
+	unsigned desc_set;
+	unsigned binding;
+	bool by_binding;
+	spvc_msl_constexpr_sampler sampler;
+};
+
+struct Entry
+{
+	string source;
+	uint32_t flags;
+};
+
+class Reader
+{
+public:
+	Reader(const void *data, size_t size)
+	    : p(static_cast<const char *>(data))
+	    , end(p + size)
+	{
+	}
+
+	bool read(uint32_t &v)
+	{
+		if (size_t(end - p) < sizeof(v))
+			return false;
+		memcpy(&v, p, sizeof(v));
+		p += sizeof(v);
+		return true;
+	}
+
+	bool read(string &s)
+	{
+		uint32_t size;
+		if (!read(size) || size_t(end - p) < size)
+			return false;
+		s.assign(p, size);
+		p += size;
+		return true;
+	}
+
+private:
+	const char *p;
+	const char *end;
+};
+} // namespace
+
+struct spvc_msl_cache_key_s
+{
+	uint8_t digest[32];
+	uint32_t word_count;
+	string entry_point;
+	SpvExecutionModel execution_model = SpvExecutionModelMax;
+	map<spvc_compiler_option, unsigned> options;
+	vector<spvc_msl_resource_binding> resource_bindings;
+	vector<spvc_msl_vertex_attribute> vertex_attributes;
+	vector<ConstexprSampler> constexpr_samplers;
+	vector<spvc_msl_shader_interface_var_2> shader_inputs;
+	vector<spvc_msl_shader_interface_var_2> shader_outputs;
+	vector<unsigned> discrete_descriptor_sets;
+	vector<pair<unsigned, spvc_bool>> argument_buffer_device_address_spaces;
+	vector<spvc_msl_resource_binding> dynamic_buffers;
+	vector<pair<unsigned, unsigned>> inline_uniform_blocks;
+
+	// Records of the key in insertion order, excluding the entry point and options, which are canonicalized in build().
+	string records;
+
+	string build() const
+	{
+		string s;
+		s.append(reinterpret_cast<const char *>(digest), sizeof(digest));
+		append(s, word_count);
+		if (!entry_point.empty())
+		{
+			append(s, uint32_t(TAG_ENTRY_POINT));
+			append(s, uint32_t(execution_model));
+			append(s, uint32_t(entry_point.size()));
+			s += entry_point;
+		}
+		for (auto &option : options)
+		{
+			append(s, uint32_t(TAG_OPTION));
+			append(s, uint32_t(option.first));
+			append(s, uint32_t(option.second));
+		}
+		s += records;
+		return s;
+	}
+};
+
+struct spvc_msl_cache_s
+{
+	mutex lock;
+	unordered_map<string, Entry> entries;
+
+	static void fill(const Entry &e, spvc_msl_cache_entry *entry)
+	{
+		entry->source = e.source.c_str();
+		entry->source_size = e.source.size();
+		entry->is_rasterization_disabled = (e.flags & FLAG_RASTERIZATION_DISABLED) != 0;
+		entry->needs_swizzle_buffer = (e.flags & FLAG_NEEDS_SWIZZLE_BUFFER) != 0;
+		entry->needs_buffer_size_buffer = (e.flags & FLAG_NEEDS_BUFFER_SIZE_BUFFER) != 0;
+		entry->needs_output_buffer = (e.flags & FLAG_NEEDS_OUTPUT_BUFFER) != 0;
+		entry->needs_patch_output_buffer = (e.flags & FLAG_NEEDS_PATCH_OUTPUT_BUFFER) != 0;
+		entry->needs_input_threadgroup_mem = (e.flags & FLAG_NEEDS_INPUT_THREADGROUP_MEM) != 0;
+	}
+};
+
+#pragma mark - Cache
+
+spvc_result spvc_msl_cache_create(spvc_msl_cache *cache)
+{
+	if (!cache)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	*cache = new (nothrow) spvc_msl_cache_s;
+	return *cache ? SPVC_SUCCESS : SPVC_ERROR_OUT_OF_MEMORY;
+}
+
+void spvc_msl_cache_destroy(spvc_msl_cache cache)
+{
+	delete cache;
+}
+
+spvc_result spvc_msl_cache_load(spvc_msl_cache cache, const void *data, size_t size)
+{
+	if (!cache || (!data && size))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	Reader reader(data, size);
+	uint32_t magic, version, count;
+	if (!reader.read(magic) || !reader.read(version) || magic != cache_magic || version != cache_version)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	unsigned major, minor, patch;
+	spvc_get_version(&major, &minor, &patch);
+	uint32_t file_major, file_minor, file_patch;
+	if (!reader.read(file_major) || !reader.read(file_minor) || !reader.read(file_patch) || file_major != major ||
+	    file_minor != minor || file_patch != patch)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	if (!reader.read(count))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	// Parse everything before inserting, so a truncated file leaves the cache unchanged.
+	vector<pair<string, Entry>> loaded;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		pair<string, Entry> e;
+		if (!reader.read(e.first) || !reader.read(e.second.flags) || !reader.read(e.second.source))
+			return SPVC_ERROR_INVALID_ARGUMENT;
+		loaded.push_back(move(e));
+	}
+
+	lock_guard<mutex> holder(cache->lock);
+	for (auto &e : loaded)
+		cache->entries.insert(move(e));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_serialize(spvc_msl_cache cache, void *buffer, size_t *size)
+{
+	if (!cache || !size)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	lock_guard<mutex> holder(cache->lock);
+
+	string s;
+	append(s, cache_magic);
+	append(s, cache_version);
+	// A cache written by another SPIRV-Cross version may hold other MSL, so load rejects it.
+	unsigned major, minor, patch;
+	spvc_get_version(&major, &minor, &patch);
+	append(s, uint32_t(major));
+	append(s, uint32_t(minor));
+	append(s, uint32_t(patch));
+	append(s, uint32_t(cache->entries.size()));
+	for (auto &e : cache->entries)
+	{
+		append(s, uint32_t(e.first.size()));
+		s += e.first;
+		append(s, e.second.flags);
+		append(s, uint32_t(e.second.source.size()));
+		s += e.second.source;
+	}
+
+	if (buffer)
+	{
+		if (*size < s.size())
+			return SPVC_ERROR_INVALID_ARGUMENT;
+		memcpy(buffer, s.data(), s.size());
+	}
+	*size = s.size();
+	return SPVC_SUCCESS;
+}
+
+spvc_bool spvc_msl_cache_lookup(spvc_msl_cache cache, spvc_msl_cache_key key, spvc_msl_cache_entry *entry)
+{
+	if (!cache || !key || !entry)
+		return SPVC_FALSE;
+
+	string k = key->build();
+	lock_guard<mutex> holder(cache->lock);
+	auto itr = cache->entries.find(k);
+	if (itr == cache->entries.end())
+		return SPVC_FALSE;
+
+	spvc_msl_cache_s::fill(itr->second, entry);
+	return SPVC_TRUE;
+}
+
+spvc_result spvc_msl_cache_compile(spvc_msl_cache cache, spvc_msl_cache_key key, spvc_compiler compiler,
+                                   spvc_msl_cache_entry *entry)
+{
+	if (!cache || !key || !compiler || !entry)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result = spvc_msl_cache_key_apply(key, compiler);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	const char *source = nullptr;
+	result = spvc_compiler_compile_traced(compiler, &source);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	Entry e;
+	e.source = source;
+	e.flags = 0;
+	if (spvc_compiler_msl_is_rasterization_disabled(compiler))
+		e.flags |= FLAG_RASTERIZATION_DISABLED;
+	if (spvc_compiler_msl_needs_swizzle_buffer(compiler))
+		e.flags |= FLAG_NEEDS_SWIZZLE_BUFFER;
+	if (spvc_compiler_msl_needs_buffer_size_buffer(compiler))
+		e.flags |= FLAG_NEEDS_BUFFER_SIZE_BUFFER;
+	if (spvc_compiler_msl_needs_output_buffer(compiler))
+		e.flags |= FLAG_NEEDS_OUTPUT_BUFFER;
+	if (spvc_compiler_msl_needs_patch_output_buffer(compiler))
+		e.flags |= FLAG_NEEDS_PATCH_OUTPUT_BUFFER;
+	if (spvc_compiler_msl_needs_input_threadgroup_mem(compiler))
+		e.flags |= FLAG_NEEDS_INPUT_THREADGROUP_MEM;
+
+	string k = key->build();
+	lock_guard<mutex> holder(cache->lock);
+	// Another thread may have compiled the same key; either result is equivalent.
+	auto itr = cache->entries.emplace(move(k), move(e)).first;
+	spvc_msl_cache_s::fill(itr->second, entry);
+	return SPVC_SUCCESS;
+}
+
+#pragma mark - Key
+
+spvc_result spvc_msl_cache_key_create(const SpvId *spirv, size_t word_count, spvc_msl_cache_key *key)
+{
+	if (!spirv || !key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	*key = new (nothrow) spvc_msl_cache_key_s;
+	if (!*key)
+		return SPVC_ERROR_OUT_OF_MEMORY;
+
+	SHA256 hash;
+	hash.update(spirv, word_count * sizeof(SpvId));
+	hash.finish((*key)->digest);
+	(*key)->word_count = uint32_t(word_count);
+	return SPVC_SUCCESS;
+}
+
+void spvc_msl_cache_key_destroy(spvc_msl_cache_key key)
+{
+	delete key;
+}
+
+spvc_result spvc_msl_cache_key_set_bool(spvc_msl_cache_key key, spvc_compiler_option option, spvc_bool value)
+{
+	return spvc_msl_cache_key_set_uint(key, option, value ? 1 : 0);
+}
+
+spvc_result spvc_msl_cache_key_set_uint(spvc_msl_cache_key key, spvc_compiler_option option, unsigned value)
+{
+	if (!key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->options[option] = value;
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_resource_binding(spvc_msl_cache_key key, const spvc_msl_resource_binding *binding)
+{
+	if (!key || !binding)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	key->resource_bindings.push_back(*binding);
+	append(key->records, uint32_t(TAG_RESOURCE_BINDING));
+	append(key->records, uint32_t(binding->stage));
+	append(key->records, uint32_t(binding->desc_set));
+	append(key->records, uint32_t(binding->binding));
+	append(key->records, uint32_t(binding->msl_buffer));
+	append(key->records, uint32_t(binding->msl_texture));
+	append(key->records, uint32_t(binding->msl_sampler));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_vertex_attribute(spvc_msl_cache_key key, const spvc_msl_vertex_attribute *attr)
+{
+	if (!key || !attr)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	// The msl_* and per_instance fields are obsolete and ignored by SPIRV-Cross, so they are not keyed.
+	key->vertex_attributes.push_back(*attr);
+	append(key->records, uint32_t(TAG_VERTEX_ATTRIBUTE));
+	append(key->records, uint32_t(attr->location));
+	append(key->records, uint32_t(attr->format));
+	append(key->records, uint32_t(attr->builtin));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_constexpr_sampler(spvc_msl_cache_key key, spvc_variable_id id,
+                                                     const spvc_msl_constexpr_sampler *sampler)
+{
+	if (!key || !sampler)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	key->constexpr_samplers.push_back({ id, 0, 0, false, *sampler });
+	append(key->records, uint32_t(TAG_CONSTEXPR_SAMPLER));
+	append(key->records, uint32_t(id));
+	append_sampler(key->records, *sampler);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_constexpr_sampler_by_binding(spvc_msl_cache_key key, unsigned desc_set,
+                                                                unsigned binding,
+                                                                const spvc_msl_constexpr_sampler *sampler)
+{
+	if (!key || !sampler)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	key->constexpr_samplers.push_back({ 0, desc_set, binding, true, *sampler });
+	append(key->records, uint32_t(TAG_CONSTEXPR_SAMPLER_BY_BINDING));
+	append(key->records, uint32_t(desc_set));
+	append(key->records, uint32_t(binding));
+	append_sampler(key->records, *sampler);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_set_entry_point(spvc_msl_cache_key key, const char *name,
+                                               SpvExecutionModel execution_model)
+{
+	if (!key || !name || !*name)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->entry_point = name;
+	key->execution_model = execution_model;
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_shader_input(spvc_msl_cache_key key, const spvc_msl_shader_interface_var_2 *input)
+{
+	if (!key || !input)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->shader_inputs.push_back(*input);
+	append_interface_var(key->records, TAG_SHADER_INPUT, *input);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_shader_output(spvc_msl_cache_key key,
+                                                 const spvc_msl_shader_interface_var_2 *output)
+{
+	if (!key || !output)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->shader_outputs.push_back(*output);
+	append_interface_var(key->records, TAG_SHADER_OUTPUT, *output);
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_discrete_descriptor_set(spvc_msl_cache_key key, unsigned desc_set)
+{
+	if (!key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->discrete_descriptor_sets.push_back(desc_set);
+	append(key->records, uint32_t(TAG_DISCRETE_DESCRIPTOR_SET));
+	append(key->records, uint32_t(desc_set));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_set_argument_buffer_device_address_space(spvc_msl_cache_key key, unsigned desc_set,
+                                                                       spvc_bool device_address)
+{
+	if (!key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->argument_buffer_device_address_spaces.push_back({ desc_set, device_address });
+	append(key->records, uint32_t(TAG_ARGUMENT_BUFFER_DEVICE_ADDRESS_SPACE));
+	append(key->records, uint32_t(desc_set));
+	append(key->records, uint32_t(device_address ? 1 : 0));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_dynamic_buffer(spvc_msl_cache_key key, unsigned desc_set, unsigned binding,
+                                                  unsigned index)
+{
+	if (!key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	spvc_msl_resource_binding buffer = {};
+	buffer.desc_set = desc_set;
+	buffer.binding = binding;
+	buffer.msl_buffer = index;
+	key->dynamic_buffers.push_back(buffer);
+	append(key->records, uint32_t(TAG_DYNAMIC_BUFFER));
+	append(key->records, uint32_t(desc_set));
+	append(key->records, uint32_t(binding));
+	append(key->records, uint32_t(index));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_add_inline_uniform_block(spvc_msl_cache_key key, unsigned desc_set, unsigned binding)
+{
+	if (!key)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	key->inline_uniform_blocks.push_back({ desc_set, binding });
+	append(key->records, uint32_t(TAG_INLINE_UNIFORM_BLOCK));
+	append(key->records, uint32_t(desc_set));
+	append(key->records, uint32_t(binding));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_msl_cache_key_apply(spvc_msl_cache_key key, spvc_compiler compiler)
+{
+	if (!key || !compiler)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_result result;
+	// The entry point selects the stage, so it is set before any per-stage state.
+	if (!key->entry_point.empty())
+	{
+		result = spvc_compiler_set_entry_point(compiler, key->entry_point.c_str(), key->execution_model);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	spvc_compiler_options options = nullptr;
+	result = spvc_compiler_create_compiler_options(compiler, &options);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	for (auto &option : key->options)
+	{
+		result = spvc_compiler_options_set_uint(options, option.first, option.second);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	result = spvc_compiler_install_compiler_options(compiler, options);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	for (auto &binding : key->resource_bindings)
+	{
+		result = spvc_compiler_msl_add_resource_binding(compiler, &binding);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &attr : key->vertex_attributes)
+	{
+		result = spvc_compiler_msl_add_vertex_attribute(compiler, &attr);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &s : key->constexpr_samplers)
+	{
+		result = s.by_binding ?
+		             spvc_compiler_msl_remap_constexpr_sampler_by_binding(compiler, s.desc_set, s.binding, &s.sampler) :
+		             spvc_compiler_msl_remap_constexpr_sampler(compiler, s.id, &s.sampler);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &input : key->shader_inputs)
+	{
+		result = spvc_compiler_msl_add_shader_input_2(compiler, &input);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &output : key->shader_outputs)
+	{
+		result = spvc_compiler_msl_add_shader_output_2(compiler, &output);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (unsigned desc_set : key->discrete_descriptor_sets)
+	{
+		result = spvc_compiler_msl_add_discrete_descriptor_set(compiler, desc_set);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &space : key->argument_buffer_device_address_spaces)
+	{
+		result = spvc_compiler_msl_set_argument_buffer_device_address_space(compiler, space.first, space.second);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &buffer : key->dynamic_buffers)
+	{
+		result = spvc_compiler_msl_add_dynamic_buffer(compiler, buffer.desc_set, buffer.binding, buffer.msl_buffer);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	for (auto &block : key->inline_uniform_blocks)
+	{
+		result = spvc_compiler_msl_add_inline_uniform_block(compiler, block.first, block.second);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	return SPVC_SUCCESS;
+}
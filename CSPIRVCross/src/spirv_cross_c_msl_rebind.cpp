@@ -0,0 +1,246 @@
+//
+//  spirv_cross_c_msl_rebind.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <new>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+// Each slot owns a range of placeholder indices, so that indices SPIRV-Cross
+// derives from a placeholder, such as base + element, resolve to the same slot.
+static const uint32_t placeholder_base = 0x10000000u;
+static const uint32_t placeholder_shift = 16;
+static const uint32_t placeholder_range = 1u << placeholder_shift;
+static const size_t max_slots = (0xffffffffu - placeholder_base) >> placeholder_shift;
+
+// Bindings use three consecutive slots.
+enum BindingSlot
+{
+	SLOT_BUFFER,
+	SLOT_TEXTURE,
+	SLOT_SAMPLER,
+	SLOT_COUNT,
+};
+
+static const char *const index_attributes[] = { "buffer(", "texture(", "sampler(", "id(" };
+static const char *const index_subscripts[] = { "spvSwizzleConstants", "spvBufferSizeConstants" };
+
+static unsigned placeholder(size_t slot)
+{
+	return placeholder_base + unsigned(slot << placeholder_shift);
+}
+
+struct Reference
+{
+	size_t slot;
+	unsigned delta;
+};
+} // namespace
+
+struct spvc_msl_rebind_template_s
+{
+	size_t index_option_count = 0;
+	vector<spvc_msl_resource_binding> bindings;
+
+	// The MSL is split at each placeholder, so pieces has one more element than refs.
+	vector<string> pieces;
+	vector<Reference> refs;
+
+	string source;
+
+	size_t slot_count() const
+	{
+		return index_option_count + bindings.size() * SLOT_COUNT;
+	}
+
+	// Records a reference if digits begin a placeholder, and returns the end of the number.
+	const char *substitute(const char *digits, const char *&piece)
+	{
+		const char *end = digits;
+		uint64_t value = 0;
+		while (*end >= '0' && *end <= '9' && value <= 0xffffffffu)
+			value = value * 10 + unsigned(*end++ - '0');
+
+		if (end != digits && value >= placeholder_base && value <= 0xffffffffu)
+		{
+			size_t slot = size_t(value - placeholder_base) >> placeholder_shift;
+			if (slot < slot_count())
+			{
+				pieces.emplace_back(piece, digits);
+				refs.push_back({ slot, unsigned(value - placeholder_base) & (placeholder_range - 1) });
+				piece = end;
+			}
+		}
+		return end;
+	}
+
+	void split(const char *msl)
+	{
+		const char *piece = msl;
+		for (const char *p = strchr(msl, '['); p; p = strchr(p, '['))
+		{
+			if (p[1] == '[')
+			{
+				p += 2;
+				for (const char *attr : index_attributes)
+				{
+					size_t len = strlen(attr);
+					if (strncmp(p, attr, len) == 0)
+					{
+						p = substitute(p + len, piece);
+						break;
+					}
+				}
+				continue;
+			}
+
+			// The entry point reads the swizzle and buffer size of each resource
+			// from the auxiliary buffers, subscripted by its texture or buffer index.
+			for (const char *buffer : index_subscripts)
+			{
+				size_t len = strlen(buffer);
+				if (size_t(p - msl) >= len && strncmp(p - len, buffer, len) == 0)
+				{
+					p = substitute(p + 1, piece);
+					break;
+				}
+			}
+			if (*p == '[')
+				p++;
+		}
+		pieces.emplace_back(piece);
+	}
+};
+
+spvc_result spvc_msl_rebind_template_create(spvc_compiler compiler, spvc_compiler_options options,
+                                            const spvc_compiler_option *index_options, size_t index_option_count,
+                                            const spvc_msl_resource_binding *bindings, size_t binding_count,
+                                            spvc_msl_rebind_template *template_)
+{
+	if (!compiler || !options || !template_ || (index_option_count && !index_options) ||
+	    (binding_count && !bindings))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	if (index_option_count + binding_count * SLOT_COUNT > max_slots)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto *t = new (nothrow) spvc_msl_rebind_template_s;
+	if (!t)
+		return SPVC_ERROR_OUT_OF_MEMORY;
+	t->index_option_count = index_option_count;
+	t->bindings.assign(bindings, bindings + binding_count);
+
+	spvc_result result = SPVC_SUCCESS;
+	for (size_t i = 0; i < index_option_count && result == SPVC_SUCCESS; i++)
+		result = spvc_compiler_options_set_uint(options, index_options[i], placeholder(i));
+	if (result == SPVC_SUCCESS)
+		result = spvc_compiler_install_compiler_options(compiler, options);
+
+	for (size_t i = 0; i < binding_count && result == SPVC_SUCCESS; i++)
+	{
+		size_t slot = index_option_count + i * SLOT_COUNT;
+		spvc_msl_resource_binding binding = bindings[i];
+		binding.msl_buffer = placeholder(slot + SLOT_BUFFER);
+		binding.msl_texture = placeholder(slot + SLOT_TEXTURE);
+		binding.msl_sampler = placeholder(slot + SLOT_SAMPLER);
+		result = spvc_compiler_msl_add_resource_binding(compiler, &binding);
+	}
+
+	const char *msl = nullptr;
+	if (result == SPVC_SUCCESS)
+		result = spvc_compiler_compile_traced(compiler, &msl);
+
+	if (result != SPVC_SUCCESS)
+	{
+		delete t;
+		return result;
+	}
+
+	t->split(msl);
+	*template_ = t;
+	return SPVC_SUCCESS;
+}
+
+void spvc_msl_rebind_template_destroy(spvc_msl_rebind_template template_)
+{
+	delete template_;
+}
+
+spvc_result spvc_msl_rebind_template_emit_to_callback(spvc_msl_rebind_template template_,
+                                                      const unsigned *index_option_values,
+                                                      const spvc_msl_resource_binding *bindings, size_t binding_count,
+                                                      spvc_write_callback callback, void *userdata)
+{
+	if (!template_ || !callback || (template_->index_option_count && !index_option_values) ||
+	    (binding_count && !bindings) || binding_count != template_->bindings.size())
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto &t = *template_;
+	vector<unsigned> values(t.slot_count());
+	for (size_t i = 0; i < t.index_option_count; i++)
+		values[i] = index_option_values[i];
+
+	vector<bool> assigned(t.bindings.size());
+	for (size_t i = 0; i < binding_count; i++)
+	{
+		auto &b = bindings[i];
+		size_t j = 0;
+		for (; j < t.bindings.size(); j++)
+		{
+			auto &tb = t.bindings[j];
+			if (!assigned[j] && tb.stage == b.stage && tb.desc_set == b.desc_set && tb.binding == b.binding)
+				break;
+		}
+		if (j == t.bindings.size())
+			return SPVC_ERROR_INVALID_ARGUMENT;
+
+		assigned[j] = true;
+		size_t slot = t.index_option_count + j * SLOT_COUNT;
+		values[slot + SLOT_BUFFER] = b.msl_buffer;
+		values[slot + SLOT_TEXTURE] = b.msl_texture;
+		values[slot + SLOT_SAMPLER] = b.msl_sampler;
+	}
+
+	spvc_result result = SPVC_SUCCESS;
+	for (size_t i = 0; i < t.refs.size() && result == SPVC_SUCCESS; i++)
+	{
+		result = callback(userdata, t.pieces[i].data(), t.pieces[i].size());
+		if (result == SPVC_SUCCESS)
+		{
+			string index = to_string(values[t.refs[i].slot] + t.refs[i].delta);
+			result = callback(userdata, index.data(), index.size());
+		}
+	}
+	if (result == SPVC_SUCCESS)
+		result = callback(userdata, t.pieces.back().data(), t.pieces.back().size());
+	return result;
+}
+
+spvc_result spvc_msl_rebind_template_emit(spvc_msl_rebind_template template_, const unsigned *index_option_values,
+                                          const spvc_msl_resource_binding *bindings, size_t binding_count,
+                                          const char **source)
+{
+	if (!template_ || !source)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto append = [](void *userdata, const char *data, size_t size) -> spvc_result {
+		static_cast<string *>(userdata)->append(data, size);
+		return SPVC_SUCCESS;
+	};
+
+	template_->source.clear();
+	spvc_result result = spvc_msl_rebind_template_emit_to_callback(template_, index_option_values, bindings,
+	                                                               binding_count, append, &template_->source);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	*source = template_->source.c_str();
+	return SPVC_SUCCESS;
+}
@@ -0,0 +1,269 @@
+//
+//  spirv_cross_c_pack.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <algorithm>
+#include <new>
+#include <string.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+static_assert(sizeof(spvc_shader_pack) == SPVC_SHADER_PACK_ALIGNMENT, "The header fills one alignment unit.");
+static_assert(sizeof(spvc_shader_pack_entry) == SPVC_SHADER_PACK_ALIGNMENT, "Entries fill one alignment unit.");
+
+static uint64_t hash_key(const char *key, size_t size)
+{
+	// FNV-1a over the bytes of the key.
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; i++)
+	{
+		h ^= uint8_t(key[i]);
+		h *= 0x100000001b3ull;
+	}
+	return h;
+}
+
+static uint64_t align(uint64_t offset)
+{
+	return (offset + SPVC_SHADER_PACK_ALIGNMENT - 1) & ~uint64_t(SPVC_SHADER_PACK_ALIGNMENT - 1);
+}
+
+// Orders entries by hash, and then by key.
+static int compare(uint64_t a_hash, const char *a_key, size_t a_size, uint64_t b_hash, const char *b_key,
+                   size_t b_size)
+{
+	if (a_hash != b_hash)
+		return a_hash < b_hash ? -1 : 1;
+	int c = memcmp(a_key, b_key, min(a_size, b_size));
+	if (c != 0)
+		return c;
+	return a_size == b_size ? 0 : (a_size < b_size ? -1 : 1);
+}
+
+// A section of size bytes, plus a terminator if terminated, must be in bounds and aligned.
+static bool section_in_bounds(uint64_t offset, uint64_t size, bool terminated, uint64_t pack_size)
+{
+	if (size == 0 && !terminated)
+		return true;
+	return offset % SPVC_SHADER_PACK_ALIGNMENT == 0 && offset <= pack_size &&
+	       size + (terminated ? 1 : 0) <= pack_size - offset;
+}
+
+struct Shader
+{
+	string key;
+	uint64_t hash;
+	vector<SpvId> spirv;
+	string msl;
+	vector<uint8_t> reflection;
+};
+} // namespace
+
+struct spvc_shader_pack_writer_s
+{
+	vector<Shader> shaders;
+	unordered_set<string> keys;
+};
+
+spvc_result spvc_shader_pack_writer_create(spvc_shader_pack_writer *writer)
+{
+	if (!writer)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	*writer = new (nothrow) spvc_shader_pack_writer_s;
+	return *writer ? SPVC_SUCCESS : SPVC_ERROR_OUT_OF_MEMORY;
+}
+
+void spvc_shader_pack_writer_destroy(spvc_shader_pack_writer writer)
+{
+	delete writer;
+}
+
+spvc_result spvc_shader_pack_writer_add(spvc_shader_pack_writer writer, const char *key, size_t key_size,
+                                        const SpvId *spirv, size_t word_count, const char *msl,
+                                        const void *reflection, size_t reflection_size)
+{
+	if (!writer || !key || (word_count && !spirv) || (reflection_size && !reflection))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	if (reflection_size && !spvc_reflection_blob_validate(reflection, reflection_size))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	size_t msl_size = msl ? strlen(msl) : 0;
+	if (key_size >= UINT32_MAX || word_count >= UINT32_MAX / sizeof(SpvId) || msl_size >= UINT32_MAX ||
+	    reflection_size >= UINT32_MAX)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	string k(key, key_size);
+	if (writer->keys.count(k))
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	Shader shader;
+	shader.key = k;
+	shader.hash = hash_key(key, key_size);
+	shader.spirv.assign(spirv, spirv + word_count);
+	shader.msl.assign(msl ? msl : "", msl_size);
+	auto *bytes = static_cast<const uint8_t *>(reflection);
+	shader.reflection.assign(bytes, bytes + reflection_size);
+
+	writer->keys.insert(move(k));
+	writer->shaders.push_back(move(shader));
+	return SPVC_SUCCESS;
+}
+
+spvc_result spvc_shader_pack_writer_write(spvc_shader_pack_writer writer, spvc_write_callback callback,
+                                          void *userdata)
+{
+	if (!writer || !callback)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	auto &shaders = writer->shaders;
+	sort(shaders.begin(), shaders.end(), [](const Shader &a, const Shader &b) {
+		return compare(a.hash, a.key.data(), a.key.size(), b.hash, b.key.data(), b.key.size()) < 0;
+	});
+
+	// Lay out the sections of each shader after the entries, in entry order.
+	spvc_shader_pack header = {};
+	header.magic = SPVC_SHADER_PACK_MAGIC;
+	header.version = SPVC_SHADER_PACK_VERSION;
+	header.header_size = sizeof(spvc_shader_pack);
+	header.entry_count = uint32_t(shaders.size());
+	header.entry_stride = sizeof(spvc_shader_pack_entry);
+	header.entries_offset = sizeof(spvc_shader_pack);
+
+	vector<spvc_shader_pack_entry> entries(shaders.size());
+	uint64_t offset = header.entries_offset + uint64_t(shaders.size()) * sizeof(spvc_shader_pack_entry);
+	auto place = [&](uint64_t size, bool terminated) -> uint64_t {
+		if (size == 0 && !terminated)
+			return 0;
+		uint64_t start = align(offset);
+		offset = start + size + (terminated ? 1 : 0);
+		return start;
+	};
+
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		auto &shader = shaders[i];
+		auto &entry = entries[i];
+		entry.key_hash = shader.hash;
+		entry.key_size = uint32_t(shader.key.size());
+		entry.key_offset = place(entry.key_size, true);
+		entry.spirv_size = uint32_t(shader.spirv.size() * sizeof(SpvId));
+		entry.spirv_offset = place(entry.spirv_size, false);
+		entry.msl_size = uint32_t(shader.msl.size());
+		entry.msl_offset = place(entry.msl_size, true);
+		entry.reflection_size = uint32_t(shader.reflection.size());
+		entry.reflection_offset = place(entry.reflection_size, false);
+	}
+	header.size = align(offset);
+
+	// Write the sections in the same order, padding each to its offset.
+	static const char zeros[SPVC_SHADER_PACK_ALIGNMENT] = {};
+	uint64_t written = 0;
+	auto write = [&](uint64_t at, const void *data, size_t size, bool terminated) -> spvc_result {
+		if (size == 0 && !terminated)
+			return SPVC_SUCCESS;
+		spvc_result result = SPVC_SUCCESS;
+		if (at > written)
+			result = callback(userdata, zeros, size_t(at - written));
+		if (result == SPVC_SUCCESS && size)
+			result = callback(userdata, static_cast<const char *>(data), size);
+		if (result == SPVC_SUCCESS && terminated)
+			result = callback(userdata, zeros, 1);
+		written = at + size + (terminated ? 1 : 0);
+		return result;
+	};
+
+	spvc_result result = write(0, &header, sizeof(header), false);
+	if (result == SPVC_SUCCESS && !entries.empty())
+		result = write(header.entries_offset, entries.data(), entries.size() * sizeof(spvc_shader_pack_entry), false);
+
+	for (size_t i = 0; i < shaders.size() && result == SPVC_SUCCESS; i++)
+	{
+		auto &shader = shaders[i];
+		auto &entry = entries[i];
+		result = write(entry.key_offset, shader.key.data(), shader.key.size(), true);
+		if (result == SPVC_SUCCESS)
+			result = write(entry.spirv_offset, shader.spirv.data(), entry.spirv_size, false);
+		if (result == SPVC_SUCCESS)
+			result = write(entry.msl_offset, shader.msl.data(), shader.msl.size(), true);
+		if (result == SPVC_SUCCESS)
+			result = write(entry.reflection_offset, shader.reflection.data(), shader.reflection.size(), false);
+	}
+
+	if (result == SPVC_SUCCESS && header.size > written)
+		result = callback(userdata, zeros, size_t(header.size - written));
+	return result;
+}
+
+const spvc_shader_pack *spvc_shader_pack_validate(const void *data, size_t size)
+{
+	if (!data || size < sizeof(spvc_shader_pack) || uintptr_t(data) % alignof(spvc_shader_pack_entry) != 0)
+		return nullptr;
+
+	auto *pack = static_cast<const spvc_shader_pack *>(data);
+	if (pack->magic != SPVC_SHADER_PACK_MAGIC || pack->version != SPVC_SHADER_PACK_VERSION)
+		return nullptr;
+	if (pack->header_size < sizeof(spvc_shader_pack) || pack->size > size ||
+	    pack->entry_stride < sizeof(spvc_shader_pack_entry) || pack->entry_stride % alignof(spvc_shader_pack_entry))
+		return nullptr;
+	if (!section_in_bounds(pack->entries_offset, uint64_t(pack->entry_count) * pack->entry_stride, false, pack->size))
+		return nullptr;
+
+	auto *bytes = static_cast<const char *>(data);
+	const spvc_shader_pack_entry *prev = nullptr;
+	for (uint32_t i = 0; i < pack->entry_count; i++)
+	{
+		auto *entry = spvc_shader_pack_get_entry(pack, i);
+		if (!section_in_bounds(entry->key_offset, entry->key_size, true, pack->size) ||
+		    !section_in_bounds(entry->spirv_offset, entry->spirv_size, false, pack->size) ||
+		    !section_in_bounds(entry->msl_offset, entry->msl_size, true, pack->size) ||
+		    !section_in_bounds(entry->reflection_offset, entry->reflection_size, false, pack->size))
+			return nullptr;
+		if (entry->spirv_size % sizeof(SpvId) != 0)
+			return nullptr;
+		if (bytes[entry->key_offset + entry->key_size] != '\0' || bytes[entry->msl_offset + entry->msl_size] != '\0')
+			return nullptr;
+		if (entry->reflection_size &&
+		    !spvc_reflection_blob_validate(bytes + entry->reflection_offset, entry->reflection_size))
+			return nullptr;
+
+		// The binary search relies on the order and uniqueness of the keys.
+		if (prev && compare(prev->key_hash, bytes + prev->key_offset, prev->key_size, entry->key_hash,
+		                    bytes + entry->key_offset, entry->key_size) >= 0)
+			return nullptr;
+		prev = entry;
+	}
+
+	return pack;
+}
+
+const spvc_shader_pack_entry *spvc_shader_pack_find(const spvc_shader_pack *pack, const char *key, size_t key_size)
+{
+	if (!pack || !key)
+		return nullptr;
+
+	uint64_t hash = hash_key(key, key_size);
+	auto *bytes = reinterpret_cast<const char *>(pack);
+	uint32_t lo = 0;
+	uint32_t hi = pack->entry_count;
+	while (lo < hi)
+	{
+		uint32_t mid = lo + (hi - lo) / 2;
+		auto *entry = spvc_shader_pack_get_entry(pack, mid);
+		int c = compare(entry->key_hash, bytes + entry->key_offset, entry->key_size, hash, key, key_size);
+		if (c == 0)
+			return entry;
+		if (c < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return nullptr;
+}
@@ -0,0 +1,88 @@
+//
+//  spirv_cross_c_packing.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+#include <vector>
+
+using namespace std;
+
+// The largest base alignment of a block member, so shifting by a multiple keeps every member aligned.
+static const unsigned max_member_alignment = 16;
+
+static unsigned align_up(size_t value)
+{
+	return unsigned((value + max_member_alignment - 1) & ~size_t(max_member_alignment - 1));
+}
+
+spvc_result spvc_compiler_msl_pack_buffer(spvc_compiler compiler, spvc_variable_id id, spvc_type_id base_type_id,
+                                          spvc_buffer_packing *packing)
+{
+	if (!compiler || !packing)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_type type = spvc_compiler_get_type_handle(compiler, base_type_id);
+	unsigned member_count = type ? spvc_type_get_num_member_types(type) : 0;
+	if (member_count == 0)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	const spvc_buffer_range *ranges = nullptr;
+	size_t range_count = 0;
+	spvc_result result = spvc_compiler_get_active_buffer_ranges(compiler, id, &ranges, &range_count);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	size_t declared_size = 0;
+	result = spvc_compiler_get_declared_struct_size(compiler, type, &declared_size);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	packing->offset = 0;
+	packing->size = 0;
+	packing->active_end = 0;
+	packing->declared_size = declared_size;
+	if (range_count == 0)
+		return SPVC_SUCCESS;
+
+	unsigned active_end = 0;
+	for (size_t i = 0; i < range_count; i++)
+	{
+		unsigned end = unsigned(ranges[i].offset + ranges[i].range);
+		if (end > active_end)
+			active_end = end;
+	}
+
+	// MSL declares and pads members in index order, and cannot represent a member whose offset is
+	// below the end of the one before, so members keep their order. The block moves down to its
+	// first member, active or not, which is the first active range once inactive leading members
+	// have been removed.
+	unsigned first_offset = ~0u;
+	vector<unsigned> offsets(member_count);
+	for (unsigned i = 0; i < member_count; i++)
+	{
+		result = spvc_compiler_type_struct_member_offset(compiler, type, i, &offsets[i]);
+		if (result != SPVC_SUCCESS)
+			return result;
+		if (offsets[i] < first_offset)
+			first_offset = offsets[i];
+	}
+
+	unsigned shift = first_offset & ~(max_member_alignment - 1);
+	if (shift)
+	{
+		for (unsigned i = 0; i < member_count; i++)
+			spvc_compiler_set_member_decoration(compiler, base_type_id, i, SpvDecorationOffset, offsets[i] - shift);
+
+		result = spvc_compiler_get_declared_struct_size(compiler, type, &declared_size);
+		if (result != SPVC_SUCCESS)
+			return result;
+	}
+
+	size_t size = align_up(active_end) - shift;
+	packing->offset = shift;
+	packing->size = size < declared_size ? size : declared_size;
+	packing->active_end = active_end;
+	packing->declared_size = declared_size;
+	return SPVC_SUCCESS;
+}
@@ -0,0 +1,640 @@
+//
+//  spirv_cross_c_pipeline.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+#include "glslang_c_interface.h"
+#include "spirv_tools_c.h"
+#include "spirv_tools_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct spv_pipeline_job_s
+{
+	glslang_input_t input;
+	string code;
+	// Copies of the request's segments, which input.segments points at.
+	vector<string> segment_data;
+	vector<string> segment_names;
+	vector<glslang_source_segment_t> segments;
+	spv_pipeline_flags flags;
+	unsigned msl_version;
+	spv_pipeline_callback callback;
+	void *userdata;
+
+	atomic<spv_pipeline_priority> priority{ SPV_PIPELINE_PRIORITY_INTERACTIVE };
+	// The index of the pool queue the job was submitted to.
+	size_t queue = 0;
+
+	// Cancels a preprocess, parse or link in progress, unless the request supplied a token.
+	unique_ptr<glslang_cancel_token_t, void (*)(glslang_cancel_token_t *)> token{ nullptr, glslang_cancel_token_delete };
+
+	// The caller and the pool each hold a reference until they are done with the job.
+	atomic<int> refs{ 2 };
+	atomic<bool> cancelled{ false };
+
+	// A final status is stored with release semantics once the results are written.
+	atomic<spv_pipeline_status> status{ SPV_PIPELINE_STATUS_PENDING };
+
+	// Set once the callback has returned.
+	mutex lock;
+	condition_variable done;
+	bool finished = false;
+
+	vector<SpvId> spirv;
+	string msl;
+	string log;
+};
+
+namespace
+{
+static bool is_complete(spv_pipeline_status status)
+{
+	return status >= SPV_PIPELINE_STATUS_SUCCEEDED;
+}
+
+// Runs queued interactive jobs on this worker if job is a background job.
+static void yield_to_interactive(const spv_pipeline_job_s &job);
+
+// Called between stages. Returns whether the job should continue.
+static bool stage_boundary(const spv_pipeline_job_s &job)
+{
+	yield_to_interactive(job);
+	return !job.cancelled;
+}
+
+// Receives the messages of the optimizer running on this thread.
+static thread_local string *optimizer_log = nullptr;
+
+static void optimizer_consumer(spv_message_level_t level, const char *, const spv_position_t *, const char *message)
+{
+	if (optimizer_log && message && level <= SPV_MSG_ERROR)
+	{
+		*optimizer_log += message;
+		*optimizer_log += '\n';
+	}
+}
+
+static spv_target_env_t optimizer_env(glslang_target_language_version_t version)
+{
+	static const spv_target_env_t envs[] = {
+		SPV_TARGET_ENV_UNIVERSAL_1_0, SPV_TARGET_ENV_UNIVERSAL_1_1, SPV_TARGET_ENV_UNIVERSAL_1_2,
+		SPV_TARGET_ENV_UNIVERSAL_1_3, SPV_TARGET_ENV_UNIVERSAL_1_4, SPV_TARGET_ENV_UNIVERSAL_1_5,
+		SPV_TARGET_ENV_UNIVERSAL_1_6,
+	};
+	unsigned minor = (unsigned(version) >> 8) & 0xff;
+	return envs[min<size_t>(minor, sizeof(envs) / sizeof(envs[0]) - 1)];
+}
+
+static void append_log(string &log, const char *message)
+{
+	if (message && *message)
+		log += message;
+}
+
+// Maps a failed glslang phase to the status of the job.
+static spv_pipeline_status glslang_failure(spv_pipeline_job_s &job, glslang_status_t status, const char *log)
+{
+	if (status == GLSLANG_STATUS_CANCELLED)
+		return SPV_PIPELINE_STATUS_CANCELLED;
+
+	append_log(job.log, log);
+	if (status == GLSLANG_STATUS_DEADLINE_EXCEEDED)
+		job.log += "The compile deadline was exceeded.\n";
+	return SPV_PIPELINE_STATUS_FAILED;
+}
+
+static spv_pipeline_status compile_glsl(spv_pipeline_job_s &job)
+{
+	auto &input = job.input;
+	unique_ptr<glslang_shader_t, void (*)(glslang_shader_t *)> shader(glslang_shader_create(&input),
+	                                                                  glslang_shader_delete);
+	if (!shader)
+	{
+		job.log = "Failed to create the shader.\n";
+		return SPV_PIPELINE_STATUS_FAILED;
+	}
+
+	if (!glslang_shader_compile(shader.get(), &input))
+		return glslang_failure(job, glslang_shader_get_status(shader.get()), glslang_shader_get_info_log(shader.get()));
+	if (job.cancelled)
+		return SPV_PIPELINE_STATUS_CANCELLED;
+
+	unique_ptr<glslang_program_t, void (*)(glslang_program_t *)> program(glslang_program_create(),
+	                                                                     glslang_program_delete);
+	glslang_program_add_shader(program.get(), shader.get());
+
+	int messages = input.messages | GLSLANG_MSG_SPV_RULES_BIT;
+	if (input.client == GLSLANG_CLIENT_VULKAN)
+		messages |= GLSLANG_MSG_VULKAN_RULES_BIT;
+	if (!glslang_program_link(program.get(), glslang_messages_t(messages)))
+		return glslang_failure(job, glslang_program_get_status(program.get()),
+		                       glslang_program_get_info_log(program.get()));
+	if (job.cancelled)
+		return SPV_PIPELINE_STATUS_CANCELLED;
+
+	glslang_program_SPIRV_generate(program.get(), input.stage);
+	append_log(job.log, glslang_program_SPIRV_get_messages(program.get()));
+
+	const unsigned *words = glslang_program_SPIRV_get_ptr(program.get());
+	job.spirv.assign(words, words + glslang_program_SPIRV_get_size(program.get()));
+	return SPV_PIPELINE_STATUS_SUCCEEDED;
+}
+
+// The passes of Optimizer::RegisterPerformancePasses, registered one at a time
+// so a background job can yield between them.
+static void register_performance_passes(spvt_optimizer optimizer)
+{
+	spvt_optimizer_register_wrap_op_kill_pass(optimizer);
+	spvt_optimizer_register_dead_branch_elim_pass(optimizer);
+	spvt_optimizer_register_merge_return_pass(optimizer);
+	spvt_optimizer_register_inline_exhaustive_pass(optimizer);
+	spvt_optimizer_register_eliminate_dead_functions_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_private_to_local_pass(optimizer);
+	spvt_optimizer_register_local_single_block_load_store_elim_pass(optimizer);
+	spvt_optimizer_register_local_single_store_elim_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_scalar_replacement_pass(optimizer, 100);
+	spvt_optimizer_register_local_access_chain_convert_pass(optimizer);
+	spvt_optimizer_register_local_single_block_load_store_elim_pass(optimizer);
+	spvt_optimizer_register_local_single_store_elim_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_local_multi_store_elim_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_ccp_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_loop_unroll_pass(optimizer, true, 0);
+	spvt_optimizer_register_dead_branch_elim_pass(optimizer);
+	spvt_optimizer_register_redundancy_elimination_pass(optimizer);
+	spvt_optimizer_register_combine_access_chains_pass(optimizer);
+	spvt_optimizer_register_simplification_pass(optimizer);
+	spvt_optimizer_register_scalar_replacement_pass(optimizer, 100);
+	spvt_optimizer_register_local_access_chain_convert_pass(optimizer);
+	spvt_optimizer_register_local_single_block_load_store_elim_pass(optimizer);
+	spvt_optimizer_register_local_single_store_elim_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_ssa_rewrite_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_vector_dce_pass(optimizer);
+	spvt_optimizer_register_dead_insert_elim_pass(optimizer);
+	spvt_optimizer_register_dead_branch_elim_pass(optimizer);
+	spvt_optimizer_register_simplification_pass(optimizer);
+	spvt_optimizer_register_if_conversion_pass(optimizer);
+	spvt_optimizer_register_copy_propagate_arrays_pass(optimizer);
+	spvt_optimizer_register_reduce_load_size_pass(optimizer);
+	spvt_optimizer_register_aggressive_dce_pass(optimizer);
+	spvt_optimizer_register_block_merge_pass(optimizer);
+	spvt_optimizer_register_redundancy_elimination_pass(optimizer);
+	spvt_optimizer_register_dead_branch_elim_pass(optimizer);
+	spvt_optimizer_register_block_merge_pass(optimizer);
+	spvt_optimizer_register_simplification_pass(optimizer);
+}
+
+static void optimizer_pass_boundary(void *userdata)
+{
+	yield_to_interactive(*static_cast<const spv_pipeline_job_s *>(userdata));
+}
+
+static spv_pipeline_status optimize(spv_pipeline_job_s &job)
+{
+	unique_ptr<spvt_optimizer_s, void (*)(spvt_optimizer)> optimizer(
+	    spvt_optimizer_create(optimizer_env(job.input.target_language_version)), spvt_optimizer_destroy);
+	if (!optimizer)
+		return SPV_PIPELINE_STATUS_FAILED;
+
+	spvt_optimizer_set_consumer(optimizer.get(), optimizer_consumer);
+	spvt_optimizer_set_pass_callback(optimizer.get(), optimizer_pass_boundary, &job);
+	register_performance_passes(optimizer.get());
+
+	// An interactive job which runs between passes installs its own log.
+	string *saved_log = optimizer_log;
+	optimizer_log = &job.log;
+	unique_ptr<spvt_vector_s, void (*)(spvt_vector)> result(
+	    spvt_optimizer_run(optimizer.get(), job.spirv.data(), job.spirv.size()), spvt_vector_destroy);
+	optimizer_log = saved_log;
+
+	if (!result)
+		return SPV_PIPELINE_STATUS_FAILED;
+
+	auto *words = static_cast<const uint32_t *>(spvt_vector_get_ptr(result.get()));
+	job.spirv.assign(words, words + spvt_vector_get_size(result.get()) / sizeof(uint32_t));
+	return SPV_PIPELINE_STATUS_SUCCEEDED;
+}
+
+static spv_pipeline_status compile_msl(spv_pipeline_job_s &job)
+{
+	// Each worker reuses its context, releasing the objects of each job.
+	static thread_local spvc_context context = nullptr;
+	if (!context && spvc_context_create(&context) != SPVC_SUCCESS)
+		return SPV_PIPELINE_STATUS_FAILED;
+
+	spvc_parsed_ir ir = nullptr;
+	spvc_compiler compiler = nullptr;
+	spvc_compiler_options options = nullptr;
+	const char *source = nullptr;
+
+	spvc_result result = spvc_context_parse_spirv(context, job.spirv.data(), job.spirv.size(), &ir);
+	if (result == SPVC_SUCCESS)
+		result = spvc_context_create_compiler(context, SPVC_BACKEND_MSL, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP,
+		                                      &compiler);
+	if (result == SPVC_SUCCESS)
+		result = spvc_compiler_create_compiler_options(compiler, &options);
+	if (result == SPVC_SUCCESS && job.msl_version)
+		result = spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_MSL_VERSION, job.msl_version);
+	if (result == SPVC_SUCCESS)
+		result = spvc_compiler_install_compiler_options(compiler, options);
+	if (result == SPVC_SUCCESS)
+		result = spvc_compiler_compile_traced(compiler, &source);
+
+	if (result == SPVC_SUCCESS)
+		job.msl = source;
+	else
+		append_log(job.log, spvc_context_get_last_error_string(context));
+
+	spvc_context_release_allocations(context);
+	return result == SPVC_SUCCESS ? SPV_PIPELINE_STATUS_SUCCEEDED : SPV_PIPELINE_STATUS_FAILED;
+}
+
+static spv_pipeline_status compile(spv_pipeline_job_s &job)
+{
+	SPVT_TRACE_SCOPE("pipeline job", "pipeline");
+
+	// SPIR-V generation still uses the pool allocator installed by linking,
+	// so the boundary after linking follows it.
+	spv_pipeline_status status = compile_glsl(job);
+	if (status == SPV_PIPELINE_STATUS_SUCCEEDED && (job.flags & SPV_PIPELINE_OPTIMIZE_BIT))
+		status = stage_boundary(job) ? optimize(job) : SPV_PIPELINE_STATUS_CANCELLED;
+	if (status == SPV_PIPELINE_STATUS_SUCCEEDED && (job.flags & SPV_PIPELINE_MSL_BIT))
+		status = stage_boundary(job) ? compile_msl(job) : SPV_PIPELINE_STATUS_CANCELLED;
+	return status;
+}
+
+static void release(spv_pipeline_job job)
+{
+	if (job->refs.fetch_sub(1, memory_order_acq_rel) == 1)
+		delete job;
+}
+
+static void execute(spv_pipeline_job job)
+{
+	spv_pipeline_status status = SPV_PIPELINE_STATUS_CANCELLED;
+	if (!job->cancelled)
+	{
+		job->status.store(SPV_PIPELINE_STATUS_RUNNING, memory_order_relaxed);
+		status = compile(*job);
+	}
+	job->status.store(status, memory_order_release);
+
+	if (job->callback)
+		job->callback(job->userdata, job);
+
+	{
+		lock_guard<mutex> holder(job->lock);
+		job->finished = true;
+	}
+	job->done.notify_all();
+	release(job);
+}
+
+// A worker per hardware thread, each with a queue per priority. A worker takes
+// the newest job of its own queue, so jobs queued from a callback stay on the
+// same thread, and steals the oldest job of another queue when its own is empty.
+// Every interactive queue is searched before any background queue.
+class Pool
+{
+public:
+	static Pool &get()
+	{
+		// Never destroyed, since its workers run for the life of the process.
+		static Pool *pool = new Pool;
+		return *pool;
+	}
+
+	void submit(const spv_pipeline_job *jobs, size_t count)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			auto *job = jobs[i];
+			job->queue = current_worker >= 0 ? size_t(current_worker) : next_queue++ % queues.size();
+
+			auto priority = job->priority.load(memory_order_relaxed);
+			lock_guard<mutex> holder(queues[job->queue]->lock);
+			queues[job->queue]->jobs[priority].push_back(job);
+			if (priority == SPV_PIPELINE_PRIORITY_INTERACTIVE)
+				interactive_pending++;
+		}
+		{
+			lock_guard<mutex> holder(sleep_lock);
+			pending += count;
+		}
+		if (count == 1)
+			wake.notify_one();
+		else
+			wake.notify_all();
+	}
+
+	// Moves a queued background job to the interactive queue. A job which has
+	// already been taken is left alone.
+	void promote(spv_pipeline_job job)
+	{
+		auto &queue = *queues[job->queue];
+		lock_guard<mutex> holder(queue.lock);
+		auto &background = queue.jobs[SPV_PIPELINE_PRIORITY_BACKGROUND];
+		auto it = find(background.begin(), background.end(), job);
+		if (it == background.end())
+			return;
+
+		background.erase(it);
+		queue.jobs[SPV_PIPELINE_PRIORITY_INTERACTIVE].push_back(job);
+		interactive_pending++;
+	}
+
+	// Runs queued interactive jobs on the calling worker until none remain.
+	void run_interactive()
+	{
+		while (interactive_pending.load(memory_order_relaxed) > 0)
+		{
+			// Claim a job as a sleeping worker would, and give the claim back
+			// if another worker took the interactive jobs first.
+			{
+				lock_guard<mutex> holder(sleep_lock);
+				if (pending == 0)
+					return;
+				pending--;
+			}
+
+			spv_pipeline_job job = take(size_t(current_worker), SPV_PIPELINE_PRIORITY_INTERACTIVE);
+			if (!job)
+			{
+				{
+					lock_guard<mutex> holder(sleep_lock);
+					pending++;
+				}
+				wake.notify_one();
+				return;
+			}
+			execute(job);
+		}
+	}
+
+private:
+	struct Queue
+	{
+		mutex lock;
+		// Indexed by spv_pipeline_priority.
+		deque<spv_pipeline_job> jobs[2];
+	};
+
+	vector<unique_ptr<Queue>> queues;
+	atomic<size_t> next_queue{ 0 };
+
+	// The number of jobs in the interactive queues.
+	atomic<size_t> interactive_pending{ 0 };
+
+	// The number of queued jobs no worker has claimed yet.
+	mutex sleep_lock;
+	condition_variable wake;
+	size_t pending = 0;
+
+	static thread_local int current_worker;
+
+	Pool()
+	{
+		glslang_initialize_process();
+
+		unsigned count = max(1u, thread::hardware_concurrency());
+		for (unsigned i = 0; i < count; i++)
+			queues.emplace_back(new Queue);
+		for (unsigned i = 0; i < count; i++)
+			thread([this, i] { run(i); }).detach();
+	}
+
+	spv_pipeline_job take(size_t index, spv_pipeline_priority priority)
+	{
+		for (size_t i = 0; i < queues.size(); i++)
+		{
+			auto &queue = *queues[(index + i) % queues.size()];
+			lock_guard<mutex> holder(queue.lock);
+			auto &jobs = queue.jobs[priority];
+			if (jobs.empty())
+				continue;
+
+			spv_pipeline_job job;
+			if (i == 0)
+			{
+				job = jobs.back();
+				jobs.pop_back();
+			}
+			else
+			{
+				job = jobs.front();
+				jobs.pop_front();
+			}
+			if (priority == SPV_PIPELINE_PRIORITY_INTERACTIVE)
+				interactive_pending--;
+			return job;
+		}
+		return nullptr;
+	}
+
+	spv_pipeline_job take(size_t index)
+	{
+		spv_pipeline_job job = nullptr;
+		if (interactive_pending.load(memory_order_relaxed) > 0)
+			job = take(index, SPV_PIPELINE_PRIORITY_INTERACTIVE);
+		if (!job)
+			job = take(index, SPV_PIPELINE_PRIORITY_BACKGROUND);
+		// A job promoted while this worker scanned the background queues.
+		if (!job)
+			job = take(index, SPV_PIPELINE_PRIORITY_INTERACTIVE);
+		return job;
+	}
+
+	void run(size_t index)
+	{
+		current_worker = int(index);
+		char name[32];
+		snprintf(name, sizeof(name), "spv_pipeline %zu", index);
+		spvt_trace_set_thread_name(name);
+
+		for (;;)
+		{
+			{
+				unique_lock<mutex> holder(sleep_lock);
+				wake.wait(holder, [this] { return pending > 0; });
+				pending--;
+			}
+
+			// Each claim is backed by a queued job, but another worker may take
+			// it first while this one scans, leaving a later one to find.
+			spv_pipeline_job job;
+			while (!(job = take(index)))
+				this_thread::yield();
+			execute(job);
+		}
+	}
+};
+
+thread_local int Pool::current_worker = -1;
+
+static void yield_to_interactive(const spv_pipeline_job_s &job)
+{
+	// Interactive jobs run to completion, so they never nest.
+	if (job.priority.load(memory_order_relaxed) == SPV_PIPELINE_PRIORITY_BACKGROUND)
+		Pool::get().run_interactive();
+}
+
+static spv_pipeline_job create_job(const spv_pipeline_request &request, spv_pipeline_callback callback,
+                                   void *userdata)
+{
+	auto *job = new (nothrow) spv_pipeline_job_s;
+	if (!job)
+		return nullptr;
+
+	job->input = *request.input;
+	if (request.input->segments && request.input->segment_count)
+	{
+		// The job outlives the request, so the segments are copied rather than mapped.
+		size_t count = request.input->segment_count;
+		job->segment_data.reserve(count);
+		job->segment_names.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			auto &segment = request.input->segments[i];
+			job->segment_data.emplace_back(segment.data, segment.length);
+			job->segment_names.emplace_back(segment.name ? segment.name : "");
+			job->segments.push_back({ job->segment_data[i].data(), segment.length, job->segment_names[i].c_str() });
+		}
+		job->input.code = nullptr;
+		job->input.segments = job->segments.data();
+	}
+	else
+	{
+		job->code = request.input->code;
+		job->input.code = job->code.c_str();
+	}
+	if (!job->input.cancel_token)
+	{
+		// Without a token, cancellation waits for the current glslang phase.
+		job->token.reset(glslang_cancel_token_create());
+		job->input.cancel_token = job->token.get();
+	}
+	job->flags = request.flags;
+	job->msl_version = request.msl_version;
+	job->callback = callback;
+	job->userdata = userdata;
+	job->priority.store(request.priority == SPV_PIPELINE_PRIORITY_BACKGROUND ? SPV_PIPELINE_PRIORITY_BACKGROUND :
+	                                                                            SPV_PIPELINE_PRIORITY_INTERACTIVE,
+	                    memory_order_relaxed);
+	return job;
+}
+
+static bool is_valid(const spv_pipeline_request &request)
+{
+	return request.input && (request.input->code || (request.input->segments && request.input->segment_count));
+}
+} // namespace
+
+spvc_result spv_pipeline_compile_async(const spv_pipeline_request *request, spv_pipeline_callback callback,
+                                       void *userdata, spv_pipeline_job *job)
+{
+	if (!request || !job)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	return spv_pipeline_compile_batch(request, 1, callback, userdata, job);
+}
+
+spvc_result spv_pipeline_compile_batch(const spv_pipeline_request *requests, size_t count,
+                                       spv_pipeline_callback callback, void *userdata, spv_pipeline_job *jobs)
+{
+	if ((!requests || !jobs) && count)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+	for (size_t i = 0; i < count; i++)
+		if (!is_valid(requests[i]))
+			return SPVC_ERROR_INVALID_ARGUMENT;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		jobs[i] = create_job(requests[i], callback, userdata);
+		if (!jobs[i])
+		{
+			for (size_t j = 0; j < i; j++)
+				delete jobs[j];
+			return SPVC_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	if (count)
+		Pool::get().submit(jobs, count);
+	return SPVC_SUCCESS;
+}
+
+spv_pipeline_status spv_pipeline_job_poll(spv_pipeline_job job)
+{
+	return job->status.load(memory_order_acquire);
+}
+
+spv_pipeline_status spv_pipeline_job_wait(spv_pipeline_job job, uint64_t timeout_ns)
+{
+	unique_lock<mutex> holder(job->lock);
+	auto finished = [job] { return job->finished; };
+	if (timeout_ns == UINT64_MAX)
+		job->done.wait(holder, finished);
+	else
+		job->done.wait_for(holder, chrono::nanoseconds(int64_t(min<uint64_t>(timeout_ns, INT64_MAX / 2))),
+		                   finished);
+	return job->status.load(memory_order_acquire);
+}
+
+void spv_pipeline_job_promote(spv_pipeline_job job)
+{
+	if (job->priority.exchange(SPV_PIPELINE_PRIORITY_INTERACTIVE, memory_order_relaxed) ==
+	    SPV_PIPELINE_PRIORITY_BACKGROUND)
+		Pool::get().promote(job);
+}
+
+void spv_pipeline_job_cancel(spv_pipeline_job job)
+{
+	job->cancelled.store(true, memory_order_relaxed);
+	if (job->token)
+		glslang_cancel_token_cancel(job->token.get());
+}
+
+const SpvId *spv_pipeline_job_get_spirv(spv_pipeline_job job, size_t *word_count)
+{
+	bool succeeded = job->status.load(memory_order_acquire) == SPV_PIPELINE_STATUS_SUCCEEDED;
+	if (word_count)
+		*word_count = succeeded ? job->spirv.size() : 0;
+	return succeeded ? job->spirv.data() : nullptr;
+}
+
+const char *spv_pipeline_job_get_msl(spv_pipeline_job job)
+{
+	bool succeeded = job->status.load(memory_order_acquire) == SPV_PIPELINE_STATUS_SUCCEEDED;
+	return succeeded && (job->flags & SPV_PIPELINE_MSL_BIT) ? job->msl.c_str() : nullptr;
+}
+
+const char *spv_pipeline_job_get_log(spv_pipeline_job job)
+{
+	return is_complete(job->status.load(memory_order_acquire)) ? job->log.c_str() : "";
+}
+
+void spv_pipeline_job_release(spv_pipeline_job job)
+{
+	if (job)
+		release(job);
+}
@@ -0,0 +1,677 @@
+//
+//  spirv_cross_c_reflection.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+#include "spirv_tools_allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#pragma mark - Helpers
+
+namespace
+{
+static const spvc_resource_type resource_types[] = {
+	SPVC_RESOURCE_TYPE_UNIFORM_BUFFER,
+	SPVC_RESOURCE_TYPE_STORAGE_BUFFER,
+	SPVC_RESOURCE_TYPE_STAGE_INPUT,
+	SPVC_RESOURCE_TYPE_STAGE_OUTPUT,
+	SPVC_RESOURCE_TYPE_SUBPASS_INPUT,
+	SPVC_RESOURCE_TYPE_STORAGE_IMAGE,
+	SPVC_RESOURCE_TYPE_SAMPLED_IMAGE,
+	SPVC_RESOURCE_TYPE_ATOMIC_COUNTER,
+	SPVC_RESOURCE_TYPE_PUSH_CONSTANT,
+	SPVC_RESOURCE_TYPE_SEPARATE_IMAGE,
+	SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS,
+	SPVC_RESOURCE_TYPE_ACCELERATION_STRUCTURE,
+	SPVC_RESOURCE_TYPE_RAY_QUERY,
+	SPVC_RESOURCE_TYPE_SHADER_RECORD_BUFFER,
+};
+
+static bool has_buffer_ranges(spvc_resource_type type)
+{
+	return type == SPVC_RESOURCE_TYPE_UNIFORM_BUFFER || type == SPVC_RESOURCE_TYPE_STORAGE_BUFFER ||
+	       type == SPVC_RESOURCE_TYPE_PUSH_CONSTANT;
+}
+
+static unsigned get_decoration_or_none(spvc_compiler compiler, SpvId id, SpvDecoration decoration)
+{
+	if (!spvc_compiler_has_decoration(compiler, id, decoration))
+		return SPVC_REFLECTION_NO_DECORATION;
+	return spvc_compiler_get_decoration(compiler, id, decoration);
+}
+
+// Precedes each snapshot, so it can be released to the allocator which created it.
+struct SnapshotPrefix
+{
+	spv_allocator_t allocator;
+	size_t size;
+};
+
+static const size_t snapshot_prefix_size =
+    (sizeof(SnapshotPrefix) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+// Computes the offsets of the arrays stored in a single allocation,
+// and then assigns the final pointers once the block is allocated.
+class Arena
+{
+public:
+	template <typename T>
+	size_t reserve(size_t count)
+	{
+		size_t align = alignof(T);
+		size = (size + align - 1) & ~(align - 1);
+		size_t offset = size;
+		size += count * sizeof(T);
+		return offset;
+	}
+
+	bool allocate(const spv_allocator_t &allocator)
+	{
+		size_t total = snapshot_prefix_size + size;
+		auto *block = static_cast<char *>(allocator.alloc(allocator.userdata, total, alignof(max_align_t)));
+		if (!block)
+			return false;
+
+		memset(block, 0, total);
+		auto *prefix = reinterpret_cast<SnapshotPrefix *>(block);
+		prefix->allocator = allocator;
+		prefix->size = total;
+		base = block + snapshot_prefix_size;
+		return true;
+	}
+
+	template <typename T>
+	T *at(size_t offset) const
+	{
+		return reinterpret_cast<T *>(base + offset);
+	}
+
+	template <typename T>
+	const T *copy(size_t offset, const vector<T> &v) const
+	{
+		T *dst = at<T>(offset);
+		if (!v.empty())
+			memcpy(dst, v.data(), v.size() * sizeof(T));
+		return dst;
+	}
+
+	char *base = nullptr;
+	size_t size = 0;
+};
+
+struct SnapshotData
+{
+	vector<spvc_resource_type> resource_type;
+	vector<spvc_variable_id> resource_id;
+	vector<spvc_type_id> resource_base_type_id;
+	vector<spvc_type_id> resource_type_id;
+	vector<size_t> resource_name;
+	vector<unsigned> resource_set;
+	vector<unsigned> resource_binding;
+	vector<unsigned> resource_location;
+	vector<unsigned> resource_input_attachment_index;
+	vector<spvc_basetype> resource_basetype;
+	vector<unsigned> resource_vector_size;
+	vector<unsigned> resource_columns;
+	vector<unsigned> resource_array_size;
+	vector<size_t> resource_declared_size;
+	vector<unsigned> resource_member_begin;
+	vector<unsigned> resource_member_count;
+	vector<unsigned> resource_range_begin;
+	vector<unsigned> resource_range_count;
+
+	vector<size_t> member_name;
+	vector<spvc_type_id> member_type_id;
+	vector<spvc_basetype> member_basetype;
+	vector<unsigned> member_vector_size;
+	vector<unsigned> member_columns;
+	vector<unsigned> member_offset;
+	vector<size_t> member_size;
+	vector<unsigned> member_array_stride;
+	vector<unsigned> member_matrix_stride;
+
+	vector<spvc_buffer_range> ranges;
+
+	vector<size_t> entry_point_name;
+	vector<SpvExecutionModel> entry_point_execution_model;
+
+	SpvExecutionModel execution_model = SpvExecutionModelMax;
+	vector<SpvExecutionMode> execution_mode;
+	vector<unsigned> execution_mode_arguments;
+
+	// Names are stored as offsets into this pool until the final block is allocated.
+	string strings;
+
+	size_t add_string(const char *s)
+	{
+		size_t offset = strings.size();
+		if (s)
+			strings.append(s);
+		strings.push_back('\0');
+		return offset;
+	}
+
+	void add_members(spvc_compiler compiler, spvc_type type)
+	{
+		unsigned count = spvc_type_get_num_member_types(type);
+		spvc_type_id base_type_id = spvc_type_get_base_type_id(type);
+
+		for (unsigned i = 0; i < count; i++)
+		{
+			spvc_type_id member_id = spvc_type_get_member_type(type, i);
+			spvc_type member = spvc_compiler_get_type_handle(compiler, member_id);
+
+			unsigned offset = 0, array_stride = 0, matrix_stride = 0;
+			size_t size = 0;
+			spvc_compiler_type_struct_member_offset(compiler, type, i, &offset);
+			spvc_compiler_get_declared_struct_member_size(compiler, type, i, &size);
+			if (spvc_type_get_num_array_dimensions(member) > 0)
+				spvc_compiler_type_struct_member_array_stride(compiler, type, i, &array_stride);
+			if (spvc_type_get_columns(member) > 1)
+				spvc_compiler_type_struct_member_matrix_stride(compiler, type, i, &matrix_stride);
+
+			member_name.push_back(add_string(spvc_compiler_get_member_name(compiler, base_type_id, i)));
+			member_type_id.push_back(member_id);
+			member_basetype.push_back(spvc_type_get_basetype(member));
+			member_vector_size.push_back(spvc_type_get_vector_size(member));
+			member_columns.push_back(spvc_type_get_columns(member));
+			member_offset.push_back(offset);
+			member_size.push_back(size);
+			member_array_stride.push_back(array_stride);
+			member_matrix_stride.push_back(matrix_stride);
+		}
+	}
+
+	spvc_result add_resource(spvc_compiler compiler, spvc_resource_type type, const spvc_reflected_resource &res)
+	{
+		spvc_type base_type = spvc_compiler_get_type_handle(compiler, res.base_type_id);
+		spvc_type full_type = spvc_compiler_get_type_handle(compiler, res.type_id);
+		if (!base_type || !full_type)
+			return SPVC_ERROR_INVALID_ARGUMENT;
+
+		resource_type.push_back(type);
+		resource_id.push_back(res.id);
+		resource_base_type_id.push_back(res.base_type_id);
+		resource_type_id.push_back(res.type_id);
+		resource_name.push_back(add_string(res.name));
+
+		resource_set.push_back(get_decoration_or_none(compiler, res.id, SpvDecorationDescriptorSet));
+		resource_binding.push_back(get_decoration_or_none(compiler, res.id, SpvDecorationBinding));
+		resource_location.push_back(get_decoration_or_none(compiler, res.id, SpvDecorationLocation));
+		resource_input_attachment_index.push_back(
+		    get_decoration_or_none(compiler, res.id, SpvDecorationInputAttachmentIndex));
+
+		resource_basetype.push_back(spvc_type_get_basetype(base_type));
+		resource_vector_size.push_back(spvc_type_get_vector_size(base_type));
+		resource_columns.push_back(spvc_type_get_columns(base_type));
+
+		unsigned array_size = 1;
+		if (spvc_type_get_num_array_dimensions(full_type) > 0)
+		{
+			unsigned outer = spvc_type_get_num_array_dimensions(full_type) - 1;
+			array_size = spvc_type_array_dimension_is_literal(full_type, outer) ?
+			                 spvc_type_get_array_dimension(full_type, outer) :
+			                 0;
+		}
+		resource_array_size.push_back(array_size);
+
+		size_t declared_size = 0;
+		resource_member_begin.push_back(unsigned(member_name.size()));
+		if (spvc_type_get_num_member_types(base_type) > 0)
+		{
+			if (spvc_compiler_get_declared_struct_size(compiler, base_type, &declared_size) != SPVC_SUCCESS)
+				declared_size = 0;
+			add_members(compiler, base_type);
+		}
+		resource_declared_size.push_back(declared_size);
+		resource_member_count.push_back(unsigned(member_name.size()) - resource_member_begin.back());
+
+		resource_range_begin.push_back(unsigned(ranges.size()));
+		if (has_buffer_ranges(type) && spvc_type_get_num_member_types(base_type) > 0)
+		{
+			const spvc_buffer_range *list = nullptr;
+			size_t count = 0;
+			spvc_result result = spvc_compiler_get_active_buffer_ranges(compiler, res.id, &list, &count);
+			if (result != SPVC_SUCCESS)
+				return result;
+			ranges.insert(ranges.end(), list, list + count);
+		}
+		resource_range_count.push_back(unsigned(ranges.size()) - resource_range_begin.back());
+
+		return SPVC_SUCCESS;
+	}
+
+	spvc_result add_entry_points(spvc_compiler compiler)
+	{
+		const spvc_entry_point *entry_points = nullptr;
+		size_t count = 0;
+		spvc_result result = spvc_compiler_get_entry_points(compiler, &entry_points, &count);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			entry_point_name.push_back(add_string(entry_points[i].name));
+			entry_point_execution_model.push_back(entry_points[i].execution_model);
+		}
+
+		const SpvExecutionMode *modes = nullptr;
+		result = spvc_compiler_get_execution_modes(compiler, &modes, &count);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		execution_model = spvc_compiler_get_execution_model(compiler);
+		for (size_t i = 0; i < count; i++)
+		{
+			execution_mode.push_back(modes[i]);
+			for (unsigned arg = 0; arg < 3; arg++)
+				execution_mode_arguments.push_back(
+				    spvc_compiler_get_execution_mode_argument_by_index(compiler, modes[i], arg));
+		}
+
+		return SPVC_SUCCESS;
+	}
+};
+
+template <typename T>
+static size_t reserve(Arena &arena, const vector<T> &v)
+{
+	return arena.reserve<T>(v.size());
+}
+
+static const char *const *resolve_names(const Arena &arena, size_t offset, const vector<size_t> &names,
+                                        const char *strings)
+{
+	const char **dst = arena.at<const char *>(offset);
+	for (size_t i = 0; i < names.size(); i++)
+		dst[i] = strings + names[i];
+	return dst;
+}
+} // namespace
+
+#pragma mark - Reflection Snapshot
+
+spvc_result spvc_compiler_get_reflection_snapshot(spvc_compiler compiler, const spvc_reflection_snapshot **snapshot)
+{
+	return spvc_compiler_get_reflection_snapshot_with_allocator(compiler, nullptr, snapshot);
+}
+
+spvc_result spvc_compiler_get_reflection_snapshot_with_allocator(spvc_compiler compiler,
+                                                                 const spv_allocator_t *allocator,
+                                                                 const spvc_reflection_snapshot **snapshot)
+{
+	if (!compiler || !snapshot)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	spvc_resources resources = nullptr;
+	spvc_result result = spvc_compiler_create_shader_resources(compiler, &resources);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	SnapshotData data;
+	for (auto type : resource_types)
+	{
+		const spvc_reflected_resource *list = nullptr;
+		size_t count = 0;
+		result = spvc_resources_get_resource_list_for_type(resources, type, &list, &count);
+		if (result != SPVC_SUCCESS)
+			return result;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			result = data.add_resource(compiler, type, list[i]);
+			if (result != SPVC_SUCCESS)
+				return result;
+		}
+	}
+
+	result = data.add_entry_points(compiler);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	Arena arena;
+	size_t header = arena.reserve<spvc_reflection_snapshot>(1);
+	size_t o_resource_type = reserve(arena, data.resource_type);
+	size_t o_resource_id = reserve(arena, data.resource_id);
+	size_t o_resource_base_type_id = reserve(arena, data.resource_base_type_id);
+	size_t o_resource_type_id = reserve(arena, data.resource_type_id);
+	size_t o_resource_name = arena.reserve<const char *>(data.resource_name.size());
+	size_t o_resource_set = reserve(arena, data.resource_set);
+	size_t o_resource_binding = reserve(arena, data.resource_binding);
+	size_t o_resource_location = reserve(arena, data.resource_location);
+	size_t o_resource_input_attachment_index = reserve(arena, data.resource_input_attachment_index);
+	size_t o_resource_basetype = reserve(arena, data.resource_basetype);
+	size_t o_resource_vector_size = reserve(arena, data.resource_vector_size);
+	size_t o_resource_columns = reserve(arena, data.resource_columns);
+	size_t o_resource_array_size = reserve(arena, data.resource_array_size);
+	size_t o_resource_declared_size = reserve(arena, data.resource_declared_size);
+	size_t o_resource_member_begin = reserve(arena, data.resource_member_begin);
+	size_t o_resource_member_count = reserve(arena, data.resource_member_count);
+	size_t o_resource_range_begin = reserve(arena, data.resource_range_begin);
+	size_t o_resource_range_count = reserve(arena, data.resource_range_count);
+	size_t o_member_name = arena.reserve<const char *>(data.member_name.size());
+	size_t o_member_type_id = reserve(arena, data.member_type_id);
+	size_t o_member_basetype = reserve(arena, data.member_basetype);
+	size_t o_member_vector_size = reserve(arena, data.member_vector_size);
+	size_t o_member_columns = reserve(arena, data.member_columns);
+	size_t o_member_offset = reserve(arena, data.member_offset);
+	size_t o_member_size = reserve(arena, data.member_size);
+	size_t o_member_array_stride = reserve(arena, data.member_array_stride);
+	size_t o_member_matrix_stride = reserve(arena, data.member_matrix_stride);
+	size_t o_ranges = reserve(arena, data.ranges);
+	size_t o_entry_point_name = arena.reserve<const char *>(data.entry_point_name.size());
+	size_t o_entry_point_execution_model = reserve(arena, data.entry_point_execution_model);
+	size_t o_execution_mode = reserve(arena, data.execution_mode);
+	size_t o_execution_mode_arguments = reserve(arena, data.execution_mode_arguments);
+	size_t o_strings = arena.reserve<char>(data.strings.size());
+
+	if (!arena.allocate(allocator ? *allocator : *spvt_allocator_get_system()))
+		return SPVC_ERROR_OUT_OF_MEMORY;
+
+	char *strings = arena.at<char>(o_strings);
+	memcpy(strings, data.strings.data(), data.strings.size());
+
+	auto *snap = arena.at<spvc_reflection_snapshot>(header);
+	snap->resource_count = data.resource_id.size();
+	snap->resource_type = arena.copy(o_resource_type, data.resource_type);
+	snap->resource_id = arena.copy(o_resource_id, data.resource_id);
+	snap->resource_base_type_id = arena.copy(o_resource_base_type_id, data.resource_base_type_id);
+	snap->resource_type_id = arena.copy(o_resource_type_id, data.resource_type_id);
+	snap->resource_name = resolve_names(arena, o_resource_name, data.resource_name, strings);
+	snap->resource_set = arena.copy(o_resource_set, data.resource_set);
+	snap->resource_binding = arena.copy(o_resource_binding, data.resource_binding);
+	snap->resource_location = arena.copy(o_resource_location, data.resource_location);
+	snap->resource_input_attachment_index =
+	    arena.copy(o_resource_input_attachment_index, data.resource_input_attachment_index);
+	snap->resource_basetype = arena.copy(o_resource_basetype, data.resource_basetype);
+	snap->resource_vector_size = arena.copy(o_resource_vector_size, data.resource_vector_size);
+	snap->resource_columns = arena.copy(o_resource_columns, data.resource_columns);
+	snap->resource_array_size = arena.copy(o_resource_array_size, data.resource_array_size);
+	snap->resource_declared_size = arena.copy(o_resource_declared_size, data.resource_declared_size);
+	snap->resource_member_begin = arena.copy(o_resource_member_begin, data.resource_member_begin);
+	snap->resource_member_count = arena.copy(o_resource_member_count, data.resource_member_count);
+	snap->resource_range_begin = arena.copy(o_resource_range_begin, data.resource_range_begin);
+	snap->resource_range_count = arena.copy(o_resource_range_count, data.resource_range_count);
+
+	snap->member_count = data.member_name.size();
+	snap->member_name = resolve_names(arena, o_member_name, data.member_name, strings);
+	snap->member_type_id = arena.copy(o_member_type_id, data.member_type_id);
+	snap->member_basetype = arena.copy(o_member_basetype, data.member_basetype);
+	snap->member_vector_size = arena.copy(o_member_vector_size, data.member_vector_size);
+	snap->member_columns = arena.copy(o_member_columns, data.member_columns);
+	snap->member_offset = arena.copy(o_member_offset, data.member_offset);
+	snap->member_size = arena.copy(o_member_size, data.member_size);
+	snap->member_array_stride = arena.copy(o_member_array_stride, data.member_array_stride);
+	snap->member_matrix_stride = arena.copy(o_member_matrix_stride, data.member_matrix_stride);
+
+	snap->range_count = data.ranges.size();
+	snap->ranges = arena.copy(o_ranges, data.ranges);
+
+	snap->entry_point_count = data.entry_point_name.size();
+	snap->entry_point_name = resolve_names(arena, o_entry_point_name, data.entry_point_name, strings);
+	snap->entry_point_execution_model = arena.copy(o_entry_point_execution_model, data.entry_point_execution_model);
+
+	snap->execution_model = data.execution_model;
+	snap->execution_mode_count = data.execution_mode.size();
+	snap->execution_mode = arena.copy(o_execution_mode, data.execution_mode);
+	snap->execution_mode_arguments = arena.copy(o_execution_mode_arguments, data.execution_mode_arguments);
+
+	*snapshot = snap;
+	return SPVC_SUCCESS;
+}
+
+void spvc_reflection_snapshot_free(const spvc_reflection_snapshot *snapshot)
+{
+	if (!snapshot)
+		return;
+
+	auto *block = const_cast<char *>(reinterpret_cast<const char *>(snapshot)) - snapshot_prefix_size;
+	auto *prefix = reinterpret_cast<SnapshotPrefix *>(block);
+	spv_allocator_t allocator = prefix->allocator;
+	allocator.free(allocator.userdata, block, prefix->size);
+}
+
+spvc_result spvc_compiler_compile_with_reflection(spvc_compiler compiler, const char **source,
+                                                  const spvc_reflection_snapshot **snapshot)
+{
+	spvc_result result = spvc_compiler_compile_traced(compiler, source);
+	if (result != SPVC_SUCCESS)
+		return result;
+	return spvc_compiler_get_reflection_snapshot(compiler, snapshot);
+}
+
+#pragma mark - Reflection Blob
+
+namespace
+{
+class BlobWriter
+{
+public:
+	explicit BlobWriter(const spvc_reflection_snapshot &snapshot)
+	    : snapshot(snapshot)
+	{
+	}
+
+	// Returns false if the blob would exceed the 32-bit offsets of the format.
+	bool layout()
+	{
+		for (size_t i = 0; i < snapshot.entry_point_count; i++)
+			intern(snapshot.entry_point_name[i]);
+		for (size_t i = 0; i < snapshot.resource_count; i++)
+			intern(snapshot.resource_name[i]);
+		for (size_t i = 0; i < snapshot.member_count; i++)
+			intern(snapshot.member_name[i]);
+
+		size_t offset = sizeof(spvc_reflection_blob);
+		offset = reserve(header.entry_points, offset, snapshot.entry_point_count,
+		                 sizeof(spvc_reflection_blob_entry_point));
+		offset = reserve(header.execution_modes, offset, snapshot.execution_mode_count,
+		                 sizeof(spvc_reflection_blob_execution_mode));
+		offset = reserve(header.resources, offset, snapshot.resource_count, sizeof(spvc_reflection_blob_resource));
+		offset = reserve(header.members, offset, snapshot.member_count, sizeof(spvc_reflection_blob_member));
+		offset = reserve(header.ranges, offset, snapshot.range_count, sizeof(spvc_reflection_blob_range));
+		offset = reserve(header.strings, offset, strings.size(), 1);
+		total = align(offset);
+
+		header.magic = SPVC_REFLECTION_BLOB_MAGIC;
+		header.version = SPVC_REFLECTION_BLOB_VERSION;
+		header.size = uint32_t(total);
+		header.header_size = sizeof(spvc_reflection_blob);
+		header.execution_model = uint32_t(snapshot.execution_model);
+
+		return total <= UINT32_MAX;
+	}
+
+	size_t size() const
+	{
+		return total;
+	}
+
+	void write(char *buffer) const
+	{
+		memset(buffer, 0, total);
+		memcpy(buffer, &header, sizeof(header));
+
+		auto *entry_points = record<spvc_reflection_blob_entry_point>(buffer, header.entry_points);
+		for (size_t i = 0; i < snapshot.entry_point_count; i++)
+		{
+			entry_points[i].name = lookup(snapshot.entry_point_name[i]);
+			entry_points[i].execution_model = uint32_t(snapshot.entry_point_execution_model[i]);
+		}
+
+		auto *modes = record<spvc_reflection_blob_execution_mode>(buffer, header.execution_modes);
+		for (size_t i = 0; i < snapshot.execution_mode_count; i++)
+		{
+			modes[i].mode = uint32_t(snapshot.execution_mode[i]);
+			for (size_t arg = 0; arg < 3; arg++)
+				modes[i].arguments[arg] = snapshot.execution_mode_arguments[i * 3 + arg];
+		}
+
+		auto *resources = record<spvc_reflection_blob_resource>(buffer, header.resources);
+		for (size_t i = 0; i < snapshot.resource_count; i++)
+		{
+			auto &r = resources[i];
+			r.type = uint32_t(snapshot.resource_type[i]);
+			r.id = snapshot.resource_id[i];
+			r.base_type_id = snapshot.resource_base_type_id[i];
+			r.type_id = snapshot.resource_type_id[i];
+			r.name = lookup(snapshot.resource_name[i]);
+			r.set = snapshot.resource_set[i];
+			r.binding = snapshot.resource_binding[i];
+			r.location = snapshot.resource_location[i];
+			r.input_attachment_index = snapshot.resource_input_attachment_index[i];
+			r.basetype = uint32_t(snapshot.resource_basetype[i]);
+			r.vector_size = snapshot.resource_vector_size[i];
+			r.columns = snapshot.resource_columns[i];
+			r.array_size = snapshot.resource_array_size[i];
+			r.declared_size = uint32_t(snapshot.resource_declared_size[i]);
+			r.member_begin = snapshot.resource_member_begin[i];
+			r.member_count = snapshot.resource_member_count[i];
+			r.range_begin = snapshot.resource_range_begin[i];
+			r.range_count = snapshot.resource_range_count[i];
+		}
+
+		auto *members = record<spvc_reflection_blob_member>(buffer, header.members);
+		for (size_t i = 0; i < snapshot.member_count; i++)
+		{
+			auto &m = members[i];
+			m.name = lookup(snapshot.member_name[i]);
+			m.type_id = snapshot.member_type_id[i];
+			m.basetype = uint32_t(snapshot.member_basetype[i]);
+			m.vector_size = snapshot.member_vector_size[i];
+			m.columns = snapshot.member_columns[i];
+			m.offset = snapshot.member_offset[i];
+			m.size = uint32_t(snapshot.member_size[i]);
+			m.array_stride = snapshot.member_array_stride[i];
+			m.matrix_stride = snapshot.member_matrix_stride[i];
+		}
+
+		auto *ranges = record<spvc_reflection_blob_range>(buffer, header.ranges);
+		for (size_t i = 0; i < snapshot.range_count; i++)
+		{
+			ranges[i].index = snapshot.ranges[i].index;
+			ranges[i].offset = uint32_t(snapshot.ranges[i].offset);
+			ranges[i].range = uint32_t(snapshot.ranges[i].range);
+		}
+
+		if (!strings.empty())
+			memcpy(buffer + header.strings.offset, strings.data(), strings.size());
+	}
+
+private:
+	static size_t align(size_t offset)
+	{
+		return (offset + 7) & ~size_t(7);
+	}
+
+	static size_t reserve(spvc_reflection_blob_table &table, size_t offset, size_t count, size_t stride)
+	{
+		offset = align(offset);
+		table.offset = uint32_t(offset);
+		table.count = uint32_t(count);
+		table.stride = uint32_t(stride);
+		return offset + count * stride;
+	}
+
+	template <typename T>
+	static T *record(char *buffer, const spvc_reflection_blob_table &table)
+	{
+		return reinterpret_cast<T *>(buffer + table.offset);
+	}
+
+	void intern(const char *s)
+	{
+		if (offsets.count(s))
+			return;
+		offsets[s] = uint32_t(strings.size());
+		strings.append(s);
+		strings.push_back('\0');
+	}
+
+	uint32_t lookup(const char *s) const
+	{
+		return offsets.find(s)->second;
+	}
+
+	const spvc_reflection_snapshot &snapshot;
+	spvc_reflection_blob header = {};
+	unordered_map<string, uint32_t> offsets;
+	string strings;
+	size_t total = 0;
+};
+
+static bool table_in_bounds(const spvc_reflection_blob_table &table, size_t min_stride, uint64_t size)
+{
+	if (table.count == 0)
+		return true;
+	if (table.stride < min_stride || (table.offset & 3) != 0)
+		return false;
+	return uint64_t(table.offset) + uint64_t(table.count) * uint64_t(table.stride) <= size;
+}
+} // namespace
+
+spvc_result spvc_reflection_snapshot_serialize(const spvc_reflection_snapshot *snapshot, void *buffer, size_t *size)
+{
+	if (!snapshot || !size)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	BlobWriter writer(*snapshot);
+	if (!writer.layout())
+		return SPVC_ERROR_UNSUPPORTED_SPIRV;
+
+	if (!buffer)
+	{
+		*size = writer.size();
+		return SPVC_SUCCESS;
+	}
+
+	if (*size < writer.size())
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	writer.write(static_cast<char *>(buffer));
+	*size = writer.size();
+	return SPVC_SUCCESS;
+}
+
+const spvc_reflection_blob *spvc_reflection_blob_validate(const void *data, size_t size)
+{
+	if (!data || size < sizeof(spvc_reflection_blob) || uintptr_t(data) % alignof(spvc_reflection_blob) != 0)
+		return nullptr;
+
+	// Newer minor versions only append fields, which the header and table sizes skip.
+	auto *blob = static_cast<const spvc_reflection_blob *>(data);
+	if (blob->magic != SPVC_REFLECTION_BLOB_MAGIC || (blob->version >> 16) != SPVC_REFLECTION_BLOB_VERSION_MAJOR)
+		return nullptr;
+	if (blob->header_size < sizeof(spvc_reflection_blob) || blob->size > size)
+		return nullptr;
+
+	uint64_t blob_size = blob->size;
+	if (!table_in_bounds(blob->entry_points, sizeof(spvc_reflection_blob_entry_point), blob_size) ||
+	    !table_in_bounds(blob->execution_modes, sizeof(spvc_reflection_blob_execution_mode), blob_size) ||
+	    !table_in_bounds(blob->resources, sizeof(spvc_reflection_blob_resource), blob_size) ||
+	    !table_in_bounds(blob->members, sizeof(spvc_reflection_blob_member), blob_size) ||
+	    !table_in_bounds(blob->ranges, sizeof(spvc_reflection_blob_range), blob_size))
+		return nullptr;
+
+	// Strings are byte-aligned, and the last one must be terminated so reads stay in bounds.
+	const auto &strings = blob->strings;
+	if (strings.count != 0)
+	{
+		if (strings.stride != 1 || uint64_t(strings.offset) + strings.count > blob_size)
+			return nullptr;
+		if (static_cast<const char *>(data)[strings.offset + strings.count - 1] != '\0')
+			return nullptr;
+	}
+
+	return blob;
+}
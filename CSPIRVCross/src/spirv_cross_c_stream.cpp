@@ -0,0 +1,31 @@
+//
+//  spirv_cross_c_stream.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+
+#include <string.h>
+
+spvc_result spvc_compiler_compile_to_callback(spvc_compiler compiler, spvc_write_callback callback, void *userdata,
+                                              size_t chunk_size)
+{
+	if (!compiler || !callback)
+		return SPVC_ERROR_INVALID_ARGUMENT;
+
+	const char *source = nullptr;
+	spvc_result result = spvc_compiler_compile_traced(compiler, &source);
+	if (result != SPVC_SUCCESS)
+		return result;
+
+	size_t size = strlen(source);
+	if (chunk_size == 0)
+		chunk_size = size;
+
+	for (size_t offset = 0; offset < size && result == SPVC_SUCCESS; offset += chunk_size)
+	{
+		size_t n = size - offset < chunk_size ? size - offset : chunk_size;
+		result = callback(userdata, source + offset, n);
+	}
+	return result;
+}
@@ -0,0 +1,13 @@
+//
+//  spirv_cross_c_trace.cpp
+//  CSPIRVCross
+//
+
+#include "spirv_cross_c_ext.h"
+#include "spirv_tools_trace.h"
+
+spvc_result spvc_compiler_compile_traced(spvc_compiler compiler, const char **source)
+{
+	SPVT_TRACE_SCOPE("compile", "spirv-cross");
+	return spvc_compiler_compile(compiler, source);
+}
@@ -9,6 +9,8 @@
 #define CSPIRVTools_h
 
 #include <CSPIRVTools/spirv_tools_c.h>
+#include <CSPIRVTools/spirv_tools_allocator.h>
+#include <CSPIRVTools/spirv_tools_trace.h>
 #include <CSPIRVTools/libspirv.h>
 
 #endif /* CSPIRVTools_h */
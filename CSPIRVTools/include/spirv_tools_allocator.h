@@ -0,0 +1,127 @@
+//
+//  spirv_tools_allocator.h
+//  CSPIRVTools
+//
+
+#ifndef spirv_tools_allocator_h
+#define spirv_tools_allocator_h
+
+#ifdef __cplusplus
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+#include <stddef.h>
+
+#define SPVT_PUBLIC_API
+
+/*
+ * An allocator which can be installed on the objects of the glslang,
+ * SPIRV-Tools and SPIRV-Cross wrappers, so their allocations can be routed to
+ * a per-worker arena or measured.
+ *
+ * The wrappers route the objects they create and the buffers they return.
+ * Memory allocated internally by glslang, SPIRV-Tools and SPIRV-Cross is
+ * unaffected.
+ */
+
+typedef struct spv_allocator_t
+{
+    /* Returns size bytes aligned to alignment, a power of two, or NULL if out of memory. */
+    void *(*alloc)(void *userdata, size_t size, size_t alignment);
+
+    /* Resizes an allocation of old_size bytes, preserving its contents, or returns NULL and leaves ptr intact. */
+    void *(*realloc)(void *userdata, void *ptr, size_t old_size, size_t new_size, size_t alignment);
+
+    /* Releases an allocation of size bytes. ptr may be NULL. */
+    void (*free)(void *userdata, void *ptr, size_t size);
+
+    void *userdata;
+} spv_allocator_t;
+
+/*!
+ @brief Returns the allocator used when none is installed, which calls the system allocator.
+ */
+SPVT_PUBLIC_API const spv_allocator_t *spvt_allocator_get_system(void);
+
+#pragma mark - Arena
+
+/*
+ * A bump allocator which carves allocations out of large blocks, and releases
+ * them all at once when it is reset.
+ *
+ * Freeing or resizing the most recent allocation is done in place; freeing
+ * any other allocation is a no-op until the next reset. An arena is not
+ * thread-safe, and is intended to be owned by a single worker.
+ */
+
+typedef struct spvt_arena_s *spvt_arena;
+
+typedef struct spvt_arena_stats
+{
+    /* Bytes handed out since the last reset, less those given back in place. */
+    size_t allocated_bytes;
+    /* The highest allocated_bytes reached since the arena was created. */
+    size_t peak_bytes;
+    /* Bytes of the blocks held by the arena. */
+    size_t reserved_bytes;
+    /* Allocations since the arena was created, including resizes which moved. */
+    size_t allocation_count;
+    size_t reset_count;
+} spvt_arena_stats;
+
+/*!
+ @brief Creates an arena.
+
+ @param block_size The size of each block, or 0 for the default of 64 KiB. Larger allocations
+                   are given a block of their own.
+ @returns The arena, or NULL if out of memory.
+ */
+SPVT_PUBLIC_API spvt_arena spvt_arena_create(size_t block_size);
+SPVT_PUBLIC_API void spvt_arena_destroy(spvt_arena arena);
+
+/*!
+ @brief Returns an allocator for the arena, which remains valid until the arena is destroyed.
+ */
+SPVT_PUBLIC_API const spv_allocator_t *spvt_arena_get_allocator(spvt_arena arena);
+
+/*!
+ @brief Releases every allocation of the arena, keeping its standard blocks for reuse.
+
+ Objects created with the arena's allocator must have been destroyed.
+ */
+SPVT_PUBLIC_API void spvt_arena_reset(spvt_arena arena);
+
+SPVT_PUBLIC_API void spvt_arena_get_stats(spvt_arena arena, spvt_arena_stats *stats);
+
+#ifdef __cplusplus
+}
+
+#include <new>
+#include <utility>
+
+/* Constructs a T in memory from allocator, returning NULL if out of memory. */
+template <typename T, typename... Args>
+T *spvt_allocator_new(const spv_allocator_t &allocator, Args &&... args)
+{
+    void *ptr = allocator.alloc(allocator.userdata, sizeof(T), alignof(T));
+    if (!ptr)
+        return nullptr;
+    return new (ptr) T(std::forward<Args>(args)...);
+}
+
+/* Destroys a T created by spvt_allocator_new with the same allocator. */
+template <typename T>
+void spvt_allocator_delete(const spv_allocator_t &allocator, T *ptr)
+{
+    if (!ptr)
+        return;
+    ptr->~T();
+    allocator.free(allocator.userdata, ptr, sizeof(T));
+}
+
+#endif
+
+#endif /* spirv_tools_allocator_h */
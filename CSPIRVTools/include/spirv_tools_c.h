@@ -8,6 +8,9 @@
 #ifndef spirv_tools_c_h
 #define spirv_tools_c_h
 
+// Declares C++ helpers, so it is included outside the extern "C" block.
+#include <CSPIRVTools/spirv_tools_allocator.h>
+
 #ifdef __cplusplus
 extern "C" {
 #else
@@ -77,6 +80,11 @@ typedef void (* message_consumer_t) (spv_message_level_t /* level */,
                                      const spv_position_t* /* position */,
                                      const char* /* message */);
 
+/*!
+ @brief Callback function run between optimizer passes.
+ */
+typedef void (* spvt_pass_callback_t) (void* /* userdata */);
+
 
 #pragma mark - Opaque Types
 
@@ -96,6 +104,16 @@ SPVT_PUBLIC_API void *spvt_vector_get_ptr(spvt_vector vec);
  */
 SPVT_PUBLIC_API spvt_optimizer spvt_optimizer_create(spv_target_env_t env);
 
+/*!
+ @brief Creates a new optimizer, which allocates itself and the vectors it returns from allocator.
+
+ @param allocator The allocator, which is copied, or NULL for the system allocator. It must outlive
+                  the optimizer and its vectors.
+ @returns The optimizer, or NULL if out of memory.
+ */
+SPVT_PUBLIC_API spvt_optimizer spvt_optimizer_create_with_allocator(spv_target_env_t env,
+                                                                    const spv_allocator_t *allocator);
+
 SPVT_PUBLIC_API void spvt_optimizer_destroy(spvt_optimizer optimizer);
 
 /*!
@@ -105,6 +123,22 @@ SPVT_PUBLIC_API void spvt_optimizer_set_consumer(spvt_optimizer optimizer, messa
 
 SPVT_PUBLIC_API void spvt_optimizer_clear_consumer(spvt_optimizer optimizer);
 
+/*!
+ @brief Sets a callback which is run on the optimizing thread before each pass.
+
+ A batch of passes, such as @c spvt_optimizer_register_performance_passes, is run without a
+ callback between its passes.
+ */
+SPVT_PUBLIC_API void spvt_optimizer_set_pass_callback(spvt_optimizer optimizer, spvt_pass_callback_t callback,
+                                                      void *userdata);
+
+/*!
+ @brief Optimizes original_binary and returns the result, or NULL if the optimizer failed.
+
+ SPIRV-Tools builds the result and every intermediate module in system memory, so the
+ optimizer's allocator only holds the returned vector. With any allocator but the system
+ one, the result is copied into it, which costs a second buffer of the result's size.
+ */
 SPVT_PUBLIC_API spvt_vector spvt_optimizer_run(spvt_optimizer optimizer,
                                                uint32_t const * original_binary, size_t original_binary_size);
 
@@ -0,0 +1,112 @@
+//
+//  spirv_tools_trace.h
+//  CSPIRVTools
+//
+
+#ifndef spirv_tools_trace_h
+#define spirv_tools_trace_h
+
+#ifdef __cplusplus
+extern "C" {
+#else
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+#include <stddef.h>
+
+#define SPVT_PUBLIC_API
+
+/*
+ * Records thread-tagged spans of the compile pipeline: glslang preprocess,
+ * parse, link and SPIR-V generation, each SPIRV-Tools pass, and SPIRV-Cross
+ * compiles. Spans are written to a fixed-size ring buffer owned by the
+ * recording thread, without locks, and the oldest are overwritten when it is
+ * full. spvt_trace_flush_json drains every buffer as Chrome trace JSON, which
+ * can be opened in Perfetto or chrome://tracing.
+ *
+ * Recording is off until spvt_trace_start is called, and the instrumentation
+ * is compiled out when SPVT_TRACE_ENABLED is defined as 0.
+ */
+
+#ifndef SPVT_TRACE_ENABLED
+#define SPVT_TRACE_ENABLED 1
+#endif
+
+/* The number of events each thread retains between flushes. */
+#define SPVT_TRACE_BUFFER_CAPACITY 16384
+
+typedef void (* spvt_trace_writer_t) (void * /* userdata */, const char * /* data */, size_t /* size */);
+
+SPVT_PUBLIC_API void spvt_trace_start(void);
+SPVT_PUBLIC_API void spvt_trace_stop(void);
+SPVT_PUBLIC_API bool spvt_trace_is_recording(void);
+
+/*!
+ @brief Begins a span on the calling thread, if recording.
+
+ @param name The name of the span, which must remain valid until it is flushed, such as a literal or a
+             string returned by @c spvt_trace_intern.
+ @param category The category of the span, with the same lifetime as name.
+ */
+SPVT_PUBLIC_API void spvt_trace_begin(const char *name, const char *category);
+
+/*!
+ @brief Ends the innermost span of the calling thread.
+ */
+SPVT_PUBLIC_API void spvt_trace_end(void);
+
+/*!
+ @brief Returns a copy of name which remains valid for the life of the process.
+ */
+SPVT_PUBLIC_API const char *spvt_trace_intern(const char *name);
+
+/*!
+ @brief Names the calling thread in the trace.
+ */
+SPVT_PUBLIC_API void spvt_trace_set_thread_name(const char *name);
+
+/*!
+ @brief Writes the events recorded since the last flush as a Chrome trace JSON object, and discards them.
+
+ Threads may continue recording while the buffers are flushed. Events which are overwritten while
+ they are read are dropped.
+ */
+SPVT_PUBLIC_API void spvt_trace_flush_json(spvt_trace_writer_t writer, void *userdata);
+
+#ifdef __cplusplus
+}
+
+/* Records a span for the rest of the enclosing scope. */
+struct spvt_trace_scope
+{
+    bool active;
+
+    spvt_trace_scope(const char *name, const char *category) : active(spvt_trace_is_recording())
+    {
+        if (active)
+            spvt_trace_begin(name, category);
+    }
+
+    ~spvt_trace_scope()
+    {
+        if (active)
+            spvt_trace_end();
+    }
+
+    spvt_trace_scope(const spvt_trace_scope &) = delete;
+    spvt_trace_scope &operator=(const spvt_trace_scope &) = delete;
+};
+
+#define SPVT_TRACE_CONCAT_(a, b) a##b
+#define SPVT_TRACE_CONCAT(a, b) SPVT_TRACE_CONCAT_(a, b)
+
+#if SPVT_TRACE_ENABLED
+#define SPVT_TRACE_SCOPE(name, category) spvt_trace_scope SPVT_TRACE_CONCAT(spvt_trace_scope_, __LINE__)(name, category)
+#else
+#define SPVT_TRACE_SCOPE(name, category) ((void)0)
+#endif
+
+#endif
+
+#endif /* spirv_tools_trace_h */
@@ -0,0 +1,249 @@
+//
+//  spirv_tools_allocator.cpp
+//  CSPIRVTools
+//
+
+#include "spirv_tools_allocator.h"
+
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+static const size_t default_block_size = 64 * 1024;
+
+// malloc already satisfies every fundamental alignment.
+static const size_t malloc_alignment = alignof(max_align_t);
+
+static void *system_alloc(void *, size_t size, size_t alignment)
+{
+    if (alignment <= malloc_alignment)
+        return malloc(size ? size : 1);
+
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, size ? size : 1) != 0)
+        return nullptr;
+    return ptr;
+}
+
+static void *system_realloc(void *userdata, void *ptr, size_t old_size, size_t new_size, size_t alignment)
+{
+    if (alignment <= malloc_alignment)
+        return realloc(ptr, new_size ? new_size : 1);
+
+    // realloc may not preserve a larger alignment.
+    void *result = system_alloc(userdata, new_size, alignment);
+    if (result && ptr)
+    {
+        memcpy(result, ptr, min(old_size, new_size));
+        free(ptr);
+    }
+    return result;
+}
+
+static void system_free(void *, void *ptr, size_t)
+{
+    free(ptr);
+}
+
+static const spv_allocator_t system_allocator = { system_alloc, system_realloc, system_free, nullptr };
+
+static uintptr_t align_up(uintptr_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~uintptr_t(alignment - 1);
+}
+} // namespace
+
+const spv_allocator_t *spvt_allocator_get_system(void)
+{
+    return &system_allocator;
+}
+
+#pragma mark - Arena
+
+struct spvt_arena_s
+{
+    struct Block
+    {
+        char *base;
+        size_t size;
+    };
+
+    spv_allocator_t allocator;
+    size_t block_size;
+    spvt_arena_stats stats = {};
+
+    // Blocks of block_size, which are kept across resets, followed by the
+    // current block's cursor. Larger allocations get a block in oversized.
+    vector<Block> blocks;
+    size_t current = 0;
+    char *cursor = nullptr;
+    char *limit = nullptr;
+    vector<Block> oversized;
+
+    // The most recent allocation, which can be freed or resized in place, and the cursor
+    // before it, so freeing it also returns its alignment padding.
+    char *last = nullptr;
+    char *last_begin = nullptr;
+
+    ~spvt_arena_s()
+    {
+        for (auto &block : blocks)
+            free(block.base);
+        for (auto &block : oversized)
+            free(block.base);
+    }
+
+    void charge(ptrdiff_t bytes)
+    {
+        stats.allocated_bytes += bytes;
+        stats.peak_bytes = max(stats.peak_bytes, stats.allocated_bytes);
+    }
+
+    // Moves the cursor to the next standard block, allocating it if needed.
+    bool next_block()
+    {
+        size_t index = cursor ? current + 1 : 0;
+        if (index == blocks.size())
+        {
+            char *base = static_cast<char *>(malloc(block_size));
+            if (!base)
+                return false;
+            blocks.push_back({ base, block_size });
+            stats.reserved_bytes += block_size;
+        }
+        current = index;
+        cursor = blocks[index].base;
+        limit = cursor + blocks[index].size;
+        return true;
+    }
+
+    void *allocate(size_t size, size_t alignment)
+    {
+        size = max<size_t>(size, 1);
+        if (size + alignment > block_size / 2)
+        {
+            // A dedicated block, so large allocations do not waste the rest of a standard block.
+            void *ptr = system_alloc(nullptr, size, alignment);
+            if (!ptr)
+                return nullptr;
+            oversized.push_back({ static_cast<char *>(ptr), size });
+            stats.reserved_bytes += size;
+            stats.allocation_count++;
+            charge(size);
+            return ptr;
+        }
+
+        char *ptr = reinterpret_cast<char *>(align_up(uintptr_t(cursor), alignment));
+        if (!cursor || ptr + size > limit)
+        {
+            if (!next_block())
+                return nullptr;
+            ptr = reinterpret_cast<char *>(align_up(uintptr_t(cursor), alignment));
+        }
+
+        charge(ptr + size - cursor);
+        last_begin = cursor;
+        cursor = ptr + size;
+        last = ptr;
+        stats.allocation_count++;
+        return ptr;
+    }
+
+    bool is_last(void *ptr, size_t size) const
+    {
+        return ptr && ptr == last && last + max<size_t>(size, 1) == cursor;
+    }
+};
+
+namespace
+{
+static void *arena_alloc(void *userdata, size_t size, size_t alignment)
+{
+    return static_cast<spvt_arena>(userdata)->allocate(size, alignment);
+}
+
+static void *arena_realloc(void *userdata, void *ptr, size_t old_size, size_t new_size, size_t alignment)
+{
+    auto *arena = static_cast<spvt_arena>(userdata);
+    if (!ptr)
+        return arena->allocate(new_size, alignment);
+
+    new_size = max<size_t>(new_size, 1);
+    if (arena->is_last(ptr, old_size) && arena->last + new_size <= arena->limit)
+    {
+        arena->charge(ptrdiff_t(new_size) - ptrdiff_t(max<size_t>(old_size, 1)));
+        arena->cursor = arena->last + new_size;
+        return ptr;
+    }
+
+    void *result = arena->allocate(new_size, alignment);
+    if (result)
+        memcpy(result, ptr, min(old_size, new_size));
+    return result;
+}
+
+static void arena_free(void *userdata, void *ptr, size_t size)
+{
+    auto *arena = static_cast<spvt_arena>(userdata);
+    if (arena->is_last(ptr, size))
+    {
+        arena->stats.allocated_bytes -= size_t(arena->cursor - arena->last_begin);
+        arena->cursor = arena->last_begin;
+        arena->last = nullptr;
+    }
+}
+} // namespace
+
+spvt_arena spvt_arena_create(size_t block_size)
+{
+    auto *arena = new (nothrow) spvt_arena_s;
+    if (!arena)
+        return nullptr;
+
+    arena->allocator = { arena_alloc, arena_realloc, arena_free, arena };
+    arena->block_size = block_size ? block_size : default_block_size;
+    return arena;
+}
+
+void spvt_arena_destroy(spvt_arena arena)
+{
+    delete arena;
+}
+
+const spv_allocator_t *spvt_arena_get_allocator(spvt_arena arena)
+{
+    return arena ? &arena->allocator : nullptr;
+}
+
+void spvt_arena_reset(spvt_arena arena)
+{
+    if (!arena)
+        return;
+
+    for (auto &block : arena->oversized)
+    {
+        arena->stats.reserved_bytes -= block.size;
+        free(block.base);
+    }
+    arena->oversized.clear();
+
+    arena->current = 0;
+    arena->cursor = nullptr;
+    arena->limit = nullptr;
+    arena->last = nullptr;
+    arena->stats.allocated_bytes = 0;
+    arena->stats.reset_count++;
+}
+
+void spvt_arena_get_stats(spvt_arena arena, spvt_arena_stats *stats)
+{
+    if (arena && stats)
+        *stats = arena->stats;
+}
@@ -6,10 +6,14 @@
 //
 
 #include "spirv_tools_c.h"
+#include "spirv_tools_allocator.h"
+#include "spirv_tools_trace.h"
 
 #include "spirv-tools/optimizer.hpp"
 #include "spirv-tools/libspirv.h"
+#include "source/opt/pass.h"
 
+#include <list>
 #include <memory>
 #include <new>
 #include <string.h>
@@ -31,43 +35,143 @@ ENUM_CHECK(spv_target_env, SPV_ENV_MAX, SPV_TARGET_ENV_MAX);
 
 #pragma mark - Vector
 
+static bool is_system_allocator(const spv_allocator_t &allocator)
+{
+    return allocator.alloc == spvt_allocator_get_system()->alloc;
+}
+
 struct spvt_vector_s
 {
+    spv_allocator_t allocator;
+    
+    // The words are owned by buf for the system allocator, and are otherwise
+    // copied to memory from allocator.
     std::vector<uint32_t> buf;
+    uint32_t *words = nullptr;
+    size_t count = 0;
+    
+    ~spvt_vector_s()
+    {
+        if (words != buf.data())
+            allocator.free(allocator.userdata, words, count * sizeof(uint32_t));
+    }
 };
 
 void spvt_vector_destroy(spvt_vector vec)
 {
-    delete vec;
+    if (!vec)
+        return;
+    
+    auto allocator = vec->allocator;
+    spvt_allocator_delete(allocator, vec);
 }
 
 size_t spvt_vector_get_size(spvt_vector vec)
 {
-    return vec->buf.size() * sizeof(uint32_t);
+    return vec->count * sizeof(uint32_t);
 }
 
 void *spvt_vector_get_ptr(spvt_vector vec)
 {
-    return static_cast<void *>(vec->buf.data());
+    return static_cast<void *>(vec->words);
 }
 
 #pragma mark - Optimizer
 
 struct spvt_optimizer_s
 {
+    spv_allocator_t allocator;
     unique_ptr<Optimizer> optimizer;
+    
+    spvt_pass_callback_t pass_callback = nullptr;
+    void *pass_userdata = nullptr;
+    
+    // The span names of the markers, which must have stable addresses.
+    list<const char *> pass_names;
 };
 
+#if SPVT_TRACE_ENABLED
+static thread_local bool pass_span_open = false;
+#endif
+
+// Optimizer does not expose its passes, so a marker registered before each
+// pass runs the pass callback, and ends the span of the previous pass and
+// begins the span of the next.
+class MarkerPass : public opt::Pass
+{
+public:
+    MarkerPass(spvt_optimizer optimizer, const char *const *span_name) : optimizer_(optimizer), span_name_(span_name) {}
+    
+    const char *name() const override { return "marker"; }
+    
+    Status Process() override
+    {
+#if SPVT_TRACE_ENABLED
+        if (pass_span_open)
+        {
+            spvt_trace_end();
+            pass_span_open = false;
+        }
+#endif
+        // The span is closed first, so the callback may run an optimizer of its own.
+        if (optimizer_->pass_callback)
+            optimizer_->pass_callback(optimizer_->pass_userdata);
+#if SPVT_TRACE_ENABLED
+        spvt_trace_begin(*span_name_, "spirv-tools");
+        pass_span_open = true;
+#endif
+        return Status::SuccessWithoutChange;
+    }
+    
+private:
+    spvt_optimizer optimizer_;
+    const char *const *span_name_;
+};
+
+static const char **register_marker(spvt_optimizer optimizer)
+{
+    optimizer->pass_names.push_back("");
+    const char **span_name = &optimizer->pass_names.back();
+    optimizer->optimizer->RegisterPass(Optimizer::PassToken(unique_ptr<opt::Pass>(new MarkerPass(optimizer, span_name))));
+    return span_name;
+}
+
+static void register_pass(spvt_optimizer optimizer, Optimizer::PassToken &&pass)
+{
+    const char **span_name = register_marker(optimizer);
+    optimizer->optimizer->RegisterPass(std::move(pass));
+#if SPVT_TRACE_ENABLED
+    *span_name = spvt_trace_intern(optimizer->optimizer->GetPassNames().back());
+#else
+    (void)span_name;
+#endif
+}
+
 spvt_optimizer spvt_optimizer_create(spv_target_env_t env)
 {
-    auto opt = new spvt_optimizer_s();
+    return spvt_optimizer_create_with_allocator(env, nullptr);
+}
+
+spvt_optimizer spvt_optimizer_create_with_allocator(spv_target_env_t env, const spv_allocator_t *allocator)
+{
+    if (!allocator)
+        allocator = spvt_allocator_get_system();
+    
+    auto opt = spvt_allocator_new<spvt_optimizer_s>(*allocator);
+    if (!opt)
+        return nullptr;
+    opt->allocator = *allocator;
     opt->optimizer.reset(new Optimizer(static_cast<spv_target_env>(env)));
     return opt;
 }
 
 void spvt_optimizer_destroy(spvt_optimizer optimizer)
 {
-    delete optimizer;
+    if (!optimizer)
+        return;
+    
+    auto allocator = optimizer->allocator;
+    spvt_allocator_delete(allocator, optimizer);
 }
 
 void spvt_optimizer_set_consumer(spvt_optimizer optimizer, message_consumer_t callback)
@@ -83,6 +187,12 @@ void spvt_optimizer_clear_consumer(spvt_optimizer optimizer)
     optimizer->optimizer->SetMessageConsumer(nullptr);
 }
 
+void spvt_optimizer_set_pass_callback(spvt_optimizer optimizer, spvt_pass_callback_t callback, void *userdata)
+{
+    optimizer->pass_callback = callback;
+    optimizer->pass_userdata = userdata;
+}
+
 spvt_vector spvt_optimizer_run(spvt_optimizer optimizer, uint32_t const * original_binary, size_t original_binary_size)
 {
     return spvt_optimizer_run_options(optimizer, original_binary, original_binary_size, spv_optimizer_options());
@@ -92,33 +202,83 @@ spvt_vector spvt_optimizer_run_options(spvt_optimizer optimizer,
                                        uint32_t const * original_binary, size_t original_binary_size,
                                        spv_optimizer_options options)
 {
+    SPVT_TRACE_SCOPE("optimize", "spirv-tools");
+    
     vector<uint32_t> optimized;
     optimized.reserve(original_binary_size);
     
     auto res = optimizer->optimizer->Run(original_binary, original_binary_size, &optimized, options);
+#if SPVT_TRACE_ENABLED
+    if (pass_span_open)
+    {
+        spvt_trace_end();
+        pass_span_open = false;
+    }
+#endif
     if (!res)
     {
         return nullptr;
     }
     
-    auto vec = new spvt_vector_s();
-    vec->buf = std::move(optimized);
+    auto &allocator = optimizer->allocator;
+    auto vec = spvt_allocator_new<spvt_vector_s>(allocator);
+    if (!vec)
+        return nullptr;
+    vec->allocator = allocator;
+    vec->count = optimized.size();
+    
+    if (is_system_allocator(allocator))
+    {
+        vec->buf = std::move(optimized);
+        vec->words = vec->buf.data();
+        return vec;
+    }
+    
+    size_t size = vec->count * sizeof(uint32_t);
+    vec->words = static_cast<uint32_t *>(allocator.alloc(allocator.userdata, size, alignof(uint32_t)));
+    if (!vec->words)
+    {
+        vec->count = 0;
+        spvt_vector_destroy(vec);
+        return nullptr;
+    }
+    memcpy(vec->words, optimized.data(), size);
     return vec;
 }
 
 
+// Passes registered in a batch are traced as a single span.
+
 void spvt_optimizer_register_performance_passes(spvt_optimizer optimizer)
 {
+    const char **span_name = register_marker(optimizer);
+#if SPVT_TRACE_ENABLED
+    *span_name = "performance passes";
+#else
+    (void)span_name;
+#endif
     optimizer->optimizer->RegisterPerformancePasses();
 }
 
 void spvt_optimizer_register_size_passes(spvt_optimizer optimizer)
 {
+    const char **span_name = register_marker(optimizer);
+#if SPVT_TRACE_ENABLED
+    *span_name = "size passes";
+#else
+    (void)span_name;
+#endif
     optimizer->optimizer->RegisterSizePasses();
 }
 
 bool spvt_optimizer_register_pass_from_flag(spvt_optimizer optimizer, char const * flag)
 {
+    const char **span_name = register_marker(optimizer);
+#if SPVT_TRACE_ENABLED
+    *span_name = spvt_trace_intern(flag);
+#else
+    (void)span_name;
+#endif
     return optimizer->optimizer->RegisterPassFromFlag(flag);
 }
 
@@ -126,32 +286,32 @@ bool spvt_optimizer_register_pass_from_flag(spvt_optimizer optimizer, char const
 
 void spvt_optimizer_register_null_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateNullPass());
+    register_pass(optimizer, CreateNullPass());
 }
 
 void spvt_optimizer_register_strip_debug_info_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateStripDebugInfoPass());
+    register_pass(optimizer, CreateStripDebugInfoPass());
 }
 
 void spvt_optimizer_register_strip_reflect_info_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateStripReflectInfoPass());
+    register_pass(optimizer, CreateStripReflectInfoPass());
 }
 
 void spvt_optimizer_register_strip_non_semantic_info_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateStripNonSemanticInfoPass());
+    register_pass(optimizer, CreateStripNonSemanticInfoPass());
 }
 
 void spvt_optimizer_register_eliminate_dead_functions_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateEliminateDeadFunctionsPass());
+    register_pass(optimizer, CreateEliminateDeadFunctionsPass());
 }
 
 void spvt_optimizer_register_eliminate_dead_members_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateEliminateDeadMembersPass());
+    register_pass(optimizer, CreateEliminateDeadMembersPass());
 }
 
 //Optimizer::PassToken CreateSetSpecConstantDefaultValuePass( const std::unordered_map<uint32_t, std::string>& id_value_map);
@@ -160,305 +320,305 @@ void spvt_optimizer_register_eliminate_dead_members_pass(spvt_optimizer optimize
 
 void spvt_optimizer_register_flatten_decoration_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateFlattenDecorationPass());
+    register_pass(optimizer, CreateFlattenDecorationPass());
 }
 
 void spvt_optimizer_register_freeze_spec_constant_value_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateFreezeSpecConstantValuePass());
+    register_pass(optimizer, CreateFreezeSpecConstantValuePass());
 }
 
 void spvt_optimizer_register_fold_spec_constant_op_and_composite_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateFoldSpecConstantOpAndCompositePass());
+    register_pass(optimizer, CreateFoldSpecConstantOpAndCompositePass());
 }
 
 void spvt_optimizer_register_unify_constant_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateUnifyConstantPass());
+    register_pass(optimizer, CreateUnifyConstantPass());
 }
 
 void spvt_optimizer_register_eliminate_dead_constant_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateEliminateDeadConstantPass());
+    register_pass(optimizer, CreateEliminateDeadConstantPass());
 }
 
 void spvt_optimizer_register_strength_reduction_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateStrengthReductionPass());
+    register_pass(optimizer, CreateStrengthReductionPass());
 }
 
 void spvt_optimizer_register_block_merge_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateBlockMergePass());
+    register_pass(optimizer, CreateBlockMergePass());
 }
 
 void spvt_optimizer_register_inline_exhaustive_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateInlineExhaustivePass());
+    register_pass(optimizer, CreateInlineExhaustivePass());
 }
 
 void spvt_optimizer_register_inline_opaque_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateInlineOpaquePass());
+    register_pass(optimizer, CreateInlineOpaquePass());
 }
 
 void spvt_optimizer_register_local_single_block_load_store_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLocalSingleBlockLoadStoreElimPass());
+    register_pass(optimizer, CreateLocalSingleBlockLoadStoreElimPass());
 }
 
 void spvt_optimizer_register_dead_branch_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateDeadBranchElimPass());
+    register_pass(optimizer, CreateDeadBranchElimPass());
 }
 
 void spvt_optimizer_register_local_multi_store_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLocalMultiStoreElimPass());
+    register_pass(optimizer, CreateLocalMultiStoreElimPass());
 }
 
 void spvt_optimizer_register_local_access_chain_convert_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLocalAccessChainConvertPass());
+    register_pass(optimizer, CreateLocalAccessChainConvertPass());
 }
 
 void spvt_optimizer_register_local_single_store_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLocalSingleStoreElimPass());
+    register_pass(optimizer, CreateLocalSingleStoreElimPass());
 }
 
 void spvt_optimizer_register_insert_extract_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateInsertExtractElimPass());
+    register_pass(optimizer, CreateInsertExtractElimPass());
 }
 
 void spvt_optimizer_register_dead_insert_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateDeadInsertElimPass());
+    register_pass(optimizer, CreateDeadInsertElimPass());
 }
 
 void spvt_optimizer_register_aggressive_dce_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateAggressiveDCEPass());
+    register_pass(optimizer, CreateAggressiveDCEPass());
 }
 
 void spvt_optimizer_register_remove_unused_interface_variables_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateRemoveUnusedInterfaceVariablesPass());
+    register_pass(optimizer, CreateRemoveUnusedInterfaceVariablesPass());
 }
 
 void spvt_optimizer_register_propagate_line_info_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreatePropagateLineInfoPass());
+    register_pass(optimizer, CreatePropagateLineInfoPass());
 }
 
 void spvt_optimizer_register_redundant_line_info_elim_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateRedundantLineInfoElimPass());
+    register_pass(optimizer, CreateRedundantLineInfoElimPass());
 }
 
 void spvt_optimizer_register_compact_ids_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateCompactIdsPass());
+    register_pass(optimizer, CreateCompactIdsPass());
 }
 
 void spvt_optimizer_register_remove_duplicates_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateRemoveDuplicatesPass());
+    register_pass(optimizer, CreateRemoveDuplicatesPass());
 }
 
 void spvt_optimizer_register_cfg_cleanup_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateCFGCleanupPass());
+    register_pass(optimizer, CreateCFGCleanupPass());
 }
 
 void spvt_optimizer_register_dead_variable_elimination_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateDeadVariableEliminationPass());
+    register_pass(optimizer, CreateDeadVariableEliminationPass());
 }
 
 void spvt_optimizer_register_merge_return_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateMergeReturnPass());
+    register_pass(optimizer, CreateMergeReturnPass());
 }
 
 void spvt_optimizer_register_local_redundancy_elimination_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLocalRedundancyEliminationPass());
+    register_pass(optimizer, CreateLocalRedundancyEliminationPass());
 }
 
 void spvt_optimizer_register_loop_invariant_code_motion_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLoopInvariantCodeMotionPass());
+    register_pass(optimizer, CreateLoopInvariantCodeMotionPass());
 }
 
 void spvt_optimizer_register_loop_fission_pass(spvt_optimizer optimizer, size_t threshold) 
 {
-    optimizer->optimizer->RegisterPass(CreateLoopFissionPass(threshold));
+    register_pass(optimizer, CreateLoopFissionPass(threshold));
 }
 
 void spvt_optimizer_register_loop_fusion_pass(spvt_optimizer optimizer, size_t max_registers_per_loop) 
 {
-    optimizer->optimizer->RegisterPass(CreateLoopFusionPass(max_registers_per_loop));
+    register_pass(optimizer, CreateLoopFusionPass(max_registers_per_loop));
 }
 
 void spvt_optimizer_register_loop_peeling_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLoopPeelingPass());
+    register_pass(optimizer, CreateLoopPeelingPass());
 }
 
 void spvt_optimizer_register_loop_unswitch_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateLoopUnswitchPass());
+    register_pass(optimizer, CreateLoopUnswitchPass());
 }
 
 void spvt_optimizer_register_redundancy_elimination_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateRedundancyEliminationPass());
+    register_pass(optimizer, CreateRedundancyEliminationPass());
 }
 
 void spvt_optimizer_register_scalar_replacement_pass(spvt_optimizer optimizer, uint32_t size_limit)
 {
-  optimizer->optimizer->RegisterPass(CreateScalarReplacementPass(size_limit));
+  register_pass(optimizer, CreateScalarReplacementPass(size_limit));
 }
 
 void spvt_optimizer_register_private_to_local_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreatePrivateToLocalPass());
+    register_pass(optimizer, CreatePrivateToLocalPass());
 }
 
 void spvt_optimizer_register_ccp_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateCCPPass());
+    register_pass(optimizer, CreateCCPPass());
 }
 
 void spvt_optimizer_register_workaround_1209_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateWorkaround1209Pass());
+    register_pass(optimizer, CreateWorkaround1209Pass());
 }
 
 void spvt_optimizer_register_if_conversion_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateIfConversionPass());
+    register_pass(optimizer, CreateIfConversionPass());
 }
 
 void spvt_optimizer_register_replace_invalid_opcode_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateReplaceInvalidOpcodePass());
+    register_pass(optimizer, CreateReplaceInvalidOpcodePass());
 }
 
 void spvt_optimizer_register_simplification_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateSimplificationPass());
+    register_pass(optimizer, CreateSimplificationPass());
 }
 
 void spvt_optimizer_register_loop_unroll_pass(spvt_optimizer optimizer, bool fully_unroll, int factor)
 {
-    optimizer->optimizer->RegisterPass(CreateLoopUnrollPass(fully_unroll, factor));
+    register_pass(optimizer, CreateLoopUnrollPass(fully_unroll, factor));
 }
 
 void spvt_optimizer_register_ssa_rewrite_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateSSARewritePass());
+    register_pass(optimizer, CreateSSARewritePass());
 }
 
 void spvt_optimizer_register_convert_relaxed_to_half_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateConvertRelaxedToHalfPass());
+    register_pass(optimizer, CreateConvertRelaxedToHalfPass());
 }
 
 void spvt_optimizer_register_relax_float_ops_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateRelaxFloatOpsPass());
+    register_pass(optimizer, CreateRelaxFloatOpsPass());
 }
 
 void spvt_optimizer_register_copy_propagate_arrays_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateCopyPropagateArraysPass());
+    register_pass(optimizer, CreateCopyPropagateArraysPass());
 }
 
 void spvt_optimizer_register_vector_dce_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateVectorDCEPass());
+    register_pass(optimizer, CreateVectorDCEPass());
 }
 
 void spvt_optimizer_register_reduce_load_size_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateReduceLoadSizePass());
+    register_pass(optimizer, CreateReduceLoadSizePass());
 }
 
 void spvt_optimizer_register_combine_access_chains_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateCombineAccessChainsPass());
+    register_pass(optimizer, CreateCombineAccessChainsPass());
 }
 
 void spvt_optimizer_register_inst_bindless_check_pass(spvt_optimizer optimizer, uint32_t desc_set, uint32_t shader_id, bool input_length_enable, bool input_init_enable)
 {
-  optimizer->optimizer->RegisterPass(CreateInstBindlessCheckPass(desc_set, shader_id, input_length_enable, input_init_enable));
+  register_pass(optimizer, CreateInstBindlessCheckPass(desc_set, shader_id, input_length_enable, input_init_enable));
 }
 
 void spvt_optimizer_register_inst_buff_addr_check_pass(spvt_optimizer optimizer, uint32_t desc_set, uint32_t shader_id) 
 {
-  optimizer->optimizer->RegisterPass(CreateInstBuffAddrCheckPass(desc_set, shader_id));
+  register_pass(optimizer, CreateInstBuffAddrCheckPass(desc_set, shader_id));
 }
 
 void spvt_optimizer_register_inst_debug_printf_pass(spvt_optimizer optimizer, uint32_t desc_set, uint32_t shader_id) 
 {
-  optimizer->optimizer->RegisterPass(CreateInstDebugPrintfPass(desc_set, shader_id));
+  register_pass(optimizer, CreateInstDebugPrintfPass(desc_set, shader_id));
 }
 
 void spvt_optimizer_register_upgrade_memory_model_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateUpgradeMemoryModelPass());
+    register_pass(optimizer, CreateUpgradeMemoryModelPass());
 }
 
 void spvt_optimizer_register_code_sinking_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateCodeSinkingPass());
+    register_pass(optimizer, CreateCodeSinkingPass());
 }
 
 void spvt_optimizer_register_fix_storage_class_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateFixStorageClassPass());
+    register_pass(optimizer, CreateFixStorageClassPass());
 }
 
 void spvt_optimizer_register_graphics_robust_access_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateGraphicsRobustAccessPass());
+    register_pass(optimizer, CreateGraphicsRobustAccessPass());
 }
 
 void spvt_optimizer_register_spread_volatile_semantics_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateSpreadVolatileSemanticsPass());
+    register_pass(optimizer, CreateSpreadVolatileSemanticsPass());
 }
 
 void spvt_optimizer_register_descriptor_scalar_replacement_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateDescriptorScalarReplacementPass());
+    register_pass(optimizer, CreateDescriptorScalarReplacementPass());
 }
 
 void spvt_optimizer_register_wrap_op_kill_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateWrapOpKillPass());
+    register_pass(optimizer, CreateWrapOpKillPass());
 }
 
 void spvt_optimizer_register_amd_ext_to_khr_pass(spvt_optimizer optimizer) 
 {
-    optimizer->optimizer->RegisterPass(CreateAmdExtToKhrPass());
+    register_pass(optimizer, CreateAmdExtToKhrPass());
 }
 
 void spvt_optimizer_register_interpolate_fixup_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateInterpolateFixupPass());
+    register_pass(optimizer, CreateInterpolateFixupPass());
 }
 
 void spvt_optimizer_register_eliminate_dead_input_components_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateEliminateDeadInputComponentsPass());
+    register_pass(optimizer, CreateEliminateDeadInputComponentsPass());
 }
 
 void spvt_optimizer_register_remove_dont_inline_pass(spvt_optimizer optimizer)
 {
-    optimizer->optimizer->RegisterPass(CreateRemoveDontInlinePass());
+    register_pass(optimizer, CreateRemoveDontInlinePass());
 }
@@ -0,0 +1,283 @@
+//
+//  spirv_tools_trace.cpp
+//  CSPIRVTools
+//
+
+#include "spirv_tools_trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+// The fields are relaxed atomics, so the flushing thread may read a slot while its owner rewrites it.
+struct Event
+{
+    atomic<uint64_t> ts;
+    atomic<const char *> name;
+    atomic<const char *> category;
+    atomic<char> phase;
+};
+
+struct ThreadBuffer
+{
+    uint32_t tid;
+    // Guarded by the registry mutex.
+    string name;
+
+    // Written only by the owning thread. Events are published by the release store of head.
+    atomic<uint64_t> head{0};
+    // Read and written only while flushing.
+    uint64_t tail = 0;
+
+    Event events[SPVT_TRACE_BUFFER_CAPACITY];
+};
+
+struct Registry
+{
+    mutex lock;
+    vector<unique_ptr<ThreadBuffer>> buffers;
+
+    mutex strings_lock;
+    unordered_set<string> strings;
+
+    mutex flush_lock;
+};
+
+static atomic<bool> recording{false};
+static thread_local ThreadBuffer *thread_buffer = nullptr;
+
+// Whether each open span of the thread was recorded, innermost in the lowest bit,
+// so an end is only recorded when its begin was.
+static thread_local uint64_t open_spans = 0;
+static thread_local uint32_t open_depth = 0;
+
+static Registry &registry()
+{
+    static Registry *r = new Registry;
+    return *r;
+}
+
+static uint64_t now()
+{
+    static const auto epoch = chrono::steady_clock::now();
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - epoch).count());
+}
+
+// Buffers are kept after their thread exits, so its events can still be flushed.
+static ThreadBuffer &get_thread_buffer()
+{
+    if (!thread_buffer)
+    {
+        auto &r = registry();
+        lock_guard<mutex> holder(r.lock);
+        r.buffers.emplace_back(new ThreadBuffer);
+        thread_buffer = r.buffers.back().get();
+        thread_buffer->tid = uint32_t(r.buffers.size());
+    }
+    return *thread_buffer;
+}
+
+static void record(char phase, const char *name, const char *category)
+{
+    auto &buffer = get_thread_buffer();
+    uint64_t head = buffer.head.load(memory_order_relaxed);
+    auto &event = buffer.events[head % SPVT_TRACE_BUFFER_CAPACITY];
+    event.ts.store(now(), memory_order_relaxed);
+    event.name.store(name, memory_order_relaxed);
+    event.category.store(category, memory_order_relaxed);
+    event.phase.store(phase, memory_order_relaxed);
+    buffer.head.store(head + 1, memory_order_release);
+}
+
+static void append_escaped(string &out, const char *s)
+{
+    for (; s && *s; s++)
+    {
+        char c = *s;
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (uint8_t(c) < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+            out += c;
+    }
+}
+
+struct Copy
+{
+    uint64_t ts;
+    const char *name;
+    const char *category;
+    char phase;
+};
+} // namespace
+
+void spvt_trace_start(void)
+{
+    recording.store(true, memory_order_relaxed);
+}
+
+void spvt_trace_stop(void)
+{
+    recording.store(false, memory_order_relaxed);
+}
+
+bool spvt_trace_is_recording(void)
+{
+    return recording.load(memory_order_relaxed);
+}
+
+void spvt_trace_begin(const char *name, const char *category)
+{
+    bool recorded = recording.load(memory_order_relaxed);
+    open_spans = (open_spans << 1) | (recorded ? 1 : 0);
+    open_depth++;
+    if (recorded)
+        record('B', name, category);
+}
+
+void spvt_trace_end(void)
+{
+    if (open_depth == 0)
+        return;
+
+    // A span which began while recording is ended even if recording has stopped, so the trace stays balanced.
+    // Spans nested deeper than 64 are ended if recording.
+    bool recorded = open_depth > 64 ? recording.load(memory_order_relaxed) : (open_spans & 1) != 0;
+    open_spans >>= 1;
+    open_depth--;
+    if (recorded)
+        record('E', nullptr, nullptr);
+}
+
+const char *spvt_trace_intern(const char *name)
+{
+    auto &r = registry();
+    lock_guard<mutex> holder(r.strings_lock);
+    return r.strings.insert(name ? name : "").first->c_str();
+}
+
+void spvt_trace_set_thread_name(const char *name)
+{
+    auto &buffer = get_thread_buffer();
+    auto &r = registry();
+    lock_guard<mutex> holder(r.lock);
+    buffer.name = name ? name : "";
+}
+
+void spvt_trace_flush_json(spvt_trace_writer_t writer, void *userdata)
+{
+    if (!writer)
+        return;
+
+    auto &r = registry();
+    lock_guard<mutex> flush_holder(r.flush_lock);
+
+    vector<ThreadBuffer *> buffers;
+    vector<string> names;
+    {
+        lock_guard<mutex> holder(r.lock);
+        for (auto &buffer : r.buffers)
+        {
+            buffers.push_back(buffer.get());
+            names.push_back(buffer->name);
+        }
+    }
+
+    const int pid = int(getpid());
+    string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto begin_event = [&]() {
+        if (!first)
+            out += ',';
+        first = false;
+    };
+
+    vector<Copy> events;
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        auto &buffer = *buffers[i];
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "\"pid\":%d,\"tid\":%u", pid, buffer.tid);
+
+        if (!names[i].empty())
+        {
+            begin_event();
+            out += "{\"name\":\"thread_name\",\"ph\":\"M\",";
+            out += prefix;
+            out += ",\"args\":{\"name\":\"";
+            append_escaped(out, names[i].c_str());
+            out += "\"}}";
+        }
+
+        uint64_t head = buffer.head.load(memory_order_acquire);
+        uint64_t start = max(buffer.tail, head > SPVT_TRACE_BUFFER_CAPACITY ? head - SPVT_TRACE_BUFFER_CAPACITY : 0);
+        events.clear();
+        for (uint64_t index = start; index < head; index++)
+        {
+            auto &event = buffer.events[index % SPVT_TRACE_BUFFER_CAPACITY];
+            events.push_back({ event.ts.load(memory_order_relaxed), event.name.load(memory_order_relaxed),
+                               event.category.load(memory_order_relaxed), event.phase.load(memory_order_relaxed) });
+        }
+
+        // Drop the events the owner may have overwritten while they were copied,
+        // including the slot of the event it may be writing now.
+        uint64_t after = buffer.head.load(memory_order_acquire);
+        uint64_t valid = after >= SPVT_TRACE_BUFFER_CAPACITY ? after - SPVT_TRACE_BUFFER_CAPACITY + 1 : 0;
+        size_t skip = valid > start ? size_t(min(valid - start, uint64_t(events.size()))) : 0;
+        buffer.tail = head;
+
+        for (size_t j = skip; j < events.size(); j++)
+        {
+            auto &event = events[j];
+            char ts[64];
+            snprintf(ts, sizeof(ts), "\"ts\":%llu.%03llu,", (unsigned long long)(event.ts / 1000),
+                     (unsigned long long)(event.ts % 1000));
+
+            begin_event();
+            out += "{";
+            if (event.phase == 'B')
+            {
+                out += "\"name\":\"";
+                append_escaped(out, event.name);
+                out += "\",\"cat\":\"";
+                append_escaped(out, event.category);
+                out += "\",";
+            }
+            out += "\"ph\":\"";
+            out += event.phase;
+            out += "\",";
+            out += ts;
+            out += prefix;
+            out += "}";
+
+            // Hand the JSON to the writer in pieces, rather than holding every event.
+            if (out.size() >= 64 * 1024)
+            {
+                writer(userdata, out.data(), out.size());
+                out.clear();
+            }
+        }
+    }
+
+    out += "]}\n";
+    writer(userdata, out.data(), out.size());
+}
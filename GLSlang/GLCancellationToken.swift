@@ -0,0 +1,48 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import Foundation
+import CGLSLang
+
+/// Stops a preprocess, parse or link when cancelled. It is checked between phases and
+/// as each `#include` is resolved.
+public final class GLCancellationToken {
+    let token: OpaquePointer
+    
+    public init() {
+        guard let token = glslang_cancel_token_create() else {
+            fatalError("Out of memory")
+        }
+        self.token = token
+    }
+    
+    deinit {
+        glslang_cancel_token_delete(token)
+    }
+    
+    /// Cancels the compiles using the token. May be called from any thread.
+    public func cancel() {
+        glslang_cancel_token_cancel(token)
+    }
+    
+    public var isCancelled: Bool {
+        glslang_cancel_token_is_cancelled(token)
+    }
+}
@@ -82,6 +82,21 @@ extension glslang_input_s {
             resource: glslang_get_default_resource(),
             includer_type: .forbid,
             callbacks: .init(),
-            callbacks_ctx: nil)
+            callbacks_ctx: nil,
+            cancel_token: nil,
+            deadline: 0,
+            segments: nil,
+            segment_count: 0)
+    }
+    
+    /// Sets the deadline `timeout` seconds from now. A timeout which is `nil`, infinite or not
+    /// a number sets no deadline, and one too long to represent waits as long as possible.
+    mutating func setDeadline(timeout: TimeInterval?) {
+        guard let timeout = timeout, timeout.isFinite else {
+            deadline = 0
+            return
+        }
+        let nanoseconds = max(timeout, 0) * 1_000_000_000
+        deadline = glslang_deadline_after(nanoseconds < Double(UInt64.max) ? UInt64(nanoseconds) : .max)
     }
 }
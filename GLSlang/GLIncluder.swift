@@ -0,0 +1,124 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import Foundation
+import CGLSLang
+
+/// Resolves `#include` directives from the file system, and records every file a compile
+/// read or looked for, so a change to any of them can trigger a recompile.
+///
+/// `#include "file"` is resolved relative to the including file, and then to each of the
+/// search paths. `#include <file>` is resolved against the search paths only. An includer
+/// may be used by a compile on another thread.
+public final class GLIncluder {
+    /// The path of the shader, which `#include "file"` is relative to.
+    public let path: String?
+    public let searchPaths: [String]
+    
+    let lock = NSLock()
+    var files = Set<String>()
+    
+    public init(path: String? = nil, searchPaths: [String] = []) {
+        self.path = path.map { ($0 as NSString).standardizingPath }
+        self.searchPaths = searchPaths
+    }
+    
+    /// The standardized paths of the shader and the headers it included or looked for.
+    public var dependencies: Set<String> {
+        lock.lock()
+        defer { lock.unlock() }
+        var files = self.files
+        if let path = path {
+            files.insert(path)
+        }
+        return files
+    }
+    
+    func resolve(_ header: String, includer: String, system: Bool) -> (path: String, data: Data)? {
+        // glslang retries a local include it could not find as a system include.
+        var candidates = [String]()
+        if header.hasPrefix("/") {
+            candidates.append(header)
+        } else if !system {
+            // The shader itself is named "" by glslang, and included files by the path returned for them.
+            if let base = includer.isEmpty ? path : includer {
+                candidates.append(((base as NSString).deletingLastPathComponent as NSString).appendingPathComponent(header))
+            }
+        } else {
+            candidates = searchPaths.map { ($0 as NSString).appendingPathComponent(header) }
+        }
+        
+        for candidate in candidates {
+            let path = (candidate as NSString).standardizingPath
+            lock.lock()
+            files.insert(path)
+            lock.unlock()
+            if let data = FileManager.default.contents(atPath: path) {
+                return (path, data)
+            }
+        }
+        return nil
+    }
+    
+    /// Installs the includer's callbacks, which reference it without retaining it.
+    func install(in input: inout glslang_input_s) {
+        input.includer_type = .custom
+        input.callbacks = glsl_include_callbacks_t(
+            include_system: { ctx, header, includer, _ in
+                GLIncluder.include(ctx, header, includer, system: true)
+            },
+            include_local: { ctx, header, includer, _ in
+                GLIncluder.include(ctx, header, includer, system: false)
+            },
+            free_include_result: { _, result in
+                GLIncluder.release(result)
+                return 0
+            })
+        input.callbacks_ctx = Unmanaged.passUnretained(self).toOpaque()
+    }
+    
+    static func include(_ ctx: UnsafeMutableRawPointer?, _ header: UnsafePointer<CChar>?, _ includer: UnsafePointer<CChar>?,
+                        system: Bool) -> UnsafeMutablePointer<glsl_include_result_t>? {
+        let this = Unmanaged<GLIncluder>.fromOpaque(ctx!).takeUnretainedValue()
+        guard let header = header,
+              let (path, data) = this.resolve(String(cString: header), includer: includer.map { String(cString: $0) } ?? "",
+                                              system: system)
+        else {
+            return nil
+        }
+        
+        let buffer = UnsafeMutablePointer<CChar>.allocate(capacity: max(data.count, 1))
+        data.withUnsafeBytes { bytes in
+            if let base = bytes.baseAddress {
+                UnsafeMutableRawPointer(buffer).copyMemory(from: base, byteCount: bytes.count)
+            }
+        }
+        let result = UnsafeMutablePointer<glsl_include_result_t>.allocate(capacity: 1)
+        result.initialize(to: glsl_include_result_t(header_name: strdup(path), header_data: buffer, header_length: data.count))
+        return result
+    }
+    
+    static func release(_ result: UnsafeMutablePointer<glsl_include_result_t>?) {
+        guard let result = result else { return }
+        free(UnsafeMutablePointer(mutating: result.pointee.header_name))
+        UnsafeMutablePointer(mutating: result.pointee.header_data)?.deallocate()
+        result.deallocate()
+    }
+}
@@ -23,11 +23,19 @@ import CGLSLang
 
 public class GLProgram {
     public enum ProgramError: Error {
-        case link, noStage
+        case link, noStage, cancelled, deadlineExceeded, compile, reflection
+        /// The program's intermediates were released, so it can no longer link or generate SPIR-V.
+        case released
     }
     
     let program = CGLSLangProgram()
     
+    // The program links the shaders, and checks their cancellation tokens.
+    var shaders: [GLShader] = []
+    
+    // Set by releaseIntermediates, after which the C program ignores links and generation.
+    var released = false
+    
     public init() {}
     
     deinit {
@@ -36,22 +44,89 @@ public class GLProgram {
     
     public func add(shader: GLShader) {
         program.add_shader(shader.shader)
+        shaders.append(shader)
     }
     
     public func link(messages: GLMessageOptions = [.vulkanRules, .spvRules]) throws {
-        guard program.link(messages: messages) else { throw ProgramError.link }
+        guard !released else { throw ProgramError.released }
+        guard program.link(messages: messages) else { throw error(.link) }
+    }
+    
+    /// Compiles a source holding several stages, each beginning at a `#pragma stage` line,
+    /// such as a `.slang` shader, in place of adding shaders and linking them.
+    ///
+    /// The source is preprocessed once, as `stage`, and its stages are parsed concurrently.
+    /// May be called once per program; a second call throws `ProgramError.compile`.
+    ///
+    /// - Returns: The stages of the source.
+    @discardableResult
+    public func compileStages(source: String, stage: GLStage = .vertex,
+                              input: GLEnvironmentInput = GLEnvironmentInput(),
+                              client: GLEnvironmentClient = GLEnvironmentClient(),
+                              target: GLEnvironmentTarget = GLEnvironmentTarget(),
+                              messages: GLMessageOptions = [.vulkanRules, .spvRules],
+                              includer: GLIncluder? = nil,
+                              cancellation: GLCancellationToken? = nil,
+                              timeout: TimeInterval? = nil) throws -> GLStageOptions {
+        guard !released else { throw ProgramError.released }
+        _ = initialized
+        let compiled: Bool = source.withCString { code in
+            var input = glslang_input_s(stage: stage, input: input, client: client, target: target, code: code, messages: messages)
+            includer?.install(in: &input)
+            input.cancel_token = cancellation?.token
+            input.setDeadline(timeout: timeout)
+            return program.compile_stages(input: &input)
+        }
+        guard compiled else { throw error(.compile) }
+        return program.stages
+    }
+    
+    func error(_ failure: ProgramError) -> ProgramError {
+        switch program.status {
+        case .cancelled:
+            return .cancelled
+        case .deadlineExceeded:
+            return .deadlineExceeded
+        default:
+            return failure
+        }
     }
     
     public var infoLog: String { String(cString: program.info_log) }
     public var debugLog: String { String(cString: program.info_debug_log) }
     
+    /// Generates the SPIR-V of a stage.
+    ///
+    /// - Throws: `ProgramError.released` once `releaseIntermediates()` has been called.
     public func generate(stage: GLStage) throws -> Data {
+        guard !released else { throw ProgramError.released }
         program.spirv_generate(stage: stage)
         let size = program.spirv_size * MemoryLayout<UInt32>.size
         return program.spirv_pointer.withMemoryRebound(to: UInt8.self, capacity: size) { bytes in
             Data(bytes: bytes, count: size)
         }
     }
+    
+    /// Frees the parsed and linked shaders, keeping the generated SPIR-V and the logs.
+    /// The program can no longer link or generate SPIR-V, and `generate(stage:)` throws.
+    public func releaseIntermediates() {
+        program.release_intermediates()
+        shaders = []
+        released = true
+    }
+    
+    /// Generates SPIR-V for each stage of a program compiled by `compileStages`.
+    /// Once the intermediates are released, returns the SPIR-V generated before.
+    public func generateStages() -> [GLStage: Data] {
+        program.spirv_generate_stages(options: nil)
+        var result: [GLStage: Data] = [:]
+        for stage in [GLStage.vertex, .tessControl, .tessEvaluation, .geometry, .fragment, .compute] {
+            let size = program.spirv_stage_size(stage: stage) * MemoryLayout<UInt32>.size
+            guard size > 0, let words = program.spirv_stage_pointer(stage: stage) else { continue }
+            result[stage] = Data(bytes: words, count: size)
+        }
+        return result
+    }
 }
 
 public struct GLCompiledProgram {
@@ -0,0 +1,80 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import Foundation
+import CGLSLang
+
+/// An object in the reflection of a linked program, as `TObjectReflection` describes it.
+public struct GLReflectionObject {
+    public let name: String
+    public let offset: Int
+    public let glDefineType: Int
+    /// The data size of a block, or the array size of an object which is an array.
+    public let size: Int
+    /// The block of a member, or the index of a block.
+    public let index: Int
+    public let numMembers: Int
+    public let arrayStride: Int
+    public let topLevelArraySize: Int
+    public let topLevelArrayStride: Int
+    /// The layout qualifiers of the object, or `nil` where not declared.
+    public let binding: Int?
+    public let set: Int?
+    public let location: Int?
+    public let stages: GLStageOptions
+    
+    init(_ object: glslang_reflection_object_s) {
+        name = String(cString: object.name)
+        offset = Int(object.offset)
+        glDefineType = Int(object.gl_define_type)
+        size = Int(object.size)
+        index = Int(object.index)
+        numMembers = Int(object.num_members)
+        arrayStride = Int(object.array_stride)
+        topLevelArraySize = Int(object.top_level_array_size)
+        topLevelArrayStride = Int(object.top_level_array_stride)
+        binding = object.binding >= 0 ? Int(object.binding) : nil
+        set = object.set >= 0 ? Int(object.set) : nil
+        location = object.location >= 0 ? Int(object.location) : nil
+        stages = object.stages
+    }
+}
+
+extension GLProgram {
+    /// Builds the reflection of the linked program from its AST, so its layout can be read
+    /// without generating SPIR-V.
+    public func buildReflection(options: GLReflectionOptions = .default) throws {
+        guard program.build_reflection(options: Int32(options.rawValue)) else { throw ProgramError.reflection }
+    }
+    
+    /// The objects of `kind` found by `buildReflection`.
+    public func reflection(_ kind: GLReflectionKind) -> [GLReflectionObject] {
+        let count = program.reflection_count(kind: kind)
+        guard count > 0, let objects = program.reflection(kind: kind) else { return [] }
+        return UnsafeBufferPointer(start: objects, count: count).map(GLReflectionObject.init)
+    }
+    
+    /// The workgroup size of a compute stage, found by `buildReflection`.
+    public var localSize: (x: Int, y: Int, z: Int) {
+        (Int(program.reflection_local_size(dim: 0)),
+         Int(program.reflection_local_size(dim: 1)),
+         Int(program.reflection_local_size(dim: 2)))
+    }
+}
@@ -28,19 +28,30 @@ var initialized: Bool = {
 
 public class GLShader {
     public enum ShaderError: Error {
-        case preprocess, parse
+        /// No longer thrown, as `parse` preprocesses and parses in a single pass and
+        /// reports either failure as `parse`. Kept so existing catches still compile.
+        case preprocess
+        case parse, cancelled, deadlineExceeded
     }
     
     let source: String
     var input: glslang_input_s
     let shader: CGLSLangShader
     
+    // Retained for the program, which checks the token as it links.
+    var cancellation: GLCancellationToken?
+    
+    /// Resolves the shader's includes, or `nil` to forbid them.
+    public let includer: GLIncluder?
+    
     public init(source: String, stage: GLStage,
                 input: GLEnvironmentInput = GLEnvironmentInput(),
                 client: GLEnvironmentClient = GLEnvironmentClient(),
-                target: GLEnvironmentTarget = GLEnvironmentTarget()) {
+                target: GLEnvironmentTarget = GLEnvironmentTarget(),
+                includer: GLIncluder? = nil) {
         _ = initialized
         self.source = source
+        self.includer = includer
         self.input = source.withCString { str -> glslang_input_s in
             glslang_input_s(
                 language: input.language,
@@ -58,15 +69,42 @@ public class GLShader {
                 resource: glslang_get_default_resource(),
                 includer_type: .forbid,
                 callbacks: .init(),
-                callbacks_ctx: nil)
+                callbacks_ctx: nil,
+                cancel_token: nil,
+                deadline: 0,
+                segments: nil,
+                segment_count: 0)
         }
+        includer?.install(in: &self.input)
         shader = CGLSLangShader(input: &self.input)
     }
     
-    public func parse(messages: GLMessageOptions = []) throws {
+    /// Preprocesses and parses the shader in a single pass.
+    ///
+    /// - Parameters:
+    ///   - cancellation: A token which stops the shader, and any program it is added to.
+    ///   - timeout: The longest time the shader and the link of its program may take, in seconds.
+    public func parse(messages: GLMessageOptions = [], cancellation: GLCancellationToken? = nil, timeout: TimeInterval? = nil) throws {
         input.messages = messages
-        guard shader.preprocess(input: &input) else { throw ShaderError.preprocess }
-        guard shader.parse(input: &input) else { throw ShaderError.parse }
+        self.cancellation = cancellation
+        input.cancel_token = cancellation?.token
+        input.setDeadline(timeout: timeout)
+        let compiled = source.withCString { code -> Bool in
+            input.code = code
+            return shader.compile(input: &input)
+        }
+        guard compiled else { throw error(.parse) }
+    }
+    
+    func error(_ failure: ShaderError) -> ShaderError {
+        switch shader.status {
+        case .cancelled:
+            return .cancelled
+        case .deadlineExceeded:
+            return .deadlineExceeded
+        default:
+            return failure
+        }
     }
     
     public var infoLog: String {
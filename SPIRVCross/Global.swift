@@ -32,3 +32,9 @@ extension Bool {
         self ? SPVC_TRUE : SPVC_FALSE
     }
 }
+
+extension __spvc_bool {
+    var boolValue: Bool {
+        self != SPVC_FALSE
+    }
+}
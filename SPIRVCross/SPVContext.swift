@@ -23,6 +23,7 @@ import CSPIRVCross
 
 public final class SPVContext {
     let ctx: __SPVContext
+    let arena: __SPVContextArena?
 
     public init() {
         var ctx: __SPVContext?
@@ -30,12 +31,32 @@ public final class SPVContext {
             fatalError("Out of memory")
         }
         self.ctx = ctx!
+        self.arena = nil
+    }
+    
+    /// Creates a context whose objects can be released with `reset()`, so that a
+    /// long-lived worker can compile many shaders at flat memory.
+    public init(resettable: Bool) {
+        guard resettable else {
+            self.init()
+            return
+        }
+        
+        var arena: __SPVContextArena?
+        if __spvc_context_arena_create(&arena).errorResult != nil {
+            fatalError("Out of memory")
+        }
+        self.arena = arena!
+        self.ctx = arena!.context
     }
     
     public func parse(data: Data) throws -> SPVParsedIR {
         var v: SPVParsedIR?
         let res = data.withUnsafeBytes { a -> SPVResult in
             let spirv = a.bindMemory(to: SpvId.self)
+            if let arena = arena {
+                return arena.parse(data: spirv.baseAddress, spirv.count, &v)
+            }
             return ctx.parse(data: spirv.baseAddress, data.count / MemoryLayout<SpvId>.size, &v)
         }
         
@@ -54,15 +75,79 @@ public final class SPVContext {
     /// - Returns: A Metal compiler
     public func makeMetalCompiler(ir: SPVParsedIR, captureMode: SPVCaptureMode = .takeOwnership) throws -> SPVMetalCompiler {
         var c: SPVCompiler?
-        if let res = ctx.create_compiler(backend: .msl, ir: ir, captureMode: captureMode, compiler: &c).errorResult {
+        let res: SPVResult
+        if let arena = arena {
+            res = arena.create_compiler(backend: .msl, ir: ir, captureMode: captureMode, compiler: &c)
+        } else {
+            res = ctx.create_compiler(backend: .msl, ir: ir, captureMode: captureMode, compiler: &c)
+        }
+        if let res = res.errorResult {
             throw res
         }
-        return SPVMetalCompiler(compiler: c!)
+        return SPVMetalCompiler(compiler: c!, arena: arena)
+    }
+    
+    /// Releases every object created by a resettable context, such as parsed IR,
+    /// compilers and compiled source. Any that are still referenced become invalid.
+    public func reset() {
+        guard let arena = arena else {
+            preconditionFailure("Only a resettable context can be reset")
+        }
+        arena.reset()
+    }
+    
+    /// The object counts and tracked byte proxies of a resettable context, or `nil`.
+    public var statistics: Statistics? {
+        guard let arena = arena else { return nil }
+        var stats = __spvc_context_arena_stats()
+        arena.get_stats(&stats)
+        return Statistics(stats)
     }
     
     deinit {
         // TODO: This is not safe if there are references to child objects
         print("destroying SPVContext")
-        ctx.destroy()
+        if let arena = arena {
+            arena.destroy()
+        } else {
+            ctx.destroy()
+        }
+    }
+}
+
+extension SPVContext {
+    public struct Statistics {
+        /// Bytes of SPIR-V and generated source created since the last reset. This is a proxy
+        /// for the memory the context retains, not the bytes SPIRV-Cross allocates.
+        public let trackedSPIRVAndSourceBytes: Int
+        /// The highest `trackedSPIRVAndSourceBytes` reached since the context was created.
+        public let peakTrackedSPIRVAndSourceBytes: Int
+        public let resetCount: Int
+        
+        /// Objects of each kind created since the last reset.
+        public let liveCount: [SPVContextArenaObject: Int]
+        /// Objects of each kind created since the context was created.
+        public let allocationCount: [SPVContextArenaObject: Int]
+        
+        init(_ stats: __spvc_context_arena_stats) {
+            trackedSPIRVAndSourceBytes = stats.tracked_spirv_and_source_bytes
+            peakTrackedSPIRVAndSourceBytes = stats.peak_tracked_spirv_and_source_bytes
+            resetCount = stats.reset_count
+            
+            var stats = stats
+            let count = Int(SPVContextArenaObject.count.rawValue)
+            liveCount = withUnsafeBytes(of: &stats.live_count) { buf in
+                Self.counts(buf.bindMemory(to: Int.self).prefix(count))
+            }
+            allocationCount = withUnsafeBytes(of: &stats.allocation_count) { buf in
+                Self.counts(buf.bindMemory(to: Int.self).prefix(count))
+            }
+        }
+        
+        static func counts<C: Collection>(_ values: C) -> [SPVContextArenaObject: Int] where C.Element == Int {
+            Dictionary(uniqueKeysWithValues: values.enumerated().map { i, v in
+                (SPVContextArenaObject(rawValue: UInt32(i))!, v)
+            })
+        }
     }
 }
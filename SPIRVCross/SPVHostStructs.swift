@@ -0,0 +1,37 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+extension SPVMetalCompiler {
+    /// Returns C++ or Swift structs of the shader's uniform and push-constant blocks, whose members
+    /// sit at the offsets of the SPIR-V, so parameter updates can write fields without looking up offsets.
+    ///
+    /// The C++ structs check their layout with `static_assert`. Each Swift struct has an
+    /// `isLayoutValid` property, to check from a test.
+    public func hostStructs(language: SPVHostStructLanguage) throws -> String {
+        var data = Data()
+        try SPVWriteSink.write(to: { data.append(contentsOf: $0) }) { callback, userdata in
+            compiler.emit_host_structs(language: language, callback, userdata)
+        }
+        return String(decoding: data, as: UTF8.self)
+    }
+}
@@ -25,6 +25,7 @@ import Metal
 @frozen
 public struct SPVMetalCompiler {
     let compiler: SPVCompiler
+    let arena: __SPVContextArena?
     
     public var isRasterizationDisabled: Bool { compiler.isMslRasterizationDisabled }
     public var needsSwizzleBuffer: Bool { compiler.mslNeedsSwizzleBuffer }
@@ -56,7 +57,8 @@ public struct SPVMetalCompiler {
     
     public func makeOptions() -> Self.Options {
         var options: SPVCompilerOptions?
-        if compiler.create_compiler_options(&options).errorResult != nil {
+        let res = arena?.create_compiler_options(compiler: compiler, &options) ?? compiler.create_compiler_options(&options)
+        if res.errorResult != nil {
             fatalError("Out of memory")
         }
         return Self.Options(options: options!)
@@ -64,26 +66,89 @@ public struct SPVMetalCompiler {
 
     public func makeResources() -> SPVResources {
         var resources: SPVResources?
-        if compiler.create_shader_resources(&resources).errorResult != nil {
+        let res = arena?.create_shader_resources(compiler: compiler, &resources) ?? compiler.create_shader_resources(&resources)
+        if res.errorResult != nil {
             fatalError("Out of memory")
         }
         
         return resources!
     }
-    
+
+    /// Captures all resources, decorations, struct layouts and active buffer ranges
+    /// in a single call, rather than querying them individually.
+    public func makeReflectionSnapshot() throws -> SPVReflectionSnapshot {
+        var snapshot: UnsafePointer<__spvc_reflection_snapshot>?
+        if let res = compiler.get_reflection_snapshot(&snapshot).errorResult {
+            throw res
+        }
+        return SPVReflectionSnapshot(data: snapshot!)
+    }
+
+    /// Packs every uniform and push-constant block to its active range.
+    /// See `SPVVariable.packActiveBufferRange()`.
+    ///
+    /// - Returns: The upload range of each block, keyed by variable.
+    public func packActiveBufferRanges() throws -> [SPVVariableID: SPVBufferPacking] {
+        let resources = makeResources()
+        var result = [SPVVariableID: SPVBufferPacking]()
+        for resource in resources.uniformBuffers + resources.pushConstants {
+            guard let variable = getVariable(resource: resource) else { continue }
+            result[resource.id] = try variable.packActiveBufferRange()
+        }
+        return result
+    }
+
     public func compile() throws -> String {
         var src: UnsafePointer<Int8>?
-        if let res = compiler.compile(&src).errorResult {
+        let res = arena?.compile(compiler: compiler, &src) ?? compiler.compile_traced(&src)
+        if let res = res.errorResult {
             throw res
         }
         return String(cString: src!)
     }
+
+    /// Compiles the shader and captures the reflection data in the same call,
+    /// so that the snapshot can be persisted alongside the MSL.
+    public func compileWithReflection() throws -> (source: String, reflection: SPVReflectionSnapshot) {
+        var src: UnsafePointer<Int8>?
+        var snapshot: UnsafePointer<__spvc_reflection_snapshot>?
+        if let res = compiler.compile_with_reflection(&src, &snapshot).errorResult {
+            throw res
+        }
+        return (String(cString: src!), SPVReflectionSnapshot(data: snapshot!))
+    }
     
     public func compile(options: Self.Options) throws -> String {
         options.apply(to: compiler)
         return try compile()
     }
     
+    /// Compiles the shader and passes the MSL to `sink` in chunks of at most `chunkSize` bytes,
+    /// so it can be written to a file or socket without first being copied into a `String`.
+    ///
+    /// The whole MSL is generated before the first chunk is passed, so this saves a copy
+    /// but does not lower the peak memory of compiling.
+    public func compile(options: Self.Options, chunkSize: Int = 64 * 1024, to sink: (UnsafeRawBufferPointer) throws -> Void) throws {
+        options.apply(to: compiler)
+        try SPVWriteSink.write(to: sink) { callback, userdata in
+            compiler.compile_to_callback(callback, userdata, chunkSize)
+        }
+    }
+    
+    /// Removes the outputs of the `vertex` shader which the `fragment` shader does not read,
+    /// and the inputs the `fragment` shader declares but does not read.
+    ///
+    /// Must be called before either shader is compiled.
+    /// - Returns: The number of vertex outputs which were removed.
+    @discardableResult
+    public static func pruneStageInterface(vertex: SPVMetalCompiler, fragment: SPVMetalCompiler) throws -> Int {
+        var count = 0
+        if let res = vertex.compiler.prune_stage_interface(fragment: fragment.compiler, &count).errorResult {
+            throw res
+        }
+        return count
+    }
+    
     public func getType(id: SPVTypeID) -> SPVType? {
         guard let type = compiler.get_type_handle(id) else { return nil }
         return SPVType(compiler: compiler, type: type)
@@ -124,12 +189,17 @@ extension SPVMetalCompiler {
     
     @frozen
     public struct Options {
-        let options: SPVCompilerOptions
+        let options: SPVCompilerOptions?
         
         init(options: SPVCompilerOptions) {
             self.options  = options
         }
         
+        /// Creates options which are not bound to a compiler, such as for keying an `SPVMetalCompilerCache`.
+        public init() {
+            self.options = nil
+        }
+        
         // MARK: Common Options
         
         /// Debug option to always emit temporary variables for all expressions.
@@ -340,24 +410,57 @@ extension SPVMetalCompiler {
             (SPVC_COMPILER_OPTION_MSL_FIXED_SUBGROUP_SIZE, \.fixedSubgroupSize),
         ]
         
-        func apply(to compiler: SPVCompiler) {
+        /// The buffer index options, which can change without recompiling an `SPVMetalRebindTemplate`.
+        static let mslBufferIndices: [(spvc_compiler_option, KeyPath<Self, UInt32>)] = [
+            (SPVC_COMPILER_OPTION_MSL_SWIZZLE_BUFFER_INDEX, \.swizzleBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_INDIRECT_PARAMS_BUFFER_INDEX, \.indirectParamsBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_SHADER_OUTPUT_BUFFER_INDEX, \.shaderOutputBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_SHADER_PATCH_OUTPUT_BUFFER_INDEX, \.shaderPatchOutputBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_SHADER_TESS_FACTOR_OUTPUT_BUFFER_INDEX, \.shaderTessFactorOutputBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_BUFFER_SIZE_BUFFER_INDEX, \.bufferSizeBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_VIEW_MASK_BUFFER_INDEX, \.viewMaskBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_DYNAMIC_OFFSETS_BUFFER_INDEX, \.dynamicOffsetsBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_SHADER_INPUT_BUFFER_INDEX, \.shaderInputBufferIndex),
+            (SPVC_COMPILER_OPTION_MSL_SHADER_INDEX_BUFFER_INDEX, \.shaderIndexBufferIndex),
+        ]
+        
+        func forEachValue(bool: (spvc_compiler_option, __spvc_bool) -> Void, uint: (spvc_compiler_option, UInt32) -> Void) {
             for (option, kp) in Self.commonBools {
-                options.set_bool(option: option, with: self[keyPath: kp].spvcBoolValue)
+                bool(option, self[keyPath: kp].spvcBoolValue)
             }
 
-            options.set_uint(option: SPVC_COMPILER_OPTION_MSL_PLATFORM, with: platform.spvcPlatform)
-            options.set_uint(option: SPVC_COMPILER_OPTION_MSL_VERSION, with: version.spvcMetalVersion)
-            options.set_uint(option: SPVC_COMPILER_OPTION_MSL_VERTEX_INDEX_TYPE, with: vertexIndexType.spvcIndexType)
+            uint(SPVC_COMPILER_OPTION_MSL_PLATFORM, platform.spvcPlatform)
+            uint(SPVC_COMPILER_OPTION_MSL_VERSION, version.spvcMetalVersion)
+            uint(SPVC_COMPILER_OPTION_MSL_VERTEX_INDEX_TYPE, vertexIndexType.spvcIndexType)
             
             for (option, kp) in Self.mslBools {
-                options.set_bool(option: option, with: self[keyPath: kp].spvcBoolValue)
+                bool(option, self[keyPath: kp].spvcBoolValue)
             }
             
             for (option, kp) in Self.mslUInt32s {
-                options.set_uint(option: option, with: self[keyPath: kp])
+                uint(option, self[keyPath: kp])
+            }
+        }
+        
+        /// Returns the options with the values of this struct set, without installing them.
+        func makeCompilerOptions(for compiler: SPVCompiler) -> SPVCompilerOptions {
+            var options = self.options
+            if options == nil, compiler.create_compiler_options(&options).errorResult != nil {
+                fatalError("Out of memory")
             }
             
-            compiler.install_compiler_options(options: options)
+            forEachValue(bool: { options!.set_bool(option: $0, with: $1) },
+                         uint: { options!.set_uint(option: $0, with: $1) })
+            return options!
+        }
+        
+        func apply(to compiler: SPVCompiler) {
+            compiler.install_compiler_options(options: makeCompilerOptions(for: compiler))
+        }
+        
+        func apply(to key: __SPVMSLCacheKey) {
+            forEachValue(bool: { key.set_bool(option: $0, with: $1) },
+                         uint: { key.set_uint(option: $0, with: $1) })
         }
     }
 }
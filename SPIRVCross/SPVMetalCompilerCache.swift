@@ -0,0 +1,127 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// Caches the MSL and `msl_needs_*` flags compiled from SPIR-V, keyed by a digest of
+/// the module, the compiler options and the installed resource bindings and vertex attributes.
+///
+/// A cache hit does not parse the module or create a compiler. The cache can be
+/// persisted with `serializedData()`, so that later launches skip compilation entirely,
+/// unless they use another version of SPIRV-Cross.
+public final class SPVMetalCompilerCache {
+    let cache: __SPVMSLCache
+    
+    public init() {
+        var cache: __SPVMSLCache?
+        if __spvc_msl_cache_create(&cache).errorResult != nil {
+            fatalError("Out of memory")
+        }
+        self.cache = cache!
+    }
+    
+    /// Creates a cache with the entries of a previous call to `serializedData()`.
+    public convenience init(data: Data) throws {
+        self.init()
+        let res = data.withUnsafeBytes { buf in
+            cache.load(data: buf.baseAddress, size: buf.count)
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+    }
+    
+    deinit {
+        cache.destroy()
+    }
+    
+    public struct Result {
+        public let source: String
+        public let isRasterizationDisabled: Bool
+        public let needsSwizzleBuffer: Bool
+        public let needsBufferSizeBuffer: Bool
+        public let needsOutputBuffer: Bool
+        public let needsPatchOutputBuffer: Bool
+        public let needsInputThreadgroupMem: Bool
+        
+        init(_ entry: __spvc_msl_cache_entry) {
+            source = String(cString: entry.source)
+            isRasterizationDisabled = entry.is_rasterization_disabled.boolValue
+            needsSwizzleBuffer = entry.needs_swizzle_buffer.boolValue
+            needsBufferSizeBuffer = entry.needs_buffer_size_buffer.boolValue
+            needsOutputBuffer = entry.needs_output_buffer.boolValue
+            needsPatchOutputBuffer = entry.needs_patch_output_buffer.boolValue
+            needsInputThreadgroupMem = entry.needs_input_threadgroup_mem.boolValue
+        }
+    }
+    
+    /// Returns the cached MSL for the inputs, or compiles and caches it using `context`.
+    public func compile(spirv: Data,
+                        options: SPVMetalCompiler.Options,
+                        resourceBindings: [spvc_msl_resource_binding] = [],
+                        vertexAttributes: [spvc_msl_vertex_attribute] = [],
+                        context: SPVContext) throws -> Result {
+        var key: __SPVMSLCacheKey?
+        let res = spirv.withUnsafeBytes { a -> SPVResult in
+            let words = a.bindMemory(to: SpvId.self)
+            return __spvc_msl_cache_key_create(words.baseAddress, words.count, &key)
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+        defer { key!.destroy() }
+        
+        options.apply(to: key!)
+        for var binding in resourceBindings {
+            key!.add_resource_binding(&binding)
+        }
+        for var attr in vertexAttributes {
+            key!.add_vertex_attribute(&attr)
+        }
+        
+        var entry = __spvc_msl_cache_entry()
+        if cache.lookup(key: key!, entry: &entry).boolValue {
+            return Result(entry)
+        }
+        
+        let compiler = try context.makeMetalCompiler(ir: try context.parse(data: spirv))
+        if let res = cache.compile(key: key!, compiler: compiler.compiler, entry: &entry).errorResult {
+            throw res
+        }
+        return Result(entry)
+    }
+    
+    /// Encodes all entries of the cache, to be restored with `init(data:)`.
+    public func serializedData() throws -> Data {
+        var size = 0
+        if let res = cache.serialize(buffer: nil, size: &size).errorResult {
+            throw res
+        }
+        var data = Data(count: size)
+        let res = data.withUnsafeMutableBytes { buf in
+            cache.serialize(buffer: buf.baseAddress, size: &size)
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+        return data
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// Merges the MSL of many shaders into a single source, so they can be built into one Metal library.
+///
+/// Helper templates and headers shared by the shaders are emitted once, and entry points,
+/// structs, functions and constants, including the workgroup size, are renamed with a prefix
+/// unique to each shader.
+public final class SPVMetalLibraryBuilder {
+    public enum BuildError: Error {
+        /// Two shaders declare a function constant or spv* helper differently.
+        /// The associated value names the declaration and the prefixes of both shaders.
+        case conflict(String)
+    }
+    
+    let builder: __SPVMSLLibraryBuilder
+    
+    public init() {
+        var builder: __SPVMSLLibraryBuilder?
+        if __spvc_msl_library_builder_create(&builder).errorResult != nil {
+            fatalError("Out of memory")
+        }
+        self.builder = builder!
+    }
+    
+    deinit {
+        builder.destroy()
+    }
+    
+    /// Compiles the shader and adds it to the library.
+    /// - Parameters:
+    ///   - compiler: A compiler which has not been compiled.
+    ///   - options: The options used to compile the shader.
+    ///   - prefix: A prefix unique in the library, which must be a valid MSL identifier.
+    /// - Returns: The name of the entry point in the library.
+    @discardableResult
+    public func add(compiler: SPVMetalCompiler, options: SPVMetalCompiler.Options, prefix: String) throws -> String {
+        options.apply(to: compiler.compiler)
+        var name: UnsafePointer<Int8>?
+        if let res = builder.add(compiler: compiler.compiler, prefix: prefix, entryPointName: &name).errorResult {
+            throw res
+        }
+        return String(cString: name!)
+    }
+    
+    /// Returns the MSL of the library.
+    public func build() throws -> String {
+        var src: UnsafePointer<Int8>?
+        if let res = builder.build(&src).errorResult {
+            if let conflict = builder.conflict {
+                throw BuildError.conflict(String(cString: conflict))
+            }
+            throw res
+        }
+        return String(cString: src!)
+    }
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// Reduces the size of MSL, so that `MTLDevice.makeLibrary(source:options:)` has less to parse.
+///
+/// Comments and insignificant whitespace are always removed.
+public enum SPVMetalMinifier {
+    public struct Options: OptionSet {
+        public let rawValue: UInt32
+        
+        public init(rawValue: UInt32) {
+            self.rawValue = rawValue
+        }
+        
+        /// Removes helper functions which are not referenced.
+        public static let unusedHelpers = Options(rawValue: SPVC_MSL_MINIFY_UNUSED_HELPERS_BIT.rawValue)
+        /// Replaces `((expr))` with `(expr)`.
+        public static let parentheses = Options(rawValue: SPVC_MSL_MINIFY_PARENTHESES_BIT.rawValue)
+        /// Renames the `_<id>` temporaries generated by SPIRV-Cross to shorter names.
+        public static let renameTemporaries = Options(rawValue: SPVC_MSL_MINIFY_RENAME_TEMPORARIES_BIT.rawValue)
+        
+        public static let all: Options = [.unusedHelpers, .parentheses, .renameTemporaries]
+    }
+    
+    public struct Statistics {
+        public let inputSize: Int
+        public let outputSize: Int
+        public let removedHelpers: Int
+        public let renamedIdentifiers: Int
+        
+        /// The number of bytes removed.
+        public var reduction: Int { inputSize - outputSize }
+    }
+    
+    /// Returns the minified `source` and the size reduction.
+    public static func minify(_ source: String, options: Options = .all) throws -> (source: String, statistics: Statistics) {
+        var data = Data()
+        var stats = __spvc_msl_minify_stats()
+        try SPVWriteSink.write(to: { data.append(contentsOf: $0) }) { callback, userdata in
+            __spvc_msl_minify(source, options.rawValue, callback, userdata, &stats)
+        }
+        let statistics = Statistics(inputSize: stats.input_size, outputSize: stats.output_size,
+                                    removedHelpers: stats.removed_helpers, renamedIdentifiers: stats.renamed_identifiers)
+        return (String(decoding: data, as: UTF8.self), statistics)
+    }
+}
+
+extension SPVMetalCompiler {
+    /// Compiles the shader and minifies the MSL.
+    public func compile(options: Self.Options, minify: SPVMetalMinifier.Options) throws -> String {
+        try SPVMetalMinifier.minify(try compile(options: options), options: minify).source
+    }
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// Recompiles a shader when only its MSL resource bindings or buffer indices change,
+/// such as `swizzleBufferIndex` or `bufferSizeBufferIndex`.
+///
+/// The shader is compiled once with placeholder indices, and `emit(options:bindings:)`
+/// substitutes the new indices into the MSL without analyzing or compiling the module again.
+public final class SPVMetalRebindTemplate {
+    let template: __SPVMSLRebindTemplate
+    
+    /// Compiles the template.
+    /// - Parameters:
+    ///   - compiler: A compiler which has not been compiled. It is consumed by the template.
+    ///   - options: The options of the compiler. The buffer indices are replaced with placeholders.
+    ///   - bindings: The resource bindings which may change.
+    public init(compiler: SPVMetalCompiler, options: SPVMetalCompiler.Options, bindings: [spvc_msl_resource_binding]) throws {
+        let indexOptions = SPVMetalCompiler.Options.mslBufferIndices.map(\.0)
+        let spvcOptions = options.makeCompilerOptions(for: compiler.compiler)
+        
+        var template: __SPVMSLRebindTemplate?
+        if let res = __spvc_msl_rebind_template_create(compiler.compiler, spvcOptions,
+                                                       indexOptions, indexOptions.count,
+                                                       bindings, bindings.count, &template).errorResult {
+            throw res
+        }
+        self.template = template!
+    }
+    
+    deinit {
+        template.destroy()
+    }
+    
+    /// Returns the MSL for the buffer indices of `options` and the MSL indices of `bindings`.
+    ///
+    /// `bindings` must have the same stages, descriptor sets and bindings as the template.
+    public func emit(options: SPVMetalCompiler.Options, bindings: [spvc_msl_resource_binding]) throws -> String {
+        let values = SPVMetalCompiler.Options.mslBufferIndices.map { options[keyPath: $0.1] }
+        var src: UnsafePointer<Int8>?
+        if let res = template.emit(indexOptionValues: values, bindings: bindings, bindingCount: bindings.count, source: &src).errorResult {
+            throw res
+        }
+        return String(cString: src!)
+    }
+    
+    /// Writes the MSL for the new indices to `sink`, one segment at a time, without assembling the source.
+    public func emit(options: SPVMetalCompiler.Options, bindings: [spvc_msl_resource_binding], to sink: (UnsafeRawBufferPointer) throws -> Void) throws {
+        let values = SPVMetalCompiler.Options.mslBufferIndices.map { options[keyPath: $0.1] }
+        try SPVWriteSink.write(to: sink) { callback, userdata in
+            template.emit(indexOptionValues: values, bindings: bindings, bindingCount: bindings.count, callback: callback, userdata: userdata)
+        }
+    }
+}
@@ -0,0 +1,238 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CGLSLang
+import CSPIRVCross
+import Foundation
+import Metal
+
+/// Compiles GLSL to SPIR-V, and optionally optimizes it and cross-compiles it to MSL,
+/// on a shared pool of worker threads.
+///
+/// The job keeps running if it is released before it completes.
+public final class SPVPipelineJob {
+    let job: __SPVPipelineJob
+
+    public struct Options: OptionSet {
+        public let rawValue: UInt32
+
+        public init(rawValue: UInt32) {
+            self.rawValue = rawValue
+        }
+
+        /// Runs the SPIRV-Tools performance passes over the SPIR-V.
+        public static let optimize = Options(rawValue: SPV_PIPELINE_OPTIMIZE_BIT.rawValue)
+        /// Cross-compiles the SPIR-V to MSL.
+        public static let msl = Options(rawValue: SPV_PIPELINE_MSL_BIT.rawValue)
+    }
+
+    public enum Priority {
+        /// Work a user is waiting on, which runs ahead of any background job.
+        case interactive
+        /// Work nobody is waiting on yet, such as warming a cache.
+        case background
+
+        var rawValue: __spv_pipeline_priority {
+            switch self {
+            case .interactive:
+                return SPV_PIPELINE_PRIORITY_INTERACTIVE
+            case .background:
+                return SPV_PIPELINE_PRIORITY_BACKGROUND
+            }
+        }
+    }
+
+    public enum Status {
+        case pending
+        case running
+        case succeeded
+        case failed
+        case cancelled
+
+        init(_ status: __spv_pipeline_status) {
+            switch status {
+            case SPV_PIPELINE_STATUS_PENDING:
+                self = .pending
+            case SPV_PIPELINE_STATUS_RUNNING:
+                self = .running
+            case SPV_PIPELINE_STATUS_SUCCEEDED:
+                self = .succeeded
+            case SPV_PIPELINE_STATUS_CANCELLED:
+                self = .cancelled
+            default:
+                self = .failed
+            }
+        }
+
+        /// Whether the job has completed.
+        public var isComplete: Bool {
+            switch self {
+            case .pending, .running:
+                return false
+            case .succeeded, .failed, .cancelled:
+                return true
+            }
+        }
+    }
+
+    public struct Result {
+        public let status: Status
+        /// The SPIR-V words, which are empty unless the job succeeded.
+        public let spirv: [UInt32]
+        /// The MSL, if requested and cross-compilation succeeded.
+        public let msl: String?
+        /// The glslang info log, followed by any optimizer or SPIRV-Cross errors.
+        public let log: String
+
+        init(_ job: __SPVPipelineJob) {
+            status = Status(job.poll())
+            var count = 0
+            if let words = job.get_spirv(&count) {
+                spirv = Array(UnsafeBufferPointer(start: words, count: count))
+            } else {
+                spirv = []
+            }
+            msl = job.get_msl().map(String.init(cString:))
+            log = String(cString: job.get_log())
+        }
+    }
+
+    // Retained by the pool until the job completes.
+    final class Completion {
+        let handler: ((Result) -> Void)?
+        let includer: GLIncluder?
+
+        init(_ handler: ((Result) -> Void)?, includer: GLIncluder?) {
+            self.handler = handler
+            self.includer = includer
+        }
+    }
+
+    init(job: __SPVPipelineJob) {
+        self.job = job
+    }
+
+    /// Queues a compile of `source`.
+    ///
+    /// - Parameters:
+    ///   - includer: Resolves the shader's includes on a pool thread, or `nil` to forbid them.
+    ///   - mslVersion: The MSL version, or `nil` for the SPIRV-Cross default.
+    ///   - completion: Called on a pool thread once the job has completed, before `wait` returns.
+    public convenience init(source: String, stage: GLStage,
+                            input: GLEnvironmentInput = .init(),
+                            client: GLEnvironmentClient = .init(),
+                            target: GLEnvironmentTarget = .init(),
+                            messages: GLMessageOptions = [],
+                            includer: GLIncluder? = nil,
+                            options: Options = [.msl],
+                            mslVersion: MTLLanguageVersion? = nil,
+                            priority: Priority = .interactive,
+                            completion: ((Result) -> Void)? = nil) throws {
+        var userdata: UnsafeMutableRawPointer?
+        var callback: spv_pipeline_callback?
+        if completion != nil || includer != nil {
+            userdata = Unmanaged.passRetained(Completion(completion, includer: includer)).toOpaque()
+            callback = { userdata, job in
+                let completion = Unmanaged<Completion>.fromOpaque(userdata!).takeRetainedValue()
+                completion.handler?(Result(job!))
+            }
+        }
+
+        var job: __SPVPipelineJob?
+        let res: SPVResult = source.withCString { code in
+            var input = glslang_input_s(stage: stage, input: input, client: client, target: target, code: code, messages: messages)
+            includer?.install(in: &input)
+            return withUnsafePointer(to: &input) { input in
+                var request = __spv_pipeline_request(input: input, flags: options.rawValue,
+                                                     msl_version: mslVersion?.spvcMetalVersion ?? 0,
+                                                     priority: priority.rawValue)
+                return __spv_pipeline_compile_async(&request, callback, userdata, &job)
+            }
+        }
+        if let res = res.errorResult {
+            if let userdata = userdata {
+                Unmanaged<Completion>.fromOpaque(userdata).release()
+            }
+            throw res
+        }
+        self.init(job: job!)
+    }
+
+    /// Queues a compile of each of `sources` together, such as to warm a cache.
+    public static func batch(sources: [(source: String, stage: GLStage)],
+                             input: GLEnvironmentInput = .init(),
+                             client: GLEnvironmentClient = .init(),
+                             target: GLEnvironmentTarget = .init(),
+                             messages: GLMessageOptions = [],
+                             options: Options = [.msl],
+                             mslVersion: MTLLanguageVersion? = nil,
+                             priority: Priority = .background) throws -> [SPVPipelineJob] {
+        // The pipeline copies the code, so it is only needed for the call.
+        let codes = sources.map { strdup($0.source) }
+        defer { codes.forEach { free($0) } }
+
+        var inputs = zip(sources, codes).map { source, code in
+            glslang_input_s(stage: source.stage, input: input, client: client, target: target, code: code, messages: messages)
+        }
+        var jobs = [__SPVPipelineJob?](repeating: nil, count: sources.count)
+        let res: SPVResult = inputs.withUnsafeMutableBufferPointer { inputs in
+            var requests = inputs.indices.map { i in
+                __spv_pipeline_request(input: inputs.baseAddress! + i, flags: options.rawValue,
+                                       msl_version: mslVersion?.spvcMetalVersion ?? 0,
+                                       priority: priority.rawValue)
+            }
+            return __spv_pipeline_compile_batch(&requests, requests.count, nil, nil, &jobs)
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+        return jobs.map { SPVPipelineJob(job: $0!) }
+    }
+
+    deinit {
+        job.release()
+    }
+
+    public var status: Status { Status(job.poll()) }
+
+    /// Raises a background job to interactive, so it runs ahead of other background jobs.
+    public func promote() {
+        job.promote()
+    }
+
+    /// Requests that the job stop. A running job stops at the next stage.
+    public func cancel() {
+        job.cancel()
+    }
+
+    /// Waits for the job to complete and returns its result.
+    public func wait() -> Result {
+        _ = job.wait(UInt64.max)
+        return Result(job)
+    }
+
+    /// Waits up to `timeout` seconds for the job to complete, and returns its result,
+    /// or `nil` if it is still pending or running.
+    public func wait(timeout: TimeInterval) -> Result? {
+        let ns = UInt64(max(timeout, 0) * 1_000_000_000)
+        guard Status(job.wait(ns)).isComplete else { return nil }
+        return Result(job)
+    }
+}
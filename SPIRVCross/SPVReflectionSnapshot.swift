@@ -0,0 +1,150 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+import CSPIRVCross
+import Foundation
+
+/// A copy of all resources, decorations, struct layouts and active buffer ranges
+/// of a compiler, captured with a single call into SPIRV-Cross.
+///
+/// The snapshot owns its storage and remains valid after the compiler is destroyed.
+public final class SPVReflectionSnapshot {
+    let data: UnsafePointer<__spvc_reflection_snapshot>
+    
+    init(data: UnsafePointer<__spvc_reflection_snapshot>) {
+        self.data = data
+    }
+    
+    deinit {
+        __spvc_reflection_snapshot_free(data)
+    }
+    
+    public var resources: ResourceCollection { ResourceCollection(snapshot: self) }
+    
+    /// Returns the resources of the specified type.
+    public func resources(for type: SPVResourceType) -> [Resource] {
+        resources.filter { $0.type == type }
+    }
+    
+    /// Encodes the snapshot as a versioned reflection blob, which can be stored
+    /// alongside the SPIR-V and read in place with `spvc_reflection_blob_validate`.
+    public func serializedData() throws -> Data {
+        var size = 0
+        if let res = __spvc_reflection_snapshot_serialize(data, nil, &size).errorResult {
+            throw res
+        }
+        var blob = Data(count: size)
+        let res = blob.withUnsafeMutableBytes { buf in
+            __spvc_reflection_snapshot_serialize(data, buf.baseAddress, &size)
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+        return blob
+    }
+}
+
+extension SPVReflectionSnapshot {
+    /// A value indicating the resource does not have the decoration.
+    public static let noDecoration = SPVC_REFLECTION_NO_DECORATION
+    
+    @frozen
+    public struct ResourceCollection: RandomAccessCollection {
+        let snapshot: SPVReflectionSnapshot
+        
+        public var startIndex: Int { 0 }
+        public var endIndex: Int { snapshot.data.pointee.resource_count }
+        
+        public subscript(index: Int) -> Resource {
+            precondition(index >= 0 && index < endIndex, "Index out of bounds")
+            return Resource(snapshot: snapshot, index: index)
+        }
+    }
+    
+    @frozen
+    public struct Resource {
+        let snapshot: SPVReflectionSnapshot
+        let index: Int
+        
+        var data: __spvc_reflection_snapshot { snapshot.data.pointee }
+        
+        public var type: SPVResourceType { data.resource_type[index] }
+        public var id: SPVVariableID { data.resource_id[index] }
+        public var baseTypeID: SPVTypeID { data.resource_base_type_id[index] }
+        public var typeID: SPVTypeID { data.resource_type_id[index] }
+        public var name: String { String(cString: data.resource_name[index]!) }
+        
+        public var descriptorSet: UInt32? { Self.decoration(data.resource_set[index]) }
+        public var binding: UInt32? { Self.decoration(data.resource_binding[index]) }
+        public var location: UInt32? { Self.decoration(data.resource_location[index]) }
+        public var inputAttachmentIndex: UInt32? { Self.decoration(data.resource_input_attachment_index[index]) }
+        
+        public var baseType: SPVBaseType { data.resource_basetype[index] }
+        public var vectorSize: UInt32 { data.resource_vector_size[index] }
+        public var columns: UInt32 { data.resource_columns[index] }
+        
+        /// The size of the outermost array dimension, `0` for runtime arrays
+        /// and `1` if the resource is not an array.
+        public var arraySize: UInt32 { data.resource_array_size[index] }
+        
+        /// The declared size of the block, or `0` if the resource is not a block.
+        public var declaredSize: Int { data.resource_declared_size[index] }
+        
+        public var members: [Member] {
+            let begin = Int(data.resource_member_begin[index])
+            let count = Int(data.resource_member_count[index])
+            return (begin..<begin + count).map { Member(snapshot: snapshot, index: $0) }
+        }
+        
+        /// Returns an array containing the members of the block that are
+        /// potentially in use by the shader.
+        public var activeBufferRanges: [SPVBufferRange] {
+            let begin = Int(data.resource_range_begin[index])
+            let count = Int(data.resource_range_count[index])
+            guard count > 0 else { return [] }
+            return data.ranges.withMemoryRebound(to: SPVBufferRange.self, capacity: data.range_count) {
+                Array(UnsafeBufferPointer(start: $0 + begin, count: count))
+            }
+        }
+        
+        static func decoration(_ value: UInt32) -> UInt32? {
+            value == SPVReflectionSnapshot.noDecoration ? nil : value
+        }
+    }
+    
+    @frozen
+    public struct Member {
+        let snapshot: SPVReflectionSnapshot
+        let index: Int
+        
+        var data: __spvc_reflection_snapshot { snapshot.data.pointee }
+        
+        public var name: String { String(cString: data.member_name[index]!) }
+        public var typeID: SPVTypeID { data.member_type_id[index] }
+        public var baseType: SPVBaseType { data.member_basetype[index] }
+        public var vectorSize: UInt32 { data.member_vector_size[index] }
+        public var columns: UInt32 { data.member_columns[index] }
+        public var offset: UInt32 { data.member_offset[index] }
+        public var size: Int { data.member_size[index] }
+        public var arrayStride: UInt32 { data.member_array_stride[index] }
+        public var matrixStride: UInt32 { data.member_matrix_stride[index] }
+    }
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// A read-only, memory-mapped archive of compiled shaders.
+///
+/// Lookups are a binary search of the index in the mapping, and entries refer
+/// to the mapped bytes without copying them.
+public final class SPVShaderPack {
+    public enum PackError: Error {
+        case invalidPack
+        case system(Int32)
+    }
+    
+    let base: UnsafeMutableRawPointer
+    let size: Int
+    let pack: UnsafePointer<__spvc_shader_pack>
+    
+    /// Maps the pack at `url`, which must remain unmodified while the pack is open.
+    public init(contentsOf url: URL) throws {
+        let fd = open(url.path, O_RDONLY)
+        guard fd >= 0 else { throw PackError.system(errno) }
+        defer { close(fd) }
+        
+        var st = stat()
+        guard fstat(fd, &st) == 0 else { throw PackError.system(errno) }
+        size = Int(st.st_size)
+        guard size > 0, let base = mmap(nil, size, PROT_READ, MAP_PRIVATE, fd, 0), base != MAP_FAILED else {
+            throw size > 0 ? PackError.system(errno) : PackError.invalidPack
+        }
+        self.base = base
+        
+        guard let pack = __spvc_shader_pack_validate(base, size) else {
+            munmap(base, size)
+            throw PackError.invalidPack
+        }
+        self.pack = pack
+    }
+    
+    deinit {
+        munmap(base, size)
+    }
+    
+    public var count: Int { Int(pack.pointee.entry_count) }
+    
+    /// Returns the shader stored under `key`, or `nil`.
+    public subscript(key: String) -> Entry? {
+        var key = key
+        return key.withUTF8 { buf in
+            buf.withMemoryRebound(to: CChar.self) { key in
+                __spvc_shader_pack_find(pack, key.baseAddress, key.count).map { Entry(pack: self, entry: $0) }
+            }
+        }
+    }
+    
+    /// The entries of the pack, in index order.
+    public var entries: [Entry] {
+        (0..<pack.pointee.entry_count).map { Entry(pack: self, entry: __spvc_shader_pack_get_entry(pack, $0)) }
+    }
+}
+
+extension SPVShaderPack {
+    /// A shader in a pack. The buffers are valid while the pack is alive.
+    public struct Entry {
+        let pack: SPVShaderPack
+        let entry: UnsafePointer<__spvc_shader_pack_entry>
+        
+        public var key: String {
+            String(cString: __spvc_shader_pack_get_key(pack.pack, entry))
+        }
+        
+        public var spirv: UnsafeBufferPointer<UInt32> {
+            UnsafeBufferPointer(start: __spvc_shader_pack_get_spirv(pack.pack, entry),
+                                count: Int(entry.pointee.spirv_size) / MemoryLayout<UInt32>.size)
+        }
+        
+        /// The NUL-terminated MSL, which can be passed to Metal without copying it into a `String`.
+        public var mslCString: UnsafePointer<CChar> {
+            __spvc_shader_pack_get_msl(pack.pack, entry)
+        }
+        
+        public var msl: String { String(cString: mslCString) }
+        
+        /// The reflection blob, in the format of `SPVReflectionSnapshot.serializedData()`.
+        public var reflection: UnsafeRawBufferPointer {
+            UnsafeRawBufferPointer(start: __spvc_shader_pack_get_reflection(pack.pack, entry),
+                                   count: Int(entry.pointee.reflection_size))
+        }
+    }
+}
+
+/// Builds a shader pack.
+public final class SPVShaderPackWriter {
+    let writer: __SPVShaderPackWriter
+    
+    public init() {
+        var writer: __SPVShaderPackWriter?
+        if __spvc_shader_pack_writer_create(&writer).errorResult != nil {
+            fatalError("Out of memory")
+        }
+        self.writer = writer!
+    }
+    
+    deinit {
+        writer.destroy()
+    }
+    
+    /// Adds a shader under `key`, which must be unique in the pack.
+    public func add(key: String, spirv: Data, msl: String? = nil, reflection: Data? = nil) throws {
+        var key = key
+        let res = key.withUTF8 { key in
+            spirv.withUnsafeBytes { spirv in
+                (reflection ?? Data()).withUnsafeBytes { reflection in
+                    key.withMemoryRebound(to: CChar.self) { key in
+                        writer.add(key: key.baseAddress, keySize: key.count,
+                                   spirv: spirv.bindMemory(to: SpvId.self).baseAddress,
+                                   wordCount: spirv.count / MemoryLayout<SpvId>.size, msl: msl,
+                                   reflection: reflection.baseAddress, reflectionSize: reflection.count)
+                    }
+                }
+            }
+        }
+        if let res = res.errorResult {
+            throw res
+        }
+    }
+    
+    /// Passes the pack to `sink` in order, so it can be written to a file without being assembled in memory.
+    public func write(to sink: (UnsafeRawBufferPointer) throws -> Void) throws {
+        try SPVWriteSink.write(to: sink) { callback, userdata in
+            writer.write(callback, userdata)
+        }
+    }
+    
+    public func write(to url: URL) throws {
+        FileManager.default.createFile(atPath: url.path, contents: nil)
+        let file = try FileHandle(forWritingTo: url)
+        defer { file.closeFile() }
+        try write { file.write(Data($0)) }
+    }
+}
@@ -56,6 +56,20 @@ public struct SPVVariable {
             Array(UnsafeBufferPointer<SPVBufferRange>(start: $0, count: size))
         }
     }
+    
+    /// Moves the members of this uniform or push-constant block down, so the block
+    /// starts at its first member, and returns the byte range to upload, which ends at
+    /// its last active member. Members keep their order, so inactive leading members
+    /// stop the block from moving unless they were removed first.
+    ///
+    /// Must be called before the shader is compiled.
+    public func packActiveBufferRange() throws -> SPVBufferPacking {
+        var packing = __spvc_buffer_packing()
+        if let res = compiler.msl_pack_buffer(id: id, baseTypeID: baseTypeID, &packing).errorResult {
+            throw res
+        }
+        return SPVBufferPacking(data: packing)
+    }
 }
 
 @frozen
@@ -72,3 +86,25 @@ public struct SPVBufferRange {
     /// in the buffer.
     public var range: Int { data.range }
 }
+
+@frozen
+public struct SPVBufferPacking {
+    let data: __spvc_buffer_packing
+    
+    /// The offset into the original block of the first byte to upload.
+    public var offset: Int { Int(data.offset) }
+    
+    /// The number of bytes to upload, up to the end of the active members.
+    public var size: Int { data.size }
+    
+    /// The end of the active ranges in the original block.
+    public var activeEnd: Int { Int(data.active_end) }
+    
+    /// The declared size of the packed block, which includes any inactive members
+    /// after its active span. A buffer bound with Metal API validation
+    /// enabled must be at least this long.
+    public var declaredSize: Int { data.declared_size }
+    
+    /// The range of the original block to upload.
+    public var uploadRange: Range<Int> { offset..<(offset + size) }
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CSPIRVCross
+import Foundation
+
+/// Adapts a throwing Swift closure to an `spvc_write_callback`.
+final class SPVWriteSink {
+    typealias Callback = @convention(c) (UnsafeMutableRawPointer?, UnsafePointer<Int8>?, Int) -> SPVResult
+    
+    let sink: (UnsafeRawBufferPointer) throws -> Void
+    var error: Error?
+    
+    init(_ sink: @escaping (UnsafeRawBufferPointer) throws -> Void) {
+        self.sink = sink
+    }
+    
+    static let callback: Callback = { userdata, data, size in
+        let this = Unmanaged<SPVWriteSink>.fromOpaque(userdata!).takeUnretainedValue()
+        do {
+            try this.sink(UnsafeRawBufferPointer(start: data, count: size))
+            return .success
+        } catch {
+            this.error = error
+            return .invalidArgument
+        }
+    }
+    
+    /// Calls `body` with a callback and userdata which forward to `sink`, rethrowing any error thrown by `sink`.
+    static func write(to sink: (UnsafeRawBufferPointer) throws -> Void, _ body: (Callback, UnsafeMutableRawPointer) -> SPVResult) throws {
+        try withoutActuallyEscaping(sink) { sink in
+            let box = SPVWriteSink(sink)
+            let res = withExtendedLifetime(box) {
+                body(callback, Unmanaged.passUnretained(box).toOpaque())
+            }
+            if let error = box.error {
+                throw error
+            }
+            if let res = res.errorResult {
+                throw res
+            }
+        }
+    }
+}
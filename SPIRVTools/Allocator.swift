@@ -0,0 +1,93 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import Foundation
+import CSPIRVTools
+
+/// An allocator which the glslang, SPIRV-Tools and SPIRV-Cross wrappers can create their objects from.
+public struct SPVTAllocator {
+    let allocator: UnsafePointer<spv_allocator_t>
+    
+    // Keeps the arena which owns the allocator alive.
+    let owner: AnyObject?
+    
+    /// The allocator used when none is installed, which calls the system allocator.
+    public static let system = SPVTAllocator(allocator: spvt_allocator_get_system(), owner: nil)
+    
+    public func allocate(byteCount: Int, alignment: Int) -> UnsafeMutableRawPointer? {
+        allocator.pointee.alloc!(allocator.pointee.userdata, byteCount, alignment)
+    }
+    
+    public func reallocate(_ pointer: UnsafeMutableRawPointer?, byteCount: Int, newByteCount: Int,
+                           alignment: Int) -> UnsafeMutableRawPointer? {
+        allocator.pointee.realloc!(allocator.pointee.userdata, pointer, byteCount, newByteCount, alignment)
+    }
+    
+    public func deallocate(_ pointer: UnsafeMutableRawPointer?, byteCount: Int) {
+        allocator.pointee.free!(allocator.pointee.userdata, pointer, byteCount)
+    }
+}
+
+/// A bump allocator for a single worker, whose allocations are released together by `reset()`.
+public final class SPVTArena {
+    public struct Statistics {
+        /// Bytes handed out since the last reset.
+        public var allocatedBytes: Int
+        /// The highest `allocatedBytes` reached since the arena was created.
+        public var peakBytes: Int
+        /// Bytes of the blocks held by the arena.
+        public var reservedBytes: Int
+        public var allocationCount: Int
+        public var resetCount: Int
+    }
+    
+    let arena: CSPVTArena
+    
+    /// - Parameter blockSize: The size of each block, or 0 for the default of 64 KiB.
+    public init(blockSize: Int = 0) {
+        guard let arena = CSPVTArena(blockSize: blockSize) else {
+            fatalError("Out of memory")
+        }
+        self.arena = arena
+    }
+    
+    deinit {
+        arena.destroy()
+    }
+    
+    public var allocator: SPVTAllocator {
+        SPVTAllocator(allocator: arena.allocator, owner: self)
+    }
+    
+    /// Releases every allocation of the arena, keeping its blocks for reuse.
+    ///
+    /// Objects created with the arena's allocator, and the data they returned, must have been released.
+    public func reset() {
+        arena.reset()
+    }
+    
+    public var statistics: Statistics {
+        var stats = spvt_arena_stats()
+        arena.getStats(&stats)
+        return Statistics(allocatedBytes: stats.allocated_bytes, peakBytes: stats.peak_bytes,
+                          reservedBytes: stats.reserved_bytes, allocationCount: stats.allocation_count,
+                          resetCount: stats.reset_count)
+    }
+}
@@ -23,9 +23,22 @@ import CSPIRVTools
 
 public class SPVTOptimizer {
     let optimizer: CSPVTOptimizer
+    let allocator: SPVTAllocator?
     
     public init(environment: SPVTargetEnvironment) {
         optimizer = CSPVTOptimizer(environment: environment)
+        allocator = nil
+    }
+    
+    /// Creates an optimizer which allocates itself and its results from `allocator`.
+    public init(environment: SPVTargetEnvironment, allocator: SPVTAllocator) {
+        guard let optimizer = withExtendedLifetime(allocator, {
+            CSPVTOptimizer(environment: environment, allocator: allocator.allocator)
+        }) else {
+            fatalError("Out of memory")
+        }
+        self.optimizer = optimizer
+        self.allocator = allocator
     }
     
     deinit {
@@ -57,8 +70,12 @@ public class SPVTOptimizer {
                 return nil
             }
 
+            // The data keeps the allocator alive, since its bytes are owned by it.
+            let allocator = self.allocator
             return Data(bytesNoCopy: vec.ptr, count: vec.size, deallocator: .custom({ _, _ in
-                vec.destroy()
+                withExtendedLifetime(allocator) {
+                    vec.destroy()
+                }
             }))
         }
     }
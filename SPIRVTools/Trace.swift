@@ -0,0 +1,61 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import Foundation
+import CSPIRVTools
+
+/// Records spans of the compile pipeline, from glslang through the SPIRV-Tools passes
+/// and the SPIRV-Cross compile, for viewing in Perfetto or `chrome://tracing`.
+public enum SPVTTrace {
+    public static var isRecording: Bool {
+        spvt_trace_is_recording()
+    }
+
+    public static func start() {
+        spvt_trace_start()
+    }
+
+    public static func stop() {
+        spvt_trace_stop()
+    }
+
+    /// Names the calling thread in the trace.
+    public static func setThreadName(_ name: String) {
+        spvt_trace_set_thread_name(name)
+    }
+
+    /// Returns the spans recorded since the last flush as Chrome trace JSON, and discards them.
+    public static func flush() -> Data {
+        var data = Data()
+        withUnsafeMutablePointer(to: &data) { ptr in
+            spvt_trace_flush_json({ userdata, bytes, size in
+                guard let bytes = bytes, size > 0 else { return }
+                let data = userdata!.assumingMemoryBound(to: Data.self)
+                data.pointee.append(UnsafeRawPointer(bytes).assumingMemoryBound(to: UInt8.self), count: size)
+            }, ptr)
+        }
+        return data
+    }
+
+    /// Writes the spans recorded since the last flush to a file as Chrome trace JSON.
+    public static func flush(to url: URL) throws {
+        try flush().write(to: url)
+    }
+}
@@ -0,0 +1,154 @@
+//
+//  Protocol.swift
+//  spirvd
+//
+
+import Foundation
+import SPIRV
+
+/// The messages exchanged by `spirvd` and its clients.
+///
+/// Every message is a little-endian header followed by length-prefixed sections:
+///
+///     Request:  magic u32, version u16, input u8, stage u8, outputs u32,
+///               source length u32, source bytes
+///     Response: magic u32, version u16, status u16,
+///               4 x section length u32 (SPIR-V, MSL, reflection, log), section bytes
+enum SPVDProtocol {
+    static let magic: UInt32 = 0x4456_5053 // "SPVD"
+    static let version: UInt16 = 1
+    
+    /// Requests larger than this are rejected before they are read.
+    static let maxSectionSize = 64 << 20
+    
+    enum Input: UInt8 {
+        case glsl
+        case spirv
+    }
+    
+    struct Outputs: OptionSet {
+        let rawValue: UInt32
+        
+        static let spirv = Outputs(rawValue: 1 << 0)
+        static let msl = Outputs(rawValue: 1 << 1)
+        static let reflection = Outputs(rawValue: 1 << 2)
+        /// Runs the SPIR-V optimizer before the SPIR-V or MSL is produced.
+        static let optimize = Outputs(rawValue: 1 << 3)
+    }
+    
+    enum Status: UInt16, Error {
+        case success
+        case invalidRequest
+        case preprocess
+        case parse
+        case link
+        case optimize
+        case cross
+        case deadlineExceeded
+    }
+    
+    struct Request {
+        var input: Input
+        var stage: GLStage
+        var outputs: Outputs
+        var source: Data
+    }
+    
+    struct Response {
+        var status: Status = .success
+        var spirv = Data()
+        var msl = Data()
+        var reflection = Data()
+        var log = Data()
+    }
+}
+
+// MARK: - Encoding
+
+extension SPVDProtocol.Request {
+    static let headerSize = 16
+    
+    func encoded() -> Data {
+        var data = Data(capacity: Self.headerSize + source.count)
+        data.append(le: SPVDProtocol.magic)
+        data.append(le: SPVDProtocol.version)
+        data.append(input.rawValue)
+        data.append(UInt8(stage.rawValue))
+        data.append(le: outputs.rawValue)
+        data.append(le: UInt32(source.count))
+        data.append(source)
+        return data
+    }
+    
+    /// Reads a request from `socket`, or returns `nil` if the client closed the connection.
+    static func read(from socket: SPVDSocket) throws -> Self? {
+        guard let header = try socket.read(count: headerSize) else { return nil }
+        guard header.le(UInt32.self, at: 0) == SPVDProtocol.magic,
+              header.le(UInt16.self, at: 4) == SPVDProtocol.version,
+              let input = SPVDProtocol.Input(rawValue: header[header.startIndex + 6]),
+              let stage = GLStage(rawValue: UInt32(header[header.startIndex + 7]))
+        else {
+            throw SPVDProtocol.Status.invalidRequest
+        }
+        
+        let size = Int(header.le(UInt32.self, at: 12))
+        guard size <= SPVDProtocol.maxSectionSize, let source = try socket.read(count: size) else {
+            throw SPVDProtocol.Status.invalidRequest
+        }
+        return Self(input: input, stage: stage,
+                    outputs: SPVDProtocol.Outputs(rawValue: header.le(UInt32.self, at: 8)), source: source)
+    }
+}
+
+extension SPVDProtocol.Response {
+    static let headerSize = 24
+    
+    func encoded() -> Data {
+        let sections = [spirv, msl, reflection, log]
+        var data = Data(capacity: Self.headerSize + sections.reduce(0) { $0 + $1.count })
+        data.append(le: SPVDProtocol.magic)
+        data.append(le: SPVDProtocol.version)
+        data.append(le: status.rawValue)
+        for section in sections {
+            data.append(le: UInt32(section.count))
+        }
+        for section in sections {
+            data.append(section)
+        }
+        return data
+    }
+    
+    static func read(from socket: SPVDSocket) throws -> Self {
+        guard let header = try socket.read(count: headerSize),
+              header.le(UInt32.self, at: 0) == SPVDProtocol.magic,
+              header.le(UInt16.self, at: 4) == SPVDProtocol.version,
+              let status = SPVDProtocol.Status(rawValue: header.le(UInt16.self, at: 6))
+        else {
+            throw SPVDProtocol.Status.invalidRequest
+        }
+        
+        var sections = [Data]()
+        for i in 0..<4 {
+            let size = Int(header.le(UInt32.self, at: 8 + i * 4))
+            guard let section = try socket.read(count: size) else {
+                throw SPVDProtocol.Status.invalidRequest
+            }
+            sections.append(section)
+        }
+        return Self(status: status, spirv: sections[0], msl: sections[1], reflection: sections[2], log: sections[3])
+    }
+}
+
+extension Data {
+    mutating func append<T: FixedWidthInteger>(le value: T) {
+        Swift.withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+    
+    func le<T: FixedWidthInteger>(_ type: T.Type, at offset: Int) -> T {
+        var value = T.zero
+        Swift.withUnsafeMutableBytes(of: &value) { buf in
+            buf.copyBytes(from: self[(startIndex + offset)..<(startIndex + offset + MemoryLayout<T>.size)])
+        }
+        return T(littleEndian: value)
+    }
+}
@@ -0,0 +1,118 @@
+//
+//  SPVDSocket.swift
+//  spirvd
+//
+
+import Foundation
+
+/// A connected or listening Unix domain socket.
+final class SPVDSocket {
+    enum SocketError: Error {
+        case pathTooLong
+        case system(String, Int32)
+    }
+    
+    let fd: Int32
+    
+    init(fd: Int32) {
+        self.fd = fd
+        // Writing to a connection the peer closed fails with EPIPE, rather than raising SIGPIPE,
+        // whose default action terminates the process.
+        var on: Int32 = 1
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, socklen_t(MemoryLayout<Int32>.size))
+    }
+    
+    deinit {
+        close(fd)
+    }
+    
+    /// Creates a socket listening at `path`, replacing any stale socket file.
+    static func listen(path: String, backlog: Int32 = 64) throws -> SPVDSocket {
+        let socket = try SPVDSocket(fd: check("socket", Darwin.socket(AF_UNIX, SOCK_STREAM, 0)))
+        var addr = try address(path)
+        unlink(path)
+        try withUnsafePointer(to: &addr) {
+            try $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                _ = try check("bind", bind(socket.fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size)))
+            }
+        }
+        _ = try check("listen", Darwin.listen(socket.fd, backlog))
+        return socket
+    }
+    
+    static func connect(path: String) throws -> SPVDSocket {
+        let socket = try SPVDSocket(fd: check("socket", Darwin.socket(AF_UNIX, SOCK_STREAM, 0)))
+        var addr = try address(path)
+        try withUnsafePointer(to: &addr) {
+            try $0.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+                _ = try check("connect", Darwin.connect(socket.fd, $0, socklen_t(MemoryLayout<sockaddr_un>.size)))
+            }
+        }
+        return socket
+    }
+    
+    func accept() throws -> SPVDSocket {
+        SPVDSocket(fd: try Self.check("accept", Darwin.accept(fd, nil, nil)))
+    }
+    
+    /// Reads exactly `count` bytes, or returns `nil` if the peer closed the connection before the first byte.
+    func read(count: Int) throws -> Data? {
+        var data = Data(count: count)
+        var offset = 0
+        while offset < count {
+            let n = data.withUnsafeMutableBytes { buf in
+                Darwin.read(fd, buf.baseAddress! + offset, count - offset)
+            }
+            if n < 0 && errno == EINTR {
+                continue
+            }
+            if n == 0 && offset == 0 {
+                return nil
+            }
+            if n <= 0 {
+                throw SocketError.system("read", n == 0 ? ECONNRESET : errno)
+            }
+            offset += n
+        }
+        return data
+    }
+    
+    func write(_ data: Data) throws {
+        try data.withUnsafeBytes { buf in
+            var offset = 0
+            while offset < buf.count {
+                let n = Darwin.write(fd, buf.baseAddress! + offset, buf.count - offset)
+                if n < 0 && errno == EINTR {
+                    continue
+                }
+                if n <= 0 {
+                    throw SocketError.system("write", errno)
+                }
+                offset += n
+            }
+        }
+    }
+    
+    static func address(_ path: String) throws -> sockaddr_un {
+        var addr = sockaddr_un()
+        addr.sun_family = sa_family_t(AF_UNIX)
+        addr.sun_len = UInt8(MemoryLayout<sockaddr_un>.size)
+        let bytes = Array(path.utf8)
+        guard bytes.count < MemoryLayout.size(ofValue: addr.sun_path) else {
+            throw SocketError.pathTooLong
+        }
+        withUnsafeMutableBytes(of: &addr.sun_path) { buf in
+            buf.copyBytes(from: bytes)
+            buf[bytes.count] = 0
+        }
+        return addr
+    }
+    
+    @discardableResult
+    static func check(_ call: String, _ result: Int32) throws -> Int32 {
+        guard result >= 0 else {
+            throw SocketError.system(call, errno)
+        }
+        return result
+    }
+}
@@ -0,0 +1,71 @@
+//
+//  Server.swift
+//  spirvd
+//
+
+import Foundation
+
+/// Accepts connections and compiles their requests on a fixed pool of warm workers.
+///
+/// A connection may send any number of requests, which are answered in order.
+/// Requests from different connections are compiled concurrently.
+final class Server {
+    let socket: SPVDSocket
+    
+    let lock = NSLock()
+    var idle: [Worker]
+    let available: DispatchSemaphore
+    
+    init(path: String, workers: Int, timeout: TimeInterval? = nil) throws {
+        socket = try SPVDSocket.listen(path: path)
+        
+        // Warm the workers concurrently, as each compiles a few shaders.
+        let pool = (0..<workers).map { _ in Worker(timeout: timeout) }
+        DispatchQueue.concurrentPerform(iterations: pool.count) { pool[$0].warmUp() }
+        idle = pool
+        available = DispatchSemaphore(value: pool.count)
+    }
+    
+    func run() throws -> Never {
+        let connections = DispatchQueue(label: "spirvd.connections", attributes: .concurrent)
+        while true {
+            let connection: SPVDSocket
+            do {
+                connection = try socket.accept()
+            } catch SPVDSocket.SocketError.system(_, EINTR) {
+                continue
+            }
+            connections.async {
+                self.serve(connection)
+            }
+        }
+    }
+    
+    func serve(_ connection: SPVDSocket) {
+        do {
+            while let request = try SPVDProtocol.Request.read(from: connection) {
+                try connection.write(compile(request).encoded())
+            }
+        } catch let status as SPVDProtocol.Status {
+            // The stream cannot be resynchronized after a malformed request, so reply and close it.
+            try? connection.write(SPVDProtocol.Response(status: status).encoded())
+        } catch {
+            // The client went away.
+        }
+    }
+    
+    func compile(_ request: SPVDProtocol.Request) -> SPVDProtocol.Response {
+        available.wait()
+        lock.lock()
+        let worker = idle.removeLast()
+        lock.unlock()
+        
+        defer {
+            lock.lock()
+            idle.append(worker)
+            lock.unlock()
+            available.signal()
+        }
+        return worker.handle(request)
+    }
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2020 Stuart Carnie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+import CoreServices
+import Foundation
+import SPIRV
+
+/// Recompiles the shaders of a directory as they and the files they include change.
+///
+/// The first pass compiles every shader, recording the files each one read. After that, each
+/// batch of file system events recompiles only the shaders which are, or include, a changed file,
+/// concurrently on the pipeline's workers. An output whose contents did not change is not rewritten,
+/// so builds which depend on it see no change.
+final class Watcher {
+    static let stages: [String: GLStage] = [
+        "vert": .vertex, "tesc": .tessControl, "tese": .tessEvaluation,
+        "geom": .geometry, "frag": .fragment, "comp": .compute,
+    ]
+    
+    /// The time FSEvents waits to coalesce the events after the first of a batch.
+    static let latency: CFTimeInterval = 0.01
+    
+    let root: String
+    let output: String
+    let searchPaths: [String]
+    let options: SPVPipelineJob.Options
+    
+    /// The files each shader read or looked for during its last compile, keyed by the shader's path.
+    var dependencies = [String: Set<String>]()
+    let queue = DispatchQueue(label: "spirvd.watch")
+    
+    init(root: String, output: String, searchPaths: [String], optimize: Bool) {
+        // FSEvents reports paths with their symbolic links resolved.
+        self.root = URL(fileURLWithPath: root).resolvingSymlinksInPath().path
+        self.output = URL(fileURLWithPath: output).resolvingSymlinksInPath().path
+        self.searchPaths = searchPaths.map { URL(fileURLWithPath: $0).resolvingSymlinksInPath().path }
+        options = optimize ? [.msl, .optimize] : [.msl]
+    }
+    
+    func run() -> Never {
+        queue.sync {
+            compile(shaders())
+        }
+        
+        var context = FSEventStreamContext(version: 0, info: Unmanaged.passUnretained(self).toOpaque(),
+                                           retain: nil, release: nil, copyDescription: nil)
+        let callback: FSEventStreamCallback = { _, info, _, paths, _, _ in
+            let watcher = Unmanaged<Watcher>.fromOpaque(info!).takeUnretainedValue()
+            let paths = unsafeBitCast(paths, to: NSArray.self) as? [String] ?? []
+            watcher.changed(Set(paths.map { ($0 as NSString).standardizingPath }))
+        }
+        let flags = kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer | kFSEventStreamCreateFlagUseCFTypes
+        guard let stream = FSEventStreamCreate(nil, callback, &context, [root] as CFArray,
+                                               FSEventStreamEventId(kFSEventStreamEventIdSinceNow), Self.latency,
+                                               FSEventStreamCreateFlags(flags))
+        else {
+            fatalError("Unable to watch \(root)")
+        }
+        // Events are delivered on the queue which compiles, so those arriving during a compile form the next batch.
+        FSEventStreamSetDispatchQueue(stream, queue)
+        FSEventStreamStart(stream)
+        print("watching \(root)")
+        dispatchMain()
+    }
+    
+    func stage(for path: String) -> GLStage? {
+        Self.stages[(path as NSString).pathExtension]
+    }
+    
+    /// Every shader under the root.
+    func shaders() -> [String] {
+        let files = FileManager.default.enumerator(atPath: root)?.compactMap { $0 as? String } ?? []
+        return files.map { (root as NSString).appendingPathComponent($0) }.filter { stage(for: $0) != nil }.sorted()
+    }
+    
+    func changed(_ paths: Set<String>) {
+        let paths = paths.filter { !$0.hasPrefix(output + "/") }
+        var shaders = Set<String>()
+        for path in paths where stage(for: path) != nil && path.hasPrefix(root + "/") {
+            shaders.insert(path)
+        }
+        for (shader, files) in dependencies where !files.isDisjoint(with: paths) {
+            shaders.insert(shader)
+        }
+        
+        // A shader which was deleted is forgotten, and its outputs are left in place.
+        for shader in shaders where !FileManager.default.fileExists(atPath: shader) {
+            dependencies[shader] = nil
+            shaders.remove(shader)
+        }
+        if !shaders.isEmpty {
+            compile(shaders.sorted())
+        }
+    }
+    
+    /// Compiles shaders concurrently, and records what each one read.
+    func compile(_ shaders: [String]) {
+        let start = DispatchTime.now()
+        let jobs = shaders.compactMap { path -> (String, GLIncluder, SPVPipelineJob)? in
+            guard let stage = stage(for: path), let source = FileManager.default.contents(atPath: path) else {
+                return nil
+            }
+            let includer = GLIncluder(path: path, searchPaths: searchPaths)
+            do {
+                let job = try SPVPipelineJob(source: String(decoding: source, as: UTF8.self), stage: stage,
+                                             includer: includer, options: options)
+                return (path, includer, job)
+            } catch {
+                print("\(path): \(error.localizedDescription)")
+                return nil
+            }
+        }
+        
+        var failed = 0
+        for (path, includer, job) in jobs {
+            let result = job.wait()
+            dependencies[path] = includer.dependencies
+            guard result.status == .succeeded else {
+                failed += 1
+                print("\(path): failed\n\(result.log)")
+                continue
+            }
+            
+            let base = (output as NSString).appendingPathComponent(String(path.dropFirst(root.count + 1)))
+            write(result.spirv.withUnsafeBytes { Data($0) }, to: base + ".spv")
+            if let msl = result.msl {
+                write(Data(msl.utf8), to: base + ".metal")
+            }
+        }
+        
+        let ms = Double(DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1e6
+        print(String(format: "compiled %d shader(s) in %.1f ms, %d failed", jobs.count, ms, failed))
+    }
+    
+    func write(_ data: Data, to path: String) {
+        if FileManager.default.contents(atPath: path) == data {
+            return
+        }
+        do {
+            try FileManager.default.createDirectory(atPath: (path as NSString).deletingLastPathComponent,
+                                                    withIntermediateDirectories: true)
+            try data.write(to: URL(fileURLWithPath: path), options: .atomic)
+        } catch {
+            print("\(path): \(error.localizedDescription)")
+        }
+    }
+}
@@ -0,0 +1,118 @@
+//
+//  Worker.swift
+//  spirvd
+//
+
+import Foundation
+import SPIRV
+
+/// Compiles requests with state which is kept warm between them.
+///
+/// glslang builds its built-in symbol tables on first use of a stage, which the warm-up pays
+/// for once per process. A worker reuses a resettable SPIRV-Cross context, so each request
+/// only pays for its own shader.
+///
+/// SPIRV-Tools passes can only run once, so each optimized request creates its own optimizer.
+final class Worker {
+    let context = SPVContext(resettable: true)
+    
+    /// The longest a request may spend in glslang, in seconds.
+    let timeout: TimeInterval?
+    
+    init(timeout: TimeInterval?) {
+        self.timeout = timeout
+    }
+    
+    /// Compiles a trivial shader of each common stage, so the first request does not build the symbol tables.
+    func warmUp() {
+        let sources: [(GLStage, String)] = [
+            (.vertex, "#version 450\nvoid main() { gl_Position = vec4(0.0); }\n"),
+            (.fragment, "#version 450\nlayout(location = 0) out vec4 c;\nvoid main() { c = vec4(0.0); }\n"),
+            (.compute, "#version 450\nlayout(local_size_x = 1) in;\nvoid main() {}\n"),
+        ]
+        for (stage, source) in sources {
+            _ = handle(SPVDProtocol.Request(input: .glsl, stage: stage, outputs: [.msl, .optimize],
+                                            source: Data(source.utf8)))
+        }
+    }
+    
+    func handle(_ request: SPVDProtocol.Request) -> SPVDProtocol.Response {
+        var response = SPVDProtocol.Response()
+        do {
+            var spirv = try makeSPIRV(request, log: &response.log)
+            if request.outputs.contains(.optimize) {
+                let optimizer = SPVTOptimizer(environment: .universal1_5)
+                optimizer.registerPerformancePasses()
+                guard let optimized = optimizer.optimize(spirv: spirv) else {
+                    throw SPVDProtocol.Status.optimize
+                }
+                spirv = optimized
+            }
+            if request.outputs.contains(.spirv) {
+                response.spirv = spirv
+            }
+            
+            if !request.outputs.isDisjoint(with: [.msl, .reflection]) {
+                defer { context.reset() }
+                do {
+                    let compiler = try context.makeMetalCompiler(ir: try context.parse(data: spirv))
+                    let (source, reflection) = try compiler.compileWithReflection()
+                    if request.outputs.contains(.msl) {
+                        response.msl = Data(source.utf8)
+                    }
+                    if request.outputs.contains(.reflection) {
+                        response.reflection = try reflection.serializedData()
+                    }
+                } catch {
+                    response.log.append(contentsOf: "\(error.localizedDescription)\n".utf8)
+                    throw SPVDProtocol.Status.cross
+                }
+            }
+        } catch let status as SPVDProtocol.Status {
+            response.status = status
+        } catch {
+            response.status = .invalidRequest
+        }
+        return response
+    }
+    
+    func makeSPIRV(_ request: SPVDProtocol.Request, log: inout Data) throws -> Data {
+        switch request.input {
+        case .spirv:
+            guard request.source.count % MemoryLayout<UInt32>.size == 0 else {
+                throw SPVDProtocol.Status.invalidRequest
+            }
+            return request.source
+            
+        case .glsl:
+            let shader = GLShader(source: String(decoding: request.source, as: UTF8.self), stage: request.stage)
+            do {
+                try shader.parse(messages: [.vulkanRules, .spvRules], timeout: timeout)
+            } catch GLShader.ShaderError.deadlineExceeded {
+                log.append(contentsOf: shader.infoLog.utf8)
+                throw SPVDProtocol.Status.deadlineExceeded
+            } catch GLShader.ShaderError.preprocess {
+                log.append(contentsOf: shader.infoLog.utf8)
+                throw SPVDProtocol.Status.preprocess
+            } catch {
+                log.append(contentsOf: shader.infoLog.utf8)
+                throw SPVDProtocol.Status.parse
+            }
+            
+            let program = GLProgram()
+            program.add(shader: shader)
+            do {
+                try program.link()
+                return try program.generate(stage: request.stage)
+            } catch GLProgram.ProgramError.deadlineExceeded {
+                throw SPVDProtocol.Status.deadlineExceeded
+            } catch GLShader.ShaderError.preprocess {
+                log.append(contentsOf: shader.infoLog.utf8)
+                throw SPVDProtocol.Status.preprocess
+            } catch {
+                log.append(contentsOf: program.infoLog.utf8)
+                throw SPVDProtocol.Status.link
+            }
+        }
+    }
+}
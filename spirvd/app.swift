@@ -0,0 +1,118 @@
+//
+//  app.swift
+//  spirvd
+//
+
+import Foundation
+import SPIRV
+
+/// A shader compile daemon, and the client build scripts use to talk to it.
+///
+///     spirvd serve [--socket PATH] [--workers N] [--timeout SECONDS]
+///     spirvd compile [--socket PATH] --stage STAGE (--glsl FILE | --spirv FILE)
+///                    [--optimize] [--out-spirv FILE] [--out-msl FILE] [--out-reflection FILE]
+///     spirvd watch --dir DIR --out DIR [--include DIR] [--optimize]
+///
+/// `watch` compiles every shader under `--dir` to SPIR-V and MSL in `--out`, and then
+/// recompiles the shaders affected by each change to a shader or a file it includes.
+/// `--timeout` bounds the time each request may spend preprocessing, parsing and linking.
+/// `compile` exits with the response status, and writes the compile log to stderr.
+@main
+struct SPIRVDaemon {
+    static let defaultSocket = NSTemporaryDirectory() + "spirvd.sock"
+    
+    static func main() throws {
+        var args = Array(CommandLine.arguments.dropFirst())
+        guard !args.isEmpty else { usage() }
+        let command = args.removeFirst()
+        
+        var options = [String: String]()
+        var flags = Set<String>()
+        while !args.isEmpty {
+            let arg = args.removeFirst()
+            guard arg.hasPrefix("--") else { usage() }
+            if arg == "--optimize" {
+                flags.insert(arg)
+            } else if !args.isEmpty {
+                options[arg] = args.removeFirst()
+            } else {
+                usage()
+            }
+        }
+        let path = options["--socket"] ?? defaultSocket
+        
+        switch command {
+        case "serve":
+            let workers = options["--workers"].flatMap(Int.init) ?? ProcessInfo.processInfo.activeProcessorCount
+            let timeout = options["--timeout"].flatMap(TimeInterval.init)
+            try Server(path: path, workers: max(workers, 1), timeout: timeout).run()
+            
+        case "compile":
+            try compile(path: path, options: options, optimize: flags.contains("--optimize"))
+            
+        case "watch":
+            guard let dir = options["--dir"], let out = options["--out"] else { usage() }
+            Watcher(root: dir, output: out, searchPaths: options["--include"].map { [$0] } ?? [],
+                    optimize: flags.contains("--optimize")).run()
+            
+        default:
+            usage()
+        }
+    }
+    
+    static func compile(path: String, options: [String: String], optimize: Bool) throws {
+        guard let stageName = options["--stage"],
+              let stage = (0..<64).lazy.compactMap({ GLStage(rawValue: $0) }).first(where: { $0.description == stageName })
+        else {
+            usage()
+        }
+        
+        let input: SPVDProtocol.Input
+        let file: String
+        if let glsl = options["--glsl"] {
+            input = .glsl
+            file = glsl
+        } else if let spirv = options["--spirv"] {
+            input = .spirv
+            file = spirv
+        } else {
+            usage()
+        }
+        
+        var outputs: SPVDProtocol.Outputs = optimize ? [.optimize] : []
+        if options["--out-spirv"] != nil { outputs.insert(.spirv) }
+        if options["--out-msl"] != nil { outputs.insert(.msl) }
+        if options["--out-reflection"] != nil { outputs.insert(.reflection) }
+        
+        let request = SPVDProtocol.Request(input: input, stage: stage, outputs: outputs,
+                                           source: try Data(contentsOf: URL(fileURLWithPath: file)))
+        let socket = try SPVDSocket.connect(path: path)
+        try socket.write(request.encoded())
+        let response = try SPVDProtocol.Response.read(from: socket)
+        
+        FileHandle.standardError.write(response.log)
+        guard response.status == .success else {
+            exit(Int32(response.status.rawValue))
+        }
+        
+        let files: [(String, Data)] = [
+            ("--out-spirv", response.spirv), ("--out-msl", response.msl), ("--out-reflection", response.reflection),
+        ]
+        for (option, data) in files {
+            if let out = options[option] {
+                try data.write(to: URL(fileURLWithPath: out))
+            }
+        }
+    }
+    
+    static func usage() -> Never {
+        FileHandle.standardError.write(Data("""
+        usage: spirvd serve [--socket PATH] [--workers N] [--timeout SECONDS]
+               spirvd compile [--socket PATH] --stage STAGE (--glsl FILE | --spirv FILE)
+                              [--optimize] [--out-spirv FILE] [--out-msl FILE] [--out-reflection FILE]
+               spirvd watch --dir DIR --out DIR [--include DIR] [--optimize]
+        
+        """.utf8))
+        exit(64)
+    }
+}
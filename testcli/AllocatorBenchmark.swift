@@ -0,0 +1,75 @@
+//
+//  AllocatorBenchmark.swift
+//  testcli
+//
+
+import Foundation
+import SPIRV
+
+/// Compares `SPVTArena` against the system allocator, both for an allocation
+/// pattern like that of the wrappers and for optimizing a shader.
+enum AllocatorBenchmark {
+    static func run(spirv: Data, iterations: Int = 200) {
+        let arena = SPVTArena()
+        
+        // Objects of a few sizes, and an output buffer which grows as it is written.
+        let system = measure(iterations) { _ in churn(SPVTAllocator.system) }
+        let bump = measure(iterations) { _ in
+            churn(arena.allocator)
+            arena.reset()
+        }
+        print(String(format: "allocation: system %.3f us, arena %.3f us, speedup: %.1fx",
+                     system * 1e6, bump * 1e6, system / bump))
+        
+        let optimizeSystem = measure(iterations) { _ in
+            let opt = SPVTOptimizer(environment: .universal1_5)
+            opt.registerPerformancePasses()
+            _ = opt.optimize(spirv: spirv)
+        }
+        let optimizeArena = measure(iterations) { _ in
+            do {
+                let opt = SPVTOptimizer(environment: .universal1_5, allocator: arena.allocator)
+                opt.registerPerformancePasses()
+                _ = opt.optimize(spirv: spirv)
+            }
+            arena.reset()
+        }
+        print(String(format: "optimize: system %.3f ms, arena %.3f ms",
+                     optimizeSystem * 1000, optimizeArena * 1000))
+        
+        let stats = arena.statistics
+        print("arena: \(stats.allocationCount) allocations, peak \(stats.peakBytes) bytes, "
+              + "reserved \(stats.reservedBytes) bytes, \(stats.resetCount) resets")
+    }
+    
+    static func churn(_ allocator: SPVTAllocator) {
+        var objects = [(UnsafeMutableRawPointer?, Int)]()
+        objects.reserveCapacity(64)
+        for i in 0..<64 {
+            let size = [24, 48, 96, 256][i % 4]
+            objects.append((allocator.allocate(byteCount: size, alignment: 8), size))
+        }
+        
+        var size = 64
+        var buffer = allocator.allocate(byteCount: size, alignment: 4)
+        while size < 16 * 1024 {
+            buffer = allocator.reallocate(buffer, byteCount: size, newByteCount: size * 2, alignment: 4)
+            size *= 2
+        }
+        allocator.deallocate(buffer, byteCount: size)
+        
+        for (pointer, size) in objects.reversed() {
+            allocator.deallocate(pointer, byteCount: size)
+        }
+    }
+    
+    /// Returns the mean duration of `body` in seconds.
+    static func measure(_ iterations: Int, _ body: (Int) -> Void) -> Double {
+        let start = DispatchTime.now().uptimeNanoseconds
+        for i in 0..<iterations {
+            body(i)
+        }
+        let elapsed = DispatchTime.now().uptimeNanoseconds - start
+        return Double(elapsed) / 1e9 / Double(iterations)
+    }
+}
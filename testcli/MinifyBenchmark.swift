@@ -0,0 +1,48 @@
+//
+//  MinifyBenchmark.swift
+//  testcli
+//
+
+import Foundation
+import SPIRV
+
+/// Reports the size of the MSL for a corpus of SPIR-V modules before and after
+/// minification, and the time spent minifying.
+enum MinifyBenchmark {
+    static func run(corpus: [(name: String, spirv: Data)]) throws {
+        var options = SPVMetalCompiler.Options()
+        options.version = .version2_1
+        
+        var input = 0, output = 0
+        var elapsed: UInt64 = 0
+        for (name, spirv) in corpus {
+            let ctx = SPVContext()
+            let src = try ctx.makeMetalCompiler(ir: try ctx.parse(data: spirv)).compile(options: options)
+            
+            let start = DispatchTime.now().uptimeNanoseconds
+            let stats = try SPVMetalMinifier.minify(src).statistics
+            elapsed += DispatchTime.now().uptimeNanoseconds - start
+            
+            input += stats.inputSize
+            output += stats.outputSize
+            print(String(format: "%@: %d -> %d bytes (%.1f%%), %d helpers removed, %d identifiers renamed",
+                         name, stats.inputSize, stats.outputSize, percent(stats.reduction, of: stats.inputSize),
+                         stats.removedHelpers, stats.renamedIdentifiers))
+        }
+        
+        print(String(format: "total: %d -> %d bytes (%.1f%%), minify: %.3f ms",
+                     input, output, percent(input - output, of: input), Double(elapsed) / 1e6))
+    }
+    
+    /// Loads the `.spv` files in `directory`.
+    static func corpus(directory: URL) throws -> [(name: String, spirv: Data)] {
+        try FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)
+            .filter { $0.pathExtension == "spv" }
+            .sorted { $0.lastPathComponent < $1.lastPathComponent }
+            .map { ($0.lastPathComponent, try Data(contentsOf: $0)) }
+    }
+    
+    static func percent(_ part: Int, of whole: Int) -> Double {
+        whole == 0 ? 0 : Double(part) * 100 / Double(whole)
+    }
+}
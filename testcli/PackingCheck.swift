@@ -0,0 +1,61 @@
+//
+//  PackingCheck.swift
+//  testcli
+//
+
+import Foundation
+import SPIRV
+
+/// Checks that `SPVMetalCompiler.packActiveBufferRanges()` leaves blocks which
+/// MSL can still represent.
+enum PackingCheck {
+    static let leadingInactiveShader = #"""
+        #version 450
+        layout(set = 0, binding = 0) uniform Params
+        {
+            float unused;
+            vec4 color;
+            vec4 tail;
+        } params;
+        layout(location = 0) out vec4 color;
+
+        void main()
+        {
+            color = params.color;
+        }
+        """#
+
+    /// Packs a uniform block whose first member is inactive, then compiles it to MSL.
+    static func run() throws {
+        let shader = GLShader(source: leadingInactiveShader, stage: .fragment)
+        try shader.parse(messages: [.vulkanRules, .spvRules])
+        let program = GLProgram()
+        program.add(shader: shader)
+        try program.link()
+        let spirv = try program.generate(stage: .fragment)
+
+        let ctx = SPVContext()
+        let compiler = try ctx.makeMetalCompiler(ir: try ctx.parse(data: spirv))
+        let packings = try compiler.packActiveBufferRanges()
+        guard let packing = packings.values.first, packings.count == 1 else {
+            print("packing check: expected one packed block")
+            exit(1)
+        }
+        // The inactive member at offset 0 keeps the block from moving, and the
+        // inactive member after `color` is not uploaded.
+        guard packing.offset == 0, packing.size == 32, packing.declaredSize == 48 else {
+            print("packing check: unexpected packing \(packing.uploadRange), declared size \(packing.declaredSize)")
+            exit(1)
+        }
+
+        var options = compiler.makeOptions()
+        options.version = .version2_1
+        do {
+            _ = try compiler.compile(options: options)
+        } catch {
+            print("packing check: the packed block does not compile to MSL: \(error)")
+            exit(1)
+        }
+        print("packing check: the packed block compiles to MSL")
+    }
+}
@@ -0,0 +1,104 @@
+//
+//  RebindBenchmark.swift
+//  testcli
+//
+
+import Foundation
+import SPIRV
+
+/// Compares a full MSL compile against `SPVMetalRebindTemplate` when only
+/// buffer indices change between compiles.
+enum RebindBenchmark {
+    static func run(spirv: Data, iterations: Int = 200) throws {
+        try verify()
+        
+        let ctx = SPVContext()
+        var options = SPVMetalCompiler.Options()
+        options.version = .version2_1
+        
+        let full = try measure(iterations) { i in
+            let compiler = try ctx.makeMetalCompiler(ir: try ctx.parse(data: spirv))
+            options.swizzleBufferIndex = 30 - UInt32(i % 4)
+            options.bufferSizeBufferIndex = 25 - UInt32(i % 4)
+            _ = try compiler.compile(options: options)
+        }
+        
+        let template = try SPVMetalRebindTemplate(compiler: try ctx.makeMetalCompiler(ir: try ctx.parse(data: spirv)),
+                                                  options: options, bindings: [])
+        let rebind = try measure(iterations) { i in
+            options.swizzleBufferIndex = 30 - UInt32(i % 4)
+            options.bufferSizeBufferIndex = 25 - UInt32(i % 4)
+            _ = try template.emit(options: options, bindings: [])
+        }
+        
+        print(String(format: "full compile: %.3f ms, rebind: %.3f ms, speedup: %.1fx",
+                     full * 1000, rebind * 1000, full / rebind))
+    }
+    
+    static let swizzleShader = #"""
+        #version 450
+        layout(set = 0, binding = 0) uniform sampler2D tex;
+        layout(set = 0, binding = 1) readonly buffer Data { float values[]; } data;
+        layout(location = 0) in vec2 uv;
+        layout(location = 0) out vec4 color;
+        
+        void main()
+        {
+            color = texture(tex, uv) * float(data.values.length());
+        }
+        """#
+    
+    /// Checks the template against a full compile of a fragment shader which samples a
+    /// swizzled texture and reads the length of a runtime array, so its MSL indexes both
+    /// the swizzle and the buffer size buffers by resource index.
+    static func verify() throws {
+        let shader = GLShader(source: swizzleShader, stage: .fragment)
+        try shader.parse(messages: [.vulkanRules, .spvRules])
+        let program = GLProgram()
+        program.add(shader: shader)
+        try program.link()
+        let spirv = try program.generate(stage: .fragment)
+        
+        func bindings(_ i: UInt32) -> [spvc_msl_resource_binding] {
+            [spvc_msl_resource_binding(stage: .fragment, desc_set: 0, binding: 0,
+                                       msl_buffer: 0, msl_texture: 3 + i, msl_sampler: 2 + i),
+             spvc_msl_resource_binding(stage: .fragment, desc_set: 0, binding: 1,
+                                       msl_buffer: 5 + i, msl_texture: 0, msl_sampler: 0)]
+        }
+        
+        let ctx = SPVContext()
+        var options = SPVMetalCompiler.Options()
+        options.version = .version2_1
+        options.swizzleTextureSamples = true
+        let template = try SPVMetalRebindTemplate(compiler: try ctx.makeMetalCompiler(ir: try ctx.parse(data: spirv)),
+                                                  options: options, bindings: bindings(0))
+        for i in UInt32(0)..<4 {
+            options.swizzleBufferIndex = 30 - i
+            options.bufferSizeBufferIndex = 25 - i
+            // A new cache, so the entry is a full compile with these indices.
+            let full = try SPVMetalCompilerCache().compile(spirv: spirv, options: options,
+                                                           resourceBindings: bindings(i), context: ctx)
+            guard full.needsSwizzleBuffer, full.needsBufferSizeBuffer else {
+                print("rebind check: the shader does not use the swizzle and buffer size buffers")
+                exit(1)
+            }
+            let rebind = try template.emit(options: options, bindings: bindings(i))
+            guard rebind == full.source else {
+                print("rebind check: the MSL differs from a full compile for indices \(i)")
+                print(rebind)
+                exit(1)
+            }
+        }
+        print("rebind check: the MSL matches a full compile")
+    }
+    
+    /// Returns the mean duration of `body` in seconds.
+    static func measure(_ iterations: Int, _ body: (Int) throws -> Void) rethrows -> Double {
+        let start = DispatchTime.now().uptimeNanoseconds
+        for i in 0..<iterations {
+            try body(i)
+        }
+        let elapsed = DispatchTime.now().uptimeNanoseconds - start
+        return Double(elapsed) / 1e9 / Double(iterations)
+    }
+}
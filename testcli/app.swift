@@ -79,6 +79,31 @@ struct Test {
             exit(1)
         }
         
+        if CommandLine.arguments.contains("--bench-allocator") {
+            AllocatorBenchmark.run(spirv: vertSpv)
+            return
+        }
+        
+        if CommandLine.arguments.contains("--check-packing") {
+            try PackingCheck.run()
+            return
+        }
+        
+        if CommandLine.arguments.contains("--bench-rebind") {
+            try RebindBenchmark.run(spirv: vertSpv)
+            return
+        }
+        
+        if let i = CommandLine.arguments.firstIndex(of: "--bench-minify") {
+            // An optional directory of .spv files follows the flag.
+            let args = CommandLine.arguments
+            let corpus = i + 1 < args.count
+                ? try MinifyBenchmark.corpus(directory: URL(fileURLWithPath: args[i + 1]))
+                : [(name: "vertex", spirv: vertSpv)]
+            try MinifyBenchmark.run(corpus: corpus)
+            return
+        }
+        
         let ctx = SPVContext()
         
         do {